@@ -0,0 +1,363 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#include "arrow.h"
+#include "schema.h"
+#include "hash.h"
+
+/* ============================================================================
+ * HELPER: buffer e callback di rilascio
+ * ============================================================================
+ */
+
+/**
+ * @struct arrow_private
+ * @brief Memoria posseduta da un ArrowArray / ArrowSchema (private_data)
+ *
+ * I figli sono struct separate con un proprio release, come richiede
+ * l'interfaccia: il consumatore può spostarne uno e rilasciare il resto.
+ */
+typedef struct {
+    void *buffers[3];
+    const void *buffer_ptrs[3];
+    struct ArrowArray *children;
+    struct ArrowArray *child_ptrs[B_ARROW_COLUMNS];
+} arrow_private;
+
+typedef struct {
+    struct ArrowSchema *children;
+    struct ArrowSchema *child_ptrs[B_ARROW_COLUMNS];
+} arrow_schema_private;
+
+/* Buffer allineati a 64 byte, come raccomandato da Arrow */
+static void* arrow_alloc(size_t size) {
+    size_t rounded = (size + 63) & ~(size_t)63;
+    void *p = aligned_alloc(64, rounded ? rounded : 64);
+    if (p == NULL) {
+        fprintf(stderr, "Malloc failed in function arrow_alloc!\n");
+        exit(-1);
+    }
+    return p;
+}
+
+static void release_array(struct ArrowArray *array) {
+    arrow_private *priv = array->private_data;
+    for (int64_t i = 0; i < array->n_children; i++) {
+        if (array->children[i]->release != NULL) {
+            array->children[i]->release(array->children[i]);
+        }
+    }
+    for (int b = 0; b < 3; b++) {
+        free(priv->buffers[b]);
+    }
+    free(priv->children);
+    free(priv);
+    array->release = NULL;
+}
+
+static void release_schema(struct ArrowSchema *schema) {
+    arrow_schema_private *priv = schema->private_data;
+    for (int64_t i = 0; i < schema->n_children; i++) {
+        if (schema->children[i]->release != NULL) {
+            schema->children[i]->release(schema->children[i]);
+        }
+    }
+    if (priv != NULL) {
+        free(priv->children);
+        free(priv);
+    }
+    schema->release = NULL;
+}
+
+static void init_array(struct ArrowArray *array, int64_t length, int64_t null_count,
+                       int n_buffers, void *b0, void *b1, void *b2) {
+    arrow_private *priv = calloc(1, sizeof(arrow_private));
+    if (priv == NULL) {
+        fprintf(stderr, "Malloc failed in function init_array!\n");
+        exit(-1);
+    }
+    priv->buffers[0] = b0;
+    priv->buffers[1] = b1;
+    priv->buffers[2] = b2;
+    for (int b = 0; b < 3; b++) {
+        priv->buffer_ptrs[b] = priv->buffers[b];
+    }
+
+    memset(array, 0, sizeof(*array));
+    array->length = length;
+    array->null_count = null_count;
+    array->n_buffers = n_buffers;
+    array->buffers = priv->buffer_ptrs;
+    array->release = release_array;
+    array->private_data = priv;
+}
+
+static void init_schema(struct ArrowSchema *schema, const char *format, const char *name, int64_t flags) {
+    memset(schema, 0, sizeof(*schema));
+    schema->format = format;
+    schema->name = name;
+    schema->flags = flags;
+    schema->release = release_schema;
+}
+
+
+/* ============================================================================
+ * HELPER: colonne e riempimento parallelo
+ * ============================================================================
+ */
+
+static const char *const column_format[B_ARROW_COLUMNS] = {
+    "w:20", "U", "l", "i", "l", "tss:"
+};
+static const char *const column_name[B_ARROW_COLUMNS] = {
+    "info_hash", "name", "total_length", "file_count", "piece_length", "creation_date"
+};
+
+/**
+ * @struct arrow_cols
+ * @brief Buffer delle colonne in riempimento (names: nomi per la seconda passata)
+ */
+typedef struct {
+    unsigned char *valid;
+    unsigned char *info_hash;
+    int64_t *name_offsets;
+    char *name_data;
+    int64_t *total_length;
+    int32_t *file_count;
+    int64_t *piece_length;
+    unsigned char *date_valid;
+    int64_t *creation_date;
+    b_span *names;
+} arrow_cols;
+
+typedef struct {
+    const char *base;
+    const b_range *docs;
+    arrow_cols *cols;
+    size_t from, to;
+    size_t invalid;
+    size_t no_date;
+} arrow_job;
+
+static inline void set_bit(unsigned char *bitmap, size_t i, int v) {
+    if (v) {
+        bitmap[i >> 3] |= (unsigned char)(1u << (i & 7));
+    } else {
+        bitmap[i >> 3] &= (unsigned char)~(1u << (i & 7));
+    }
+}
+
+/**
+ * @brief Prima passata: decodifica e colonne a larghezza fissa
+ *
+ * name_offsets[row + 1] riceve intanto la lunghezza del nome.
+ */
+static void fill_row(arrow_job *job, size_t row) {
+    arrow_cols *c = job->cols;
+    const b_range *r = &job->docs[row];
+    b_torrent_meta meta;
+
+    int ok = b_schema_decode(&b_torrent_meta_schema, job->base + r->offset, r->len, &meta) > 0;
+    set_bit(c->valid, row, ok);
+    if (!ok) {
+        memset(c->info_hash + row * B_SHA1_DIGEST_LENGTH, 0, B_SHA1_DIGEST_LENGTH);
+        c->names[row].ptr = NULL;
+        c->names[row].len = 0;
+        c->name_offsets[row + 1] = 0;
+        c->total_length[row] = 0;
+        c->file_count[row] = 0;
+        c->piece_length[row] = 0;
+        c->creation_date[row] = 0;
+        set_bit(c->date_valid, row, 0);
+        job->invalid++;
+        job->no_date++;
+        return;
+    }
+
+    b_sha1(meta.info_raw.ptr, meta.info_raw.len, c->info_hash + row * B_SHA1_DIGEST_LENGTH);
+    c->names[row] = meta.info.name;
+    c->name_offsets[row + 1] = (int64_t)meta.info.name.len;
+
+    const b_schema_array *files = &meta.info.files;
+    if (files->count > 0) {
+        const b_torrent_file *f = files->items;
+        int64_t total = 0;
+        for (size_t i = 0; i < files->count; i++) {
+            total += f[i].length;
+        }
+        c->total_length[row] = total;
+        c->file_count[row] = (int32_t)files->count;
+    } else {
+        c->total_length[row] = meta.info.length;
+        c->file_count[row] = 1;
+    }
+    c->piece_length[row] = meta.info.piece_length;
+
+    /* Lo schema non distingue assente da 0: 0 è trattato come assente */
+    c->creation_date[row] = meta.creation_date;
+    set_bit(c->date_valid, row, meta.creation_date != 0);
+    if (meta.creation_date == 0) {
+        job->no_date++;
+    }
+
+    b_schema_free(&b_torrent_meta_schema, &meta);
+}
+
+static void* scan_worker(void *arg) {
+    arrow_job *job = arg;
+    for (size_t row = job->from; row < job->to; row++) {
+        fill_row(job, row);
+    }
+    return NULL;
+}
+
+/* Seconda passata: i nomi puntano ancora nei documenti di base */
+static void* names_worker(void *arg) {
+    arrow_job *job = arg;
+    arrow_cols *c = job->cols;
+    for (size_t row = job->from; row < job->to; row++) {
+        if (c->names[row].len > 0) {
+            memcpy(c->name_data + c->name_offsets[row], c->names[row].ptr, c->names[row].len);
+        }
+    }
+    return NULL;
+}
+
+static void run_jobs(void *(*fn)(void *), arrow_job *jobs, pthread_t *tids, long threads) {
+    for (long t = 1; t < threads; t++) {
+        if (pthread_create(&tids[t], NULL, fn, &jobs[t]) != 0) {
+            fprintf(stderr, "Error! pthread_create failed in function b_arrow_export_torrents!\n");
+            exit(-1);
+        }
+    }
+    fn(&jobs[0]);
+    for (long t = 1; t < threads; t++) {
+        pthread_join(tids[t], NULL);
+    }
+}
+
+
+/* ============================================================================
+ * FUNZIONI: esportazione
+ * ============================================================================
+ */
+
+size_t b_arrow_export_torrents(const char *base, const b_range *docs, size_t n, int n_threads,
+                               struct ArrowSchema *schema, struct ArrowArray *array) {
+
+    /* Input validation */
+    if(schema == NULL || array == NULL || (n > 0 && (base == NULL || docs == NULL))){
+        fprintf(stderr, "Error! NULL pointer parsed in function b_arrow_export_torrents()! ");
+        exit(-1);
+    }
+
+    long threads = n_threads > 0 ? n_threads : sysconf(_SC_NPROCESSORS_ONLN);
+    if (threads < 1) {
+        threads = 1;
+    }
+
+    size_t bitmap_bytes = (n + 7) / 8;
+    arrow_cols c;
+    c.valid = arrow_alloc(bitmap_bytes);
+    c.info_hash = arrow_alloc(n * B_SHA1_DIGEST_LENGTH);
+    c.name_offsets = arrow_alloc((n + 1) * sizeof(int64_t));
+    c.total_length = arrow_alloc(n * sizeof(int64_t));
+    c.file_count = arrow_alloc(n * sizeof(int32_t));
+    c.piece_length = arrow_alloc(n * sizeof(int64_t));
+    c.date_valid = arrow_alloc(bitmap_bytes);
+    c.creation_date = arrow_alloc(n * sizeof(int64_t));
+    c.names = malloc((n ? n : 1) * sizeof(b_span));
+    if (c.names == NULL) {
+        fprintf(stderr, "Malloc failed in function b_arrow_export_torrents!\n");
+        exit(-1);
+    }
+    c.name_offsets[0] = 0;
+
+    /* Intervalli multipli di 64 righe: nessun byte delle bitmap è condiviso */
+    size_t per = (n + (size_t)threads - 1) / (size_t)threads;
+    per = (per + 63) & ~(size_t)63;
+    if (per == 0) {
+        per = 64;
+    }
+    threads = (long)((n + per - 1) / per);
+    if (threads < 1) {
+        threads = 1;
+    }
+
+    arrow_job *jobs = malloc(sizeof(arrow_job) * (size_t)threads);
+    pthread_t *tids = malloc(sizeof(pthread_t) * (size_t)threads);
+    if (jobs == NULL || tids == NULL) {
+        fprintf(stderr, "Malloc failed in function b_arrow_export_torrents!\n");
+        exit(-1);
+    }
+    for (long t = 0; t < threads; t++) {
+        jobs[t].base = base;
+        jobs[t].docs = docs;
+        jobs[t].cols = &c;
+        jobs[t].from = (size_t)t * per < n ? (size_t)t * per : n;
+        jobs[t].to = (size_t)(t + 1) * per < n ? (size_t)(t + 1) * per : n;
+        jobs[t].invalid = 0;
+        jobs[t].no_date = 0;
+    }
+    run_jobs(scan_worker, jobs, tids, threads);
+
+    /* Lunghezze → offset */
+    for (size_t row = 0; row < n; row++) {
+        c.name_offsets[row + 1] += c.name_offsets[row];
+    }
+    c.name_data = arrow_alloc((size_t)c.name_offsets[n]);
+    run_jobs(names_worker, jobs, tids, threads);
+
+    size_t invalid = 0, no_date = 0;
+    for (long t = 0; t < threads; t++) {
+        invalid += jobs[t].invalid;
+        no_date += jobs[t].no_date;
+    }
+    free(jobs);
+    free(tids);
+    free(c.names);
+
+    /* Array struct e figli */
+    init_array(array, (int64_t)n, (int64_t)invalid, 1, c.valid, NULL, NULL);
+    arrow_private *priv = array->private_data;
+    priv->children = calloc(B_ARROW_COLUMNS, sizeof(struct ArrowArray));
+    if (priv->children == NULL) {
+        fprintf(stderr, "Malloc failed in function b_arrow_export_torrents!\n");
+        exit(-1);
+    }
+    init_array(&priv->children[0], (int64_t)n, 0, 2, NULL, c.info_hash, NULL);
+    init_array(&priv->children[1], (int64_t)n, 0, 3, NULL, c.name_offsets, c.name_data);
+    init_array(&priv->children[2], (int64_t)n, 0, 2, NULL, c.total_length, NULL);
+    init_array(&priv->children[3], (int64_t)n, 0, 2, NULL, c.file_count, NULL);
+    init_array(&priv->children[4], (int64_t)n, 0, 2, NULL, c.piece_length, NULL);
+    init_array(&priv->children[5], (int64_t)n, (int64_t)no_date, 2, c.date_valid, c.creation_date, NULL);
+    for (int i = 0; i < B_ARROW_COLUMNS; i++) {
+        priv->child_ptrs[i] = &priv->children[i];
+    }
+    array->n_children = B_ARROW_COLUMNS;
+    array->children = priv->child_ptrs;
+
+    /* Schema: "+s" con una colonna per campo */
+    init_schema(schema, "+s", "", 0);
+    arrow_schema_private *spriv = malloc(sizeof(arrow_schema_private));
+    struct ArrowSchema *kids = calloc(B_ARROW_COLUMNS, sizeof(struct ArrowSchema));
+    if (spriv == NULL || kids == NULL) {
+        fprintf(stderr, "Malloc failed in function b_arrow_export_torrents!\n");
+        exit(-1);
+    }
+    spriv->children = kids;
+    for (int i = 0; i < B_ARROW_COLUMNS; i++) {
+        init_schema(&kids[i], column_format[i], column_name[i],
+                    ARROW_FLAG_NULLABLE);
+        spriv->child_ptrs[i] = &kids[i];
+    }
+    schema->flags = ARROW_FLAG_NULLABLE;
+    schema->n_children = B_ARROW_COLUMNS;
+    schema->children = spriv->child_ptrs;
+    schema->private_data = spriv;
+
+    return n - invalid;
+}
@@ -0,0 +1,97 @@
+#ifndef ARROW_H
+#define ARROW_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+#include "split.h"
+
+/* ============================================================================
+ * PANORAMICA: Esportazione colonnare dei metadati (Arrow C Data Interface)
+ * ============================================================================
+ *
+ * Per l'analisi di milioni di torrent i campi principali vengono scritti
+ * direttamente in buffer colonnari nel formato della Arrow C Data
+ * Interface: pyarrow, polars, DuckDB li importano senza copia e senza che
+ * questo progetto dipenda da libarrow (le due struct dell'interfaccia sono
+ * un ABI stabile e sono riportate qui sotto).
+ *
+ * Il risultato è un array struct, una riga per documento:
+ *
+ *   info_hash      w:20   SHA-1 del dizionario info
+ *   name           U      info.name (large utf8, offset a 64 bit)
+ *   total_length   l      length, o somma di files[*].length
+ *   file_count     i      numero di file (1 per torrent single-file)
+ *   piece_length   l      piece length
+ *   creation_date  tss:   secondi dall'epoch, nullo se assente
+ *
+ * Un documento non valido dà una riga nulla, così la riga i corrisponde
+ * sempre al documento i.
+ *
+ * Riempimento parallelo in due passate: ogni thread decodifica (con
+ * b_torrent_meta_schema) un intervallo di righe multiplo di 64, scrivendo
+ * le colonne a larghezza fissa e le bitmap al posto giusto; dopo le somme
+ * prefisse delle lunghezze dei nomi ogni thread copia i propri nomi.
+ *
+ * ============================================================================
+ */
+
+#ifndef ARROW_C_DATA_INTERFACE
+#define ARROW_C_DATA_INTERFACE
+
+#define ARROW_FLAG_DICTIONARY_ORDERED 1
+#define ARROW_FLAG_NULLABLE 2
+#define ARROW_FLAG_MAP_KEYS_SORTED 4
+
+struct ArrowSchema {
+    const char *format;
+    const char *name;
+    const char *metadata;
+    int64_t flags;
+    int64_t n_children;
+    struct ArrowSchema **children;
+    struct ArrowSchema *dictionary;
+    void (*release)(struct ArrowSchema *);
+    void *private_data;
+};
+
+struct ArrowArray {
+    int64_t length;
+    int64_t null_count;
+    int64_t offset;
+    int64_t n_buffers;
+    int64_t n_children;
+    const void **buffers;
+    struct ArrowArray **children;
+    struct ArrowArray *dictionary;
+    void (*release)(struct ArrowArray *);
+    void *private_data;
+};
+
+#endif  /* ARROW_C_DATA_INTERFACE */
+
+#define B_ARROW_COLUMNS  6
+
+
+/* ============================================================================
+ * FUNZIONI: esportazione
+ * ============================================================================
+ */
+
+/**
+ * @brief Estrae i metadati di n documenti in un array struct Arrow
+ *
+ * @param base      Buffer che contiene i documenti (es. un segmento mappato)
+ * @param docs      Intervalli dei documenti in base (es. da b_split_all())
+ * @param n_threads Thread da usare (0 = core disponibili)
+ * @param schema    Riempito con lo schema; il consumatore chiama release
+ * @param array     Riempito con i dati; il consumatore chiama release
+ *
+ * @return Numero di righe valide (documenti decodificati)
+ */
+size_t b_arrow_export_torrents(const char *base, const b_range *docs, size_t n, int n_threads,
+                               struct ArrowSchema *schema, struct ArrowArray *array);
+
+
+#endif  /* ARROW_H */
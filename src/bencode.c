@@ -1,13 +1,23 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stdint.h>
+#include <limits.h>
 #include <fcntl.h>
 #include <unistd.h>
 #include <sys/stat.h>
-#include <openssl/sha.h>
 
 #include "bencode.h"
 #include "structs.h"
+#include "hash.h"
+#include "number.h"
+#include "schema.h"
+#include "probes.h"
+#include "stats.h"
+
+B_PROBE_SEMAPHORE(decode_start);
+B_PROBE_SEMAPHORE(decode_done);
+B_PROBE_SEMAPHORE(decode_error);
 
 /* ============================================================================
  * DEBUG: Codici ANSI per output colorato nel terminale
@@ -151,7 +161,8 @@ char* get_bencoded_int(char *bencoded_obj) {
  * che quella decodificata per debugging/verifica.
  *
  * Validazione:
- *   - Rifiuta zeri iniziali (leading zeros): bencoded_int[1]=='0' && bencoded_int[2]!='e'
+ *   - b_parse_i64() rifiuta zeri iniziali (i042e), "-0" e caratteri non cifra
+ *   - Rifiuta valori fuori dall'intervallo di int64_t (overflow)
  *   - Se invalido, stampa su stderr e termina con exit(1)
  *
  * Allocazione memoria:
@@ -177,7 +188,7 @@ char* get_bencoded_int(char *bencoded_obj) {
  * @note Termina il programma con exit(1) se il formato è invalido
  * @note Alloca tre strutture separate (b_element, b_box, b_obj)
  * @note La memoria deve essere liberata dal chiamante
- * @note Non usa atoll() per convertire, solo per validare
+ * @note Il valore convertito serve solo per validare: si memorizza la stringa
  * @note Le stringhe potrebbero non essere null-terminate in modo affidabile
  *
  * @see decode_integer() per una versione lightweight
@@ -188,9 +199,15 @@ b_obj* decode_integer(char *bencoded_int) {
     b_element *decodedInt = malloc(sizeof(b_element));
     decodedInt->length = strlen(bencoded_int);
 
-    /* Validazione: rifiuta zeri iniziali (es. i042e) */
-    if (bencoded_int[1] == '0' && bencoded_int[2] != 'e') {
-        fprintf(stderr, "Errore, formato intero sbagliato (leading zero)! \n");
+    /* Validazione: zeri iniziali (es. i042e), "-0", cifre non valide, overflow */
+    int64_t value;
+    int rc = b_parse_i64(bencoded_int + 1, decodedInt->length - 2, &value);
+    if (rc == B_NUM_OVERFLOW) {
+        fprintf(stderr, "Errore, intero fuori dall'intervallo a 64 bit! \n");
+        exit(1);
+    }
+    if (rc != B_NUM_OK) {
+        fprintf(stderr, "Errore, formato intero sbagliato (leading zero, -0 o cifre non valide)! \n");
         exit(1);
     }
     /* Calcolo lunghezza del numero senza i e */
@@ -213,6 +230,7 @@ b_obj* decode_integer(char *bencoded_int) {
     b_obj* integer = malloc(sizeof(b_obj));
     intero->int_str = decodedInt;
     integer->type = B_INT;
+    integer->refs = 1;
     integer->object = intero;
 
     return integer;
@@ -277,7 +295,7 @@ b_obj* decode_integer(char *bencoded_int) {
  *           * object->pieces->decoded_pieces: buffer byte grezzi
  *           * object->pieces->length: lunghezza dei byte
  *
- * @note Termina il programma con exit(-1) se lunghezza < 0
+ * @note Termina il programma con exit(-1) se la lunghezza non è un numero valido
  * @note Stampa rappresentazione esadecimale su stdout per p_flag=1
  * @note Modifica la variabile globale 'pieces' se decodifica "pieces"
  * @note La memoria allocata deve essere liberata dal chiamante
@@ -288,23 +306,26 @@ b_obj* decode_integer(char *bencoded_int) {
  * @see decode_string() per una versione lightweight
  */
 b_obj* decode_string(char *bencoded_string, int p_flag) {
-    /* Estrae la lunghezza della stringa dai primi caratteri (prima di ':') */
-    int bencoded_string_length = atoi(&bencoded_string[0]);
-    if (bencoded_string_length < 0) {
-        fprintf(stderr, "Errore! Lunghezza bytestring negativa!\n");
-        exit(-1);
-    }
-
-    /* Alloca buffer per i dati decodificati */
-    char* result = malloc((sizeof(char) * bencoded_string_length) + 1); //+1 valgrind debug, memleak
-
     /* Trova la posizione di ':' che separa lunghezza dai dati */
     int start_idx = 0;
     while (bencoded_string[start_idx] != ':') {
         start_idx++;
     }
+
+    /* Estrae la lunghezza della stringa dai caratteri prima di ':' */
+    uint64_t parsed_length;
+    if (b_parse_u64(bencoded_string, start_idx, &parsed_length) != B_NUM_OK ||
+        parsed_length > INT_MAX) {
+        B_PROBE3(decode_error, B_PROBE_TREE, 0, B_SCHEMA_INVALID);
+        fprintf(stderr, "Errore! Lunghezza bytestring non valida!\n");
+        exit(-1);
+    }
+    int bencoded_string_length = (int)parsed_length;
     start_idx += 1;  /* Salta il ':' stesso */
 
+    /* Alloca buffer per i dati decodificati */
+    char* result = malloc((sizeof(char) * bencoded_string_length) + 1); //+1 valgrind debug, memleak
+
     /* Alloca buffer per la forma codificata */
     char* encoded_string = malloc((sizeof(char) * bencoded_string_length + start_idx) + 1); //+1 valgrind debug
     strncpy(encoded_string, bencoded_string, bencoded_string_length + start_idx);
@@ -336,6 +357,7 @@ b_obj* decode_string(char *bencoded_string, int p_flag) {
         b_obj *hex = malloc(sizeof(b_obj));
         pic->pieces = decoded_string;
         hex->type = B_HEX;
+        hex->refs = 1;
         hex->object = pic;
 
         /* Inutilizzate */
@@ -368,6 +390,7 @@ b_obj* decode_string(char *bencoded_string, int p_flag) {
     b_obj* string = malloc(sizeof(b_obj));
     str->int_str = decoded_string;
     string->type = B_STR;
+    string->refs = 1;
     string->object = str;
 
     return string;
@@ -486,6 +509,14 @@ b_obj* decode_string(char *bencoded_string, int p_flag) {
  * @see decode_dict() per dizionari
  */
 b_obj* decode_list(char *bencoded_list, int start) {
+    /* Solo la radice emette le probe di ingresso/uscita */
+    uint64_t probe_t0 = 0, stats_t0 = 0;
+    if (start == 0) {
+        B_PROBE2(decode_start, B_PROBE_TREE, bencoded_list);
+        probe_t0 = B_PROBE_CLOCK(decode_done);
+        stats_t0 = b_stats_clock();
+    }
+
     printf("\n\t\tINIZIO LISTA\n");
 
     /* Inizializza una nuova lista vuota */
@@ -531,12 +562,14 @@ b_obj* decode_list(char *bencoded_list, int start) {
 
             /* ===== CASO PAYLOAD HEX (ERRORE) */
             case B_HEX: {
+                B_PROBE3(decode_error, B_PROBE_TREE, idx, B_SCHEMA_INVALID);
                 fprintf(stderr, "Errore, HEX in getter tipo\n");
                 exit(-1);
             }
 
             /* ===== TIPO NON RICONOSCIUTO ===== */
             case B_NULL:
+                B_PROBE3(decode_error, B_PROBE_TREE, idx, B_SCHEMA_INVALID);
                 fprintf(stderr, "Formato non riconosciuto in decode_list (B_NULL), carattere incriminato: '%c'\n",
                         bencoded_list[idx]);
                 exit(-1);
@@ -556,12 +589,18 @@ b_obj* decode_list(char *bencoded_list, int start) {
     /* Popola il wrapper */
     list->list = lista;
     lista->encoded_list = encoded;
+    lista->verified = b_encoded_stamp();
     return_list->type = B_LIS;
+    return_list->refs = 1;
     return_list->object = list; //invalid write of 8 caused from malloc in 665
 
     /* Stampa il contenuto della lista per debugging */
     print_list(lista);
 
+    if (start == 0) {
+        B_PROBE3(decode_done, B_PROBE_TREE, lista->length, B_PROBE_ELAPSED(probe_t0));
+        b_stats_record(B_STATS_DECODE, stats_t0);
+    }
     return return_list;
 
     /* BUG: Questa riga non è mai raggiunta (dead code) */
@@ -660,6 +699,14 @@ b_obj* decode_list(char *bencoded_list, int start) {
  * @see decode_list() per liste
  */
 b_obj* decode_dict(char *bencoded_dict, int start) {
+    /* Solo la radice emette le probe di ingresso/uscita */
+    uint64_t probe_t0 = 0, stats_t0 = 0;
+    if (start == 0) {
+        B_PROBE2(decode_start, B_PROBE_TREE, bencoded_dict);
+        probe_t0 = B_PROBE_CLOCK(decode_done);
+        stats_t0 = b_stats_clock();
+    }
+
     printf("\n\t\tINIZIO DICT\n");
 
     int p_flag = 0;
@@ -730,12 +777,14 @@ b_obj* decode_dict(char *bencoded_dict, int start) {
 
             /* ===== CASO PAYLOAD HEX (ERRORE) */
             case B_HEX: {
+                B_PROBE3(decode_error, B_PROBE_TREE, idx, B_SCHEMA_INVALID);
                 fprintf(stderr, "Errore, HEX in getter tipo\n");
                 exit(-1);
             }
 
             /* ===== TIPO NON RICONOSCIUTO ===== */
             case B_NULL:
+                B_PROBE3(decode_error, B_PROBE_TREE, idx, B_SCHEMA_INVALID);
                 fprintf(stderr, "Formato non riconosciuto in decode_list (B_NULL), carattere incriminato: '%c'\n",
                         bencoded_dict[idx]);
                 exit(-1);
@@ -757,13 +806,19 @@ b_obj* decode_dict(char *bencoded_dict, int start) {
     /* Popola il wrapper */
     dict->dict = dizio;
     dizio->encoded_dict = encoded;
+    dizio->verified = b_encoded_stamp();
 
     return_dict->type = B_DICT;
+    return_dict->refs = 1;
     return_dict->object = dict;
     return_dict->object->dict->length = idx + 1;  /* //? - Incertezza del programmatore */
 
     //free_obj(key); //???
 
+    if (start == 0) {
+        B_PROBE3(decode_done, B_PROBE_TREE, dizio->length, B_PROBE_ELAPSED(probe_t0));
+        b_stats_record(B_STATS_DECODE, stats_t0);
+    }
     return return_dict;
 }
 
@@ -790,14 +845,14 @@ b_obj* decode_dict(char *bencoded_dict, int start) {
  * Algoritmo:
  *   1. Definisce il prefisso di 8 byte "-GS0001-"
  *   2. Calcola la lunghezza della stringa peer_key
- *   3. Calcola SHA1(peer_key) usando OpenSSL
+ *   3. Calcola SHA1(peer_key) con b_sha1() (modulo hash, SHA-NI se disponibile)
  *   4. Copia i primi 8 byte del prefisso nel peer_id
  *   5. Copia i 12 byte della firma SHA1 nel peer_id
  *   6. Risultato: 20 byte totali
  *
  * Requisiti di memoria:
  *   - peer_id deve essere allocato con almeno 20 byte
- *   - SHA_DIGEST_LENGTH (da OpenSSL) è generalmente 20 byte
+ *   - B_SHA1_DIGEST_LENGTH (da hash.h) è 20 byte
  *   - Copia solo 12 byte dell'hash, non l'intero
  *
  * @param peer_key Stringa usata come seed per l'hash SHA1
@@ -810,7 +865,7 @@ b_obj* decode_dict(char *bencoded_dict, int start) {
  * @return void (memorizza il risultato nel buffer peer_id)
  *
  * @note Il buffer peer_id NON è null-terminated (è binario)
- * @note Richiede OpenSSL: incluire <openssl/sha.h> e linkare -lssl -lcrypto
+ * @note Usa il modulo hash (hash.h): nessuna dipendenza da OpenSSL
  * @note Il parametro peer_key deve essere una stringa valida
  * @note SHA1 produce 20 byte, ma solo i 12 ultimi sono usati
  *       (il prefisso occupa 8 byte, totale 20)
@@ -836,10 +891,10 @@ void generate_peer_id(char *peer_key, unsigned char *peer_id) {
     int n = strlen(peer_key);
 
     /* Buffer per memorizzare l'hash SHA1 (20 byte) */
-    unsigned char hash[SHA_DIGEST_LENGTH];
+    unsigned char hash[B_SHA1_DIGEST_LENGTH];
 
     /* Calcola SHA1(peer_key) */
-    SHA1((unsigned char*)peer_key, n, hash);
+    b_sha1(peer_key, n, hash);
 
     /* Copia il prefisso (8 byte) nei primi 8 byte del peer_id */
     memcpy(peer_id, prefix, 8);
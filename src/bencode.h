@@ -359,7 +359,7 @@ b_obj* decode_dict(char *bencoded_dict, int start);
  *
  * @return void (memorizza il risultato in peer_id)
  *
- * @note Richiede OpenSSL (SHA1 da openssl/sha.h)
+ * @note Usa b_sha1() del modulo hash (hash.h)
  * @note Il parametro peer_key deve essere una stringa valida null-terminated
  * @note Il buffer peer_id deve essere allocato dal chiamante (almeno 20 byte)
  * @note Non null-termina peer_id (è un buffer binario)
@@ -0,0 +1,355 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bindex.h"
+
+/* ============================================================================
+ * HELPER: array temporanei
+ * ============================================================================
+ */
+
+/**
+ * @struct preorder_nodes
+ * @brief Nodi nell'ordine in cui si incontrano nel buffer (prima passata)
+ */
+typedef struct {
+    uint32_t *start;
+    uint32_t *end;
+    uint32_t *parent;
+    uint32_t n, cap;
+} preorder_nodes;
+
+static void preorder_push(preorder_nodes *pre, uint32_t start, uint32_t parent) {
+    if (pre->n == pre->cap) {
+        uint32_t cap = pre->cap ? pre->cap * 2 : 256;
+        uint32_t *s = realloc(pre->start, cap * sizeof(uint32_t));
+        uint32_t *e = s ? realloc(pre->end, cap * sizeof(uint32_t)) : NULL;
+        uint32_t *p = e ? realloc(pre->parent, cap * sizeof(uint32_t)) : NULL;
+        if (p == NULL) {
+            fprintf(stderr, "Malloc failed in function b_index_build!\n");
+            exit(-1);
+        }
+        pre->start = s;
+        pre->end = e;
+        pre->parent = p;
+        pre->cap = cap;
+    }
+    pre->start[pre->n] = start;
+    pre->end[pre->n] = 0;
+    pre->parent[pre->n] = parent;
+    pre->n++;
+}
+
+static void preorder_free(preorder_nodes *pre) {
+    free(pre->start);
+    free(pre->end);
+    free(pre->parent);
+}
+
+/**
+ * @brief Prima passata: scandisce il buffer e registra i nodi in preordine
+ *
+ * Iterativa con uno stack esplicito di contenitori aperti (al più
+ * B_SCHEMA_MAX_DEPTH); per ogni dizionario aperto want_key indica se il
+ * prossimo elemento è una chiave.
+ *
+ * @return Offset dopo il valore radice, oppure un codice B_SCHEMA_*
+ */
+static ssize_t scan_preorder(const char *buf, size_t len, preorder_nodes *pre) {
+    uint32_t stack[B_SCHEMA_MAX_DEPTH + 1];
+    char want_key[B_SCHEMA_MAX_DEPTH + 1];
+    int depth = 0;
+    size_t pos = 0;
+
+    while (1) {
+        if (pos >= len) {
+            return B_SCHEMA_INCOMPLETE;
+        }
+
+        if (depth > 0) {
+            uint32_t top = stack[depth - 1];
+            int is_dict = buf[pre->start[top]] == 'd';
+
+            /* Fine del contenitore: al posto di un elemento o di una chiave */
+            if (buf[pos] == 'e' && (!is_dict || want_key[depth - 1])) {
+                pre->end[top] = (uint32_t)(pos + 1);
+                pos++;
+                depth--;
+                if (depth == 0) {
+                    return (ssize_t)pos;
+                }
+                continue;
+            }
+
+            if (is_dict) {
+                if (want_key[depth - 1]) {
+                    ssize_t r = bencode_read_bytes(buf, len, pos, NULL);
+                    if (r < 0) {
+                        return r == B_SCHEMA_TYPE ? B_SCHEMA_INVALID : r;
+                    }
+                    pos = (size_t)r;
+                    want_key[depth - 1] = 0;
+                    continue;
+                }
+                want_key[depth - 1] = 1;
+            }
+        }
+
+        /* Un valore inizia in pos */
+        uint32_t node = pre->n;
+        preorder_push(pre, (uint32_t)pos, depth > 0 ? stack[depth - 1] : UINT32_MAX);
+
+        char c = buf[pos];
+        ssize_t r;
+        if (c == 'l' || c == 'd') {
+            if (depth > B_SCHEMA_MAX_DEPTH) {
+                return B_SCHEMA_INVALID;
+            }
+            stack[depth] = node;
+            want_key[depth] = 1;
+            depth++;
+            pos++;
+            continue;
+        } else if (c == 'i') {
+            r = bencode_read_int(buf, len, pos, NULL);
+        } else if (c >= '0' && c <= '9') {
+            r = bencode_read_bytes(buf, len, pos, NULL);
+        } else {
+            r = B_SCHEMA_INVALID;
+        }
+        if (r < 0) {
+            return r;
+        }
+        pre->end[node] = (uint32_t)r;
+        pos = (size_t)r;
+        if (depth == 0) {
+            return (ssize_t)pos;
+        }
+    }
+}
+
+
+/* ============================================================================
+ * FUNZIONI: costruzione
+ * ============================================================================
+ */
+
+/**
+ * @brief Costruisce l'indice del valore in buf[0..len) in una passata
+ *
+ * Algoritmo:
+ *   1. Scansione del buffer: nodi in preordine con il genitore di ognuno
+ *   2. Counting sort dei nodi per genitore (i fratelli restano in ordine)
+ *   3. Visita in ampiezza: la posizione BFS di ogni nodo e first_child
+ * I passi 2 e 3 lavorano solo sugli array dei nodi, non sul buffer.
+ */
+ssize_t b_index_build(b_index *idx, const char *buf, size_t len) {
+
+    /* Input validation */
+    if(idx == NULL || (buf == NULL && len > 0)){
+        fprintf(stderr, "Error! NULL pointer parsed in function b_index_build()! ");
+        exit(-1);
+    }
+
+    memset(idx, 0, sizeof(*idx));
+    if (len >= UINT32_MAX) {
+        return B_SCHEMA_INVALID;
+    }
+
+    preorder_nodes pre = { NULL, NULL, NULL, 0, 0 };
+    ssize_t consumed = scan_preorder(buf, len, &pre);
+    if (consumed < 0) {
+        preorder_free(&pre);
+        return consumed;
+    }
+    uint32_t n = pre.n;
+
+    /* Figli raggruppati per genitore: kids[child_pos[p] ..] */
+    uint32_t *child_pos = calloc((size_t)n + 1, sizeof(uint32_t));
+    uint32_t *kids = malloc((size_t)n * sizeof(uint32_t));
+    uint32_t *order = malloc((size_t)n * sizeof(uint32_t));
+    uint32_t *block = malloc(((size_t)n * 3 + 1) * sizeof(uint32_t));
+    if (child_pos == NULL || kids == NULL || order == NULL || block == NULL) {
+        fprintf(stderr, "Malloc failed in function b_index_build!\n");
+        exit(-1);
+    }
+
+    for (uint32_t i = 1; i < n; i++) {
+        child_pos[pre.parent[i] + 1]++;
+    }
+    for (uint32_t i = 0; i < n; i++) {
+        child_pos[i + 1] += child_pos[i];
+    }
+    /* child_pos[p] avanza mentre si riempie: alla fine vale l'inizio di p + 1 */
+    for (uint32_t i = 1; i < n; i++) {
+        kids[child_pos[pre.parent[i]]++] = i;
+    }
+
+    idx->buf = buf;
+    idx->len = (size_t)consumed;
+    idx->n_nodes = n;
+    idx->start = block;
+    idx->end = block + n;
+    idx->first_child = block + 2 * (size_t)n;
+
+    /* Visita in ampiezza: order[q] è il nodo in preordine in posizione BFS q */
+    uint32_t next_free = 1;
+    order[0] = 0;
+    for (uint32_t q = 0; q < n; q++) {
+        uint32_t p = order[q];
+        uint32_t first = p == 0 ? 0 : child_pos[p - 1];
+        idx->first_child[q] = next_free;
+        for (uint32_t k = first; k < child_pos[p]; k++) {
+            order[next_free++] = kids[k];
+        }
+        idx->start[q] = pre.start[p];
+        idx->end[q] = pre.end[p];
+    }
+    idx->first_child[n] = n;
+
+    free(child_pos);
+    free(kids);
+    free(order);
+    preorder_free(&pre);
+    return consumed;
+}
+
+void b_index_free(b_index *idx) {
+    if (idx == NULL) {
+        return;
+    }
+    free(idx->start);
+    memset(idx, 0, sizeof(*idx));
+}
+
+
+/* ============================================================================
+ * FUNZIONI: interrogazione
+ * ============================================================================
+ */
+
+B_TYPE b_index_type(const b_index *idx, uint32_t node) {
+    if (idx == NULL || node >= idx->n_nodes) {
+        return B_NULL;
+    }
+    char c = idx->buf[idx->start[node]];
+    if (c == 'i') {
+        return B_INT;
+    }
+    if (c == 'l') {
+        return B_LIS;
+    }
+    if (c == 'd') {
+        return B_DICT;
+    }
+    return B_STR;
+}
+
+b_span b_index_span(const b_index *idx, uint32_t node) {
+    b_span span = { NULL, 0 };
+    if (idx != NULL && node < idx->n_nodes) {
+        span.ptr = idx->buf + idx->start[node];
+        span.len = idx->end[node] - idx->start[node];
+    }
+    return span;
+}
+
+uint32_t b_index_count(const b_index *idx, uint32_t node) {
+    if (idx == NULL || node >= idx->n_nodes) {
+        return 0;
+    }
+    return idx->first_child[node + 1] - idx->first_child[node];
+}
+
+uint32_t b_index_list_at(const b_index *idx, uint32_t node, uint32_t i) {
+    if (i >= b_index_count(idx, node)) {
+        return UINT32_MAX;
+    }
+    return idx->first_child[node] + i;
+}
+
+/**
+ * @brief Chiave della i-esima coppia di un dizionario
+ *
+ * La chiave occupa i byte tra la fine del valore precedente (o la 'd') e
+ * l'inizio del valore i: si rilegge l'intestazione "<n>:" in quel punto.
+ */
+b_span b_index_key_at(const b_index *idx, uint32_t node, uint32_t i) {
+    b_span key = { NULL, 0 };
+    if (b_index_type(idx, node) != B_DICT || i >= b_index_count(idx, node)) {
+        return key;
+    }
+
+    uint32_t child = idx->first_child[node] + i;
+    size_t pos = i == 0 ? idx->start[node] + 1 : idx->end[child - 1];
+    if (bencode_read_bytes(idx->buf, idx->start[child], pos, &key) < 0) {
+        key.ptr = NULL;
+        key.len = 0;
+    }
+    return key;
+}
+
+uint32_t b_index_dict_get(const b_index *idx, uint32_t node, const char *key, size_t key_len) {
+
+    /* Input validation */
+    if(idx == NULL || (key == NULL && key_len > 0)){
+        fprintf(stderr, "Error! NULL pointer parsed in function b_index_dict_get()! ");
+        exit(-1);
+    }
+
+    if (b_index_type(idx, node) != B_DICT) {
+        return UINT32_MAX;
+    }
+
+    uint32_t lo = 0;
+    uint32_t hi = b_index_count(idx, node);
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        b_span k = b_index_key_at(idx, node, mid);
+        size_t min = k.len < key_len ? k.len : key_len;
+        int cmp = memcmp(k.ptr, key, min);
+        if (cmp == 0) {
+            cmp = (k.len > key_len) - (k.len < key_len);
+        }
+        if (cmp == 0) {
+            return idx->first_child[node] + mid;
+        }
+        if (cmp < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return UINT32_MAX;
+}
+
+int b_index_int(const b_index *idx, uint32_t node, int64_t *out) {
+
+    /* Input validation */
+    if(idx == NULL || out == NULL){
+        fprintf(stderr, "Error! NULL pointer parsed in function b_index_int()! ");
+        exit(-1);
+    }
+
+    if (node >= idx->n_nodes) {
+        return B_SCHEMA_TYPE;
+    }
+    ssize_t r = bencode_read_int(idx->buf, idx->end[node], idx->start[node], out);
+    return r < 0 ? (int)r : 0;
+}
+
+int b_index_bytes(const b_index *idx, uint32_t node, b_span *out) {
+
+    /* Input validation */
+    if(idx == NULL || out == NULL){
+        fprintf(stderr, "Error! NULL pointer parsed in function b_index_bytes()! ");
+        exit(-1);
+    }
+
+    if (node >= idx->n_nodes) {
+        return B_SCHEMA_TYPE;
+    }
+    ssize_t r = bencode_read_bytes(idx->buf, idx->end[node], idx->start[node], out);
+    return r < 0 ? (int)r : 0;
+}
@@ -0,0 +1,144 @@
+#ifndef BINDEX_H
+#define BINDEX_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+#include "structs.h"
+#include "schema.h"
+
+/* ============================================================================
+ * PANORAMICA: Indice strutturale sul buffer codificato
+ * ============================================================================
+ *
+ * Per interrogare molte volte lo stesso documento anche un cursore deve
+ * riscandire i byte. b_index_build() legge il buffer una volta sola e
+ * produce una tabella a parte (il buffer non viene toccato):
+ *
+ *   start[n]        offset del primo byte del valore n
+ *   end[n]          offset dopo l'ultimo byte del valore n
+ *   first_child[n]  indice del primo figlio di n
+ *
+ * I nodi sono numerati in ampiezza (BFS): i figli di un contenitore sono
+ * consecutivi, quindi il figlio i di n è first_child[n] + i e il numero di
+ * figli è first_child[n + 1] - first_child[n]. Accesso all'i-esimo
+ * elemento, lunghezza di un contenitore e salto di un sottoalbero (end[n])
+ * sono O(1), con 12 byte per nodo.
+ *
+ * Nei dizionari solo i valori sono nodi: la chiave del figlio i inizia
+ * dove finisce il figlio i - 1 (o subito dopo la 'd' per il primo), quindi
+ * si ricava in O(1) senza memorizzarla.
+ *
+ * Offset a 32 bit: buffer fino a 4 GiB.
+ *
+ * ============================================================================
+ */
+
+#define B_INDEX_ROOT  0u   /* Nodo radice */
+
+
+/* ============================================================================
+ * STRUCT: indice
+ * ============================================================================
+ */
+
+/**
+ * @struct b_index
+ * @brief Indice strutturale di un documento bencode
+ *
+ * Campi:
+ * - buf, len:     buffer indicizzato (non posseduto, deve restare valido)
+ * - n_nodes:      numero di valori (chiavi dei dizionari escluse)
+ * - start, end:   estensione di ogni valore nel buffer
+ * - first_child:  n_nodes + 1 elementi, indice del primo figlio
+ *
+ * I tre array stanno in un'unica allocazione.
+ */
+typedef struct {
+    const char *buf;
+    size_t len;
+    uint32_t n_nodes;
+    uint32_t *start;
+    uint32_t *end;
+    uint32_t *first_child;
+} b_index;
+
+
+/* ============================================================================
+ * FUNZIONI: costruzione
+ * ============================================================================
+ */
+
+/**
+ * @brief Costruisce l'indice del valore in buf[0..len) in una passata
+ *
+ * @return Byte indicizzati (> 0), oppure B_SCHEMA_INVALID /
+ *         B_SCHEMA_INCOMPLETE (idx resta vuoto)
+ */
+ssize_t b_index_build(b_index *idx, const char *buf, size_t len);
+
+/**
+ * @brief Libera le tabelle dell'indice (non il buffer)
+ */
+void b_index_free(b_index *idx);
+
+
+/* ============================================================================
+ * FUNZIONI: interrogazione (tutte O(1) tranne b_index_dict_get)
+ * ============================================================================
+ */
+
+/**
+ * @brief Tipo del nodo: B_INT, B_STR, B_LIS o B_DICT
+ */
+B_TYPE b_index_type(const b_index *idx, uint32_t node);
+
+/**
+ * @brief Codifica completa del nodo
+ */
+b_span b_index_span(const b_index *idx, uint32_t node);
+
+/**
+ * @brief Numero di elementi di una lista o di coppie di un dizionario
+ */
+uint32_t b_index_count(const b_index *idx, uint32_t node);
+
+/**
+ * @brief i-esimo elemento di una lista (o valore i-esimo di un dizionario)
+ *
+ * @return Indice del nodo, oppure UINT32_MAX se i è fuori intervallo
+ */
+uint32_t b_index_list_at(const b_index *idx, uint32_t node, uint32_t i);
+
+/**
+ * @brief Chiave della i-esima coppia di un dizionario (ptr NULL se assente)
+ */
+b_span b_index_key_at(const b_index *idx, uint32_t node, uint32_t i);
+
+/**
+ * @brief Valore associato a key in un dizionario
+ *
+ * Ricerca binaria sulle chiavi: richiede dizionari ordinati come prescrive
+ * il bencode canonico (per dizionari non ordinati usare b_cursor_find()).
+ *
+ * @return Indice del nodo, oppure UINT32_MAX se la chiave è assente
+ */
+uint32_t b_index_dict_get(const b_index *idx, uint32_t node, const char *key, size_t key_len);
+
+/**
+ * @brief Valore di un nodo intero
+ *
+ * @return 0, oppure un codice B_SCHEMA_* negativo
+ */
+int b_index_int(const b_index *idx, uint32_t node, int64_t *out);
+
+/**
+ * @brief Contenuto di un nodo bytestring (senza "<n>:")
+ *
+ * @return 0, oppure un codice B_SCHEMA_* negativo
+ */
+int b_index_bytes(const b_index *idx, uint32_t node, b_span *out);
+
+
+#endif  /* BINDEX_H */
@@ -0,0 +1,397 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <pthread.h>
+
+#include "cache.h"
+#include "structs.h"
+#include "footprint.h"
+
+/* ============================================================================
+ * HELPER: hash
+ * ============================================================================
+ */
+
+/**
+ * @brief Indice derivato dai byte dell'info-hash
+ *
+ * L'info-hash è uno SHA1, già distribuito uniformemente: shard e bucket
+ * vengono presi direttamente da due parole diverse, senza rimescolare.
+ */
+static uint64_t hash_word(const unsigned char *hash, size_t off) {
+    uint64_t w;
+    memcpy(&w, hash + off, sizeof(w));
+    return w;
+}
+
+static b_cache_shard* shard_of(b_cache *cache, const unsigned char *hash) {
+    return &cache->shards[hash_word(hash, 0) & (B_CACHE_SHARDS - 1)];
+}
+
+static size_t bucket_of(const b_cache *cache, const unsigned char *hash) {
+    return hash_word(hash, 8) & (cache->n_buckets - 1);
+}
+
+
+/* ============================================================================
+ * HELPER: recupero per epoche
+ * ============================================================================
+ */
+
+/**
+ * @brief Avanza l'epoca globale se tutti i reader attivi l'hanno osservata
+ *
+ * Un reader attivo con epoca vecchia può ancora tenere puntatori a nodi
+ * ritirati in quell'epoca: finché non esce l'epoca resta ferma.
+ */
+static void epoch_try_advance(b_cache *cache) {
+    uint64_t global = __atomic_load_n(&cache->epoch, __ATOMIC_SEQ_CST);
+
+    for (size_t i = 0; i < B_CACHE_MAX_THREADS; i++) {
+        b_cache_thread *t = &cache->threads[i];
+        if (__atomic_load_n(&t->active, __ATOMIC_SEQ_CST) &&
+            __atomic_load_n(&t->epoch, __ATOMIC_SEQ_CST) != global) {
+            return;
+        }
+    }
+    __atomic_compare_exchange_n(&cache->epoch, &global, global + 1, 0,
+                                __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+}
+
+/**
+ * @brief Libera i nodi ritirati da almeno due epoche (shard bloccato)
+ */
+static void shard_reclaim(b_cache *cache, b_cache_shard *shard) {
+    epoch_try_advance(cache);
+    uint64_t global = __atomic_load_n(&cache->epoch, __ATOMIC_SEQ_CST);
+
+    b_cache_entry **link = &shard->retired;
+    while (*link != NULL) {
+        b_cache_entry *e = *link;
+        if (global >= e->retire_epoch + 2) {
+            *link = e->retired_next;
+            b_obj_release(e->doc);
+            free(e);
+        } else {
+            link = &e->retired_next;
+        }
+    }
+}
+
+/**
+ * @brief Toglie e dal conteggio dello shard e lo mette tra i ritirati
+ *
+ * e deve essere già scollegato dalla catena del bucket.
+ */
+static void shard_retire(b_cache *cache, b_cache_shard *shard, b_cache_entry *e) {
+    /* Rimozione O(1) dall'anello: l'ultimo elemento prende il suo posto */
+    b_cache_entry *last = shard->ring[--shard->n_entries];
+    shard->ring[e->ring_pos] = last;
+    last->ring_pos = e->ring_pos;
+    if (shard->hand >= shard->n_entries) {
+        shard->hand = 0;
+    }
+
+    shard->bytes -= e->bytes;
+    e->retire_epoch = __atomic_load_n(&cache->epoch, __ATOMIC_SEQ_CST);
+    e->retired_next = shard->retired;
+    shard->retired = e;
+}
+
+/**
+ * @brief Scollega e dalla catena del suo bucket (shard bloccato)
+ */
+static void chain_unlink(b_cache *cache, b_cache_shard *shard, b_cache_entry *e) {
+    b_cache_entry **link = &shard->buckets[bucket_of(cache, e->hash)];
+    while (*link != e) {
+        link = &(*link)->next;
+    }
+    __atomic_store_n(link, e->next, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief Espelle elementi con CLOCK finché need byte stanno nel budget
+ */
+static void shard_evict(b_cache *cache, b_cache_shard *shard, size_t need) {
+    while (shard->n_entries > 0 && shard->bytes + need > shard->max_bytes) {
+        b_cache_entry *e = shard->ring[shard->hand];
+
+        if (__atomic_load_n(&e->referenced, __ATOMIC_RELAXED)) {
+            /* Seconda possibilità: azzera il bit e passa oltre */
+            __atomic_store_n(&e->referenced, 0, __ATOMIC_RELAXED);
+            shard->hand = (shard->hand + 1) % shard->n_entries;
+            continue;
+        }
+
+        chain_unlink(cache, shard, e);
+        shard_retire(cache, shard, e);
+    }
+}
+
+
+/* ============================================================================
+ * FUNZIONI: creazione e distruzione
+ * ============================================================================
+ */
+
+b_cache* b_cache_new(size_t max_bytes, size_t expected_entries) {
+    b_cache *cache = aligned_alloc(64, sizeof(b_cache));
+    if (cache == NULL) {
+        fprintf(stderr, "Malloc failed in function b_cache_new!\n");
+        exit(-1);
+    }
+    memset(cache, 0, sizeof(b_cache));
+
+    /* Carico massimo ~1 per bucket */
+    size_t per_shard = expected_entries / B_CACHE_SHARDS + 1;
+    cache->n_buckets = 16;
+    while (cache->n_buckets < per_shard) {
+        cache->n_buckets *= 2;
+    }
+
+    for (size_t s = 0; s < B_CACHE_SHARDS; s++) {
+        b_cache_shard *shard = &cache->shards[s];
+        pthread_mutex_init(&shard->lock, NULL);
+        shard->buckets = calloc(cache->n_buckets, sizeof(b_cache_entry*));
+        if (shard->buckets == NULL) {
+            fprintf(stderr, "Malloc failed in function b_cache_new!\n");
+            exit(-1);
+        }
+        shard->max_bytes = max_bytes / B_CACHE_SHARDS;
+    }
+    return cache;
+}
+
+void b_cache_free(b_cache *cache) {
+
+    /* Input validation */
+    if(cache == NULL){
+        fprintf(stderr, "Error! NULL pointer parsed in function b_cache_free()! ");
+        exit(-1);
+    }
+
+    for (size_t s = 0; s < B_CACHE_SHARDS; s++) {
+        b_cache_shard *shard = &cache->shards[s];
+
+        for (size_t i = 0; i < shard->n_entries; i++) {
+            b_obj_release(shard->ring[i]->doc);
+            free(shard->ring[i]);
+        }
+        while (shard->retired != NULL) {
+            b_cache_entry *e = shard->retired;
+            shard->retired = e->retired_next;
+            b_obj_release(e->doc);
+            free(e);
+        }
+        free(shard->ring);
+        free(shard->buckets);
+        pthread_mutex_destroy(&shard->lock);
+    }
+    free(cache);
+}
+
+
+/* ============================================================================
+ * FUNZIONI: registrazione dei thread
+ * ============================================================================
+ */
+
+b_cache_thread* b_cache_thread_register(b_cache *cache) {
+
+    /* Input validation */
+    if(cache == NULL){
+        fprintf(stderr, "Error! NULL pointer parsed in function b_cache_thread_register()! ");
+        exit(-1);
+    }
+
+    for (size_t i = 0; i < B_CACHE_MAX_THREADS; i++) {
+        int expected = 0;
+        if (__atomic_compare_exchange_n(&cache->threads[i].in_use, &expected, 1, 0,
+                                        __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) {
+            return &cache->threads[i];
+        }
+    }
+
+    fprintf(stderr, "Errore! Troppi thread registrati in b_cache_thread_register!\n");
+    exit(-1);
+}
+
+void b_cache_thread_unregister(b_cache_thread *thread) {
+
+    /* Input validation */
+    if(thread == NULL){
+        fprintf(stderr, "Error! NULL pointer parsed in function b_cache_thread_unregister()! ");
+        exit(-1);
+    }
+
+    __atomic_store_n(&thread->active, 0, __ATOMIC_RELEASE);
+    __atomic_store_n(&thread->in_use, 0, __ATOMIC_RELEASE);
+}
+
+
+/* ============================================================================
+ * FUNZIONI: operazioni
+ * ============================================================================
+ */
+
+/**
+ * @brief Cerca il documento con l'info-hash indicato (senza lock)
+ *
+ * Algoritmo:
+ *   1. Entra nell'epoca corrente (store seq_cst: visibile a
+ *      epoch_try_advance() prima di qualunque lettura della catena)
+ *   2. Scorre la catena del bucket con load acquire
+ *   3. Se trova l'hash: imposta il bit CLOCK e fa retain del documento.
+ *      Il nodo non può essere liberato durante l'epoca, e finché esiste
+ *      possiede un riferimento al documento: il retain è sicuro
+ *   4. Esce dall'epoca
+ */
+b_obj* b_cache_get(b_cache *cache, b_cache_thread *thread, const unsigned char *hash) {
+
+    /* Input validation */
+    if(cache == NULL || thread == NULL || hash == NULL){
+        fprintf(stderr, "Error! NULL pointer parsed in function b_cache_get()! ");
+        exit(-1);
+    }
+
+    __atomic_store_n(&thread->active, 1, __ATOMIC_SEQ_CST);
+    __atomic_store_n(&thread->epoch, __atomic_load_n(&cache->epoch, __ATOMIC_SEQ_CST),
+                     __ATOMIC_SEQ_CST);
+
+    b_cache_shard *shard = shard_of(cache, hash);
+    b_cache_entry *e = __atomic_load_n(&shard->buckets[bucket_of(cache, hash)], __ATOMIC_ACQUIRE);
+    b_obj *doc = NULL;
+
+    while (e != NULL) {
+        if (memcmp(e->hash, hash, B_CACHE_HASH_LENGTH) == 0) {
+            /* Scrive solo se serve: evita di sporcare la linea a ogni lettura */
+            if (!__atomic_load_n(&e->referenced, __ATOMIC_RELAXED)) {
+                __atomic_store_n(&e->referenced, 1, __ATOMIC_RELAXED);
+            }
+            doc = b_obj_retain(e->doc);
+            break;
+        }
+        e = __atomic_load_n(&e->next, __ATOMIC_ACQUIRE);
+    }
+
+    __atomic_store_n(&thread->active, 0, __ATOMIC_RELEASE);
+    return doc;
+}
+
+/**
+ * @brief Inserisce o sostituisce il documento associato a hash
+ *
+ * Il nuovo nodo viene preparato completamente e poi pubblicato con uno
+ * store release: un reader vede o il vecchio nodo o il nuovo, mai uno
+ * parzialmente inizializzato.
+ */
+int b_cache_put(b_cache *cache, const unsigned char *hash, b_obj *doc, size_t bytes) {
+
+    /* Input validation */
+    if(cache == NULL || hash == NULL || doc == NULL){
+        fprintf(stderr, "Error! NULL pointer parsed in function b_cache_put()! ");
+        exit(-1);
+    }
+
+    if (bytes == 0) {
+        bytes = b_obj_footprint(doc, NULL);
+    }
+    bytes += sizeof(b_cache_entry);
+
+    b_cache_shard *shard = shard_of(cache, hash);
+    if (bytes > shard->max_bytes) {
+        return -1;
+    }
+
+    b_cache_entry *e = malloc(sizeof(b_cache_entry));
+    if (e == NULL) {
+        fprintf(stderr, "Malloc failed in function b_cache_put!\n");
+        exit(-1);
+    }
+    memcpy(e->hash, hash, B_CACHE_HASH_LENGTH);
+    e->referenced = 0;
+    e->doc = b_obj_retain(doc);
+    e->bytes = bytes;
+
+    pthread_mutex_lock(&shard->lock);
+
+    /* Un eventuale elemento con lo stesso hash viene prima ritirato */
+    b_cache_entry **head = &shard->buckets[bucket_of(cache, hash)];
+    for (b_cache_entry *old = *head; old != NULL; old = old->next) {
+        if (memcmp(old->hash, hash, B_CACHE_HASH_LENGTH) == 0) {
+            chain_unlink(cache, shard, old);
+            shard_retire(cache, shard, old);
+            break;
+        }
+    }
+
+    shard_evict(cache, shard, bytes);
+
+    if (shard->n_entries == shard->ring_cap) {
+        size_t cap = shard->ring_cap ? shard->ring_cap * 2 : 64;
+        b_cache_entry **ring = realloc(shard->ring, sizeof(b_cache_entry*) * cap);
+        if (ring == NULL) {
+            fprintf(stderr, "Realloc failed in function b_cache_put!\n");
+            exit(-1);
+        }
+        shard->ring = ring;
+        shard->ring_cap = cap;
+    }
+    e->ring_pos = shard->n_entries;
+    shard->ring[shard->n_entries++] = e;
+    shard->bytes += bytes;
+
+    e->next = *head;
+    __atomic_store_n(head, e, __ATOMIC_RELEASE);
+
+    shard_reclaim(cache, shard);
+    pthread_mutex_unlock(&shard->lock);
+    return 0;
+}
+
+int b_cache_remove(b_cache *cache, const unsigned char *hash) {
+
+    /* Input validation */
+    if(cache == NULL || hash == NULL){
+        fprintf(stderr, "Error! NULL pointer parsed in function b_cache_remove()! ");
+        exit(-1);
+    }
+
+    b_cache_shard *shard = shard_of(cache, hash);
+    int found = 0;
+
+    pthread_mutex_lock(&shard->lock);
+    for (b_cache_entry *e = shard->buckets[bucket_of(cache, hash)]; e != NULL; e = e->next) {
+        if (memcmp(e->hash, hash, B_CACHE_HASH_LENGTH) == 0) {
+            chain_unlink(cache, shard, e);
+            shard_retire(cache, shard, e);
+            found = 1;
+            break;
+        }
+    }
+    shard_reclaim(cache, shard);
+    pthread_mutex_unlock(&shard->lock);
+
+    return found;
+}
+
+size_t b_cache_count(b_cache *cache) {
+    size_t total = 0;
+    for (size_t s = 0; s < B_CACHE_SHARDS; s++) {
+        pthread_mutex_lock(&cache->shards[s].lock);
+        total += cache->shards[s].n_entries;
+        pthread_mutex_unlock(&cache->shards[s].lock);
+    }
+    return total;
+}
+
+size_t b_cache_bytes(b_cache *cache) {
+    size_t total = 0;
+    for (size_t s = 0; s < B_CACHE_SHARDS; s++) {
+        pthread_mutex_lock(&cache->shards[s].lock);
+        total += cache->shards[s].bytes;
+        pthread_mutex_unlock(&cache->shards[s].lock);
+    }
+    return total;
+}
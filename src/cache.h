@@ -0,0 +1,191 @@
+#ifndef CACHE_H
+#define CACHE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <pthread.h>
+
+#include "structs.h"
+
+/* ============================================================================
+ * PANORAMICA: Cache concorrente info-hash → metainfo
+ * ============================================================================
+ *
+ * Tracker e nodo DHT cercano il metainfo decodificato per info-hash (20 byte)
+ * a ogni richiesta. La cache è una tabella hash divisa in B_CACHE_SHARDS
+ * shard indipendenti:
+ *
+ *   - LETTURA senza lock: il reader entra in un'epoca, scorre la catena
+ *     del bucket con load atomici e fa b_obj_retain() sul documento trovato
+ *   - SCRITTURA con il mutex dello shard: i nodi rimossi o sostituiti non
+ *     vengono liberati subito ma "ritirati"
+ *   - RECUPERO per epoche: un nodo ritirato nell'epoca e viene liberato solo
+ *     quando l'epoca globale è >= e + 2, cioè quando nessun reader può
+ *     ancora averlo raggiunto
+ *   - EVIZIONE CLOCK: ogni shard ha un budget di byte; in inserimento,
+ *     se il budget è superato, la lancetta scorre l'anello degli elementi,
+ *     azzera il bit "referenced" di quelli letti di recente ed espelle il
+ *     primo non referenziato
+ *
+ * I documenti sono b_obj con conteggio dei riferimenti (structs.h): la
+ * cache ne possiede uno, ogni b_cache_get() ne restituisce un altro al
+ * chiamante. Un documento espulso resta valido finché chi lo sta usando
+ * non chiama b_obj_release().
+ *
+ * Ogni thread che legge deve registrarsi con b_cache_thread_register().
+ *
+ * ============================================================================
+ */
+
+#define B_CACHE_HASH_LENGTH   20    /* Lunghezza di un info-hash (SHA1) */
+#define B_CACHE_SHARDS        16    /* Shard indipendenti (potenza di 2) */
+#define B_CACHE_MAX_THREADS   128   /* Thread registrabili contemporaneamente */
+
+
+/* ============================================================================
+ * STRUCT: cache
+ * ============================================================================
+ */
+
+/**
+ * @struct b_cache_entry
+ * @brief Elemento della cache (nodo della catena di un bucket)
+ */
+typedef struct b_cache_entry {
+    unsigned char hash[B_CACHE_HASH_LENGTH];  /* Info-hash */
+    unsigned char referenced;                 /* Bit CLOCK: letto di recente */
+    b_obj *doc;                               /* Documento (un riferimento è della cache) */
+    size_t bytes;                             /* Costo in memoria contato nel budget */
+    size_t ring_pos;                          /* Posizione nell'anello CLOCK */
+    struct b_cache_entry *next;               /* Catena del bucket */
+    struct b_cache_entry *retired_next;       /* Lista dei nodi ritirati */
+    uint64_t retire_epoch;                    /* Epoca globale al ritiro */
+} b_cache_entry;
+
+/**
+ * @struct b_cache_thread
+ * @brief Stato di un thread registrato (allineato alla linea di cache)
+ */
+typedef struct {
+    uint64_t epoch;   /* Epoca osservata all'ingresso */
+    int active;       /* 1 durante una lettura */
+    int in_use;       /* 1 se lo slot è assegnato a un thread */
+} __attribute__((aligned(64))) b_cache_thread;
+
+/**
+ * @struct b_cache_shard
+ * @brief Porzione indipendente della cache
+ *
+ * - buckets:  teste delle catene (lette senza lock)
+ * - ring:     elementi presenti, nell'ordine della lancetta CLOCK
+ * - retired:  nodi rimossi in attesa che passino due epoche
+ */
+typedef struct {
+    pthread_mutex_t lock;
+    b_cache_entry **buckets;
+    b_cache_entry **ring;
+    size_t n_entries, ring_cap, hand;
+    size_t bytes, max_bytes;
+    b_cache_entry *retired;
+} __attribute__((aligned(64))) b_cache_shard;
+
+/**
+ * @struct b_cache
+ * @brief Cache concorrente con budget di memoria
+ */
+typedef struct {
+    b_cache_shard shards[B_CACHE_SHARDS];
+    size_t n_buckets;                          /* Bucket per shard (potenza di 2) */
+    uint64_t epoch;                            /* Epoca globale */
+    b_cache_thread threads[B_CACHE_MAX_THREADS];
+} b_cache;
+
+
+/* ============================================================================
+ * FUNZIONI: creazione e distruzione
+ * ============================================================================
+ */
+
+/**
+ * @brief Crea una cache
+ *
+ * @param max_bytes        Budget totale (diviso equamente tra gli shard)
+ * @param expected_entries Numero atteso di documenti (dimensiona i bucket)
+ *
+ * @return Cache allocata, da liberare con b_cache_free()
+ */
+b_cache* b_cache_new(size_t max_bytes, size_t expected_entries);
+
+/**
+ * @brief Libera la cache e rilascia tutti i documenti
+ *
+ * @note Nessun altro thread deve usare la cache durante la chiamata
+ */
+void b_cache_free(b_cache *cache);
+
+
+/* ============================================================================
+ * FUNZIONI: registrazione dei thread
+ * ============================================================================
+ */
+
+/**
+ * @brief Registra il thread chiamante come lettore
+ *
+ * @return Handle da passare a b_cache_get(); termina con exit(-1) se ci
+ *         sono già B_CACHE_MAX_THREADS thread registrati
+ */
+b_cache_thread* b_cache_thread_register(b_cache *cache);
+
+/**
+ * @brief Libera lo slot del thread (da chiamare fuori da ogni lettura)
+ */
+void b_cache_thread_unregister(b_cache_thread *thread);
+
+
+/* ============================================================================
+ * FUNZIONI: operazioni
+ * ============================================================================
+ */
+
+/**
+ * @brief Cerca il documento con l'info-hash indicato (senza lock)
+ *
+ * @return Documento con un riferimento per il chiamante (da rilasciare
+ *         con b_obj_release()), NULL se assente
+ */
+b_obj* b_cache_get(b_cache *cache, b_cache_thread *thread, const unsigned char *hash);
+
+/**
+ * @brief Inserisce o sostituisce il documento associato a hash
+ *
+ * La cache prende un proprio riferimento (b_obj_retain): il chiamante
+ * conserva il suo. Se il budget dello shard è superato vengono espulsi
+ * elementi con l'algoritmo CLOCK.
+ *
+ * @param bytes Costo del documento; 0 = memoria reale dell'albero (b_obj_footprint())
+ *
+ * @return 0 se inserito, -1 se il documento da solo supera il budget
+ *         dello shard (non inserito)
+ */
+int b_cache_put(b_cache *cache, const unsigned char *hash, b_obj *doc, size_t bytes);
+
+/**
+ * @brief Rimuove il documento associato a hash
+ *
+ * @return 1 se era presente, 0 altrimenti
+ */
+int b_cache_remove(b_cache *cache, const unsigned char *hash);
+
+/**
+ * @brief Numero di documenti presenti
+ */
+size_t b_cache_count(b_cache *cache);
+
+/**
+ * @brief Byte contati nel budget (somma dei costi dei documenti presenti)
+ */
+size_t b_cache_bytes(b_cache *cache);
+
+
+#endif  /* CACHE_H */
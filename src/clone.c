@@ -0,0 +1,454 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+#include "clone.h"
+#include "structs.h"
+
+/* ============================================================================
+ * HELPER: arena e tabella di interning
+ * ============================================================================
+ */
+
+#define ALIGN8(n)  (((n) + 7) & ~(size_t)7)
+
+/**
+ * @brief Allocatore a puntatore crescente dentro il blocco del clone
+ */
+typedef struct {
+    char *next;
+    uint64_t stamp;     /* verified delle forme codificate copiate */
+} arena;
+
+static void* arena_take(arena *a, size_t n) {
+    void *p = a->next;
+    a->next += ALIGN8(n);
+    return p;
+}
+
+/**
+ * @brief Voce della tabella di interning: chiave (forma codificata) → copia
+ *
+ * obj è NULL dopo la pre-passata e viene riempito dalla prima copia.
+ */
+typedef struct {
+    const char *key;
+    size_t len;
+    uint32_t hash;
+    b_obj *obj;
+} intern_slot;
+
+typedef struct {
+    intern_slot *slots;
+    size_t cap, count;
+} intern_table;
+
+static uint32_t key_hash(const char *key, size_t len) {
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < len; i++) {
+        h ^= (unsigned char)key[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+/**
+ * @brief Cerca la chiave; se manca la inserisce con obj = NULL
+ *
+ * @param inserted Impostato a 1 se la chiave è stata appena inserita
+ */
+static intern_slot* intern_lookup(intern_table *t, const char *key, size_t len, int *inserted) {
+
+    /* Carico massimo 1/2: oltre si raddoppia (open addressing, probing lineare) */
+    if ((t->count + 1) * 2 > t->cap) {
+        size_t cap = t->cap ? t->cap * 2 : 64;
+        intern_slot *slots = calloc(cap, sizeof(intern_slot));
+        if (slots == NULL) {
+            fprintf(stderr, "Malloc failed in function intern_lookup!\n");
+            exit(-1);
+        }
+        for (size_t i = 0; i < t->cap; i++) {
+            if (t->slots[i].key != NULL) {
+                size_t j = t->slots[i].hash & (cap - 1);
+                while (slots[j].key != NULL) {
+                    j = (j + 1) & (cap - 1);
+                }
+                slots[j] = t->slots[i];
+            }
+        }
+        free(t->slots);
+        t->slots = slots;
+        t->cap = cap;
+    }
+
+    uint32_t h = key_hash(key, len);
+    size_t i = h & (t->cap - 1);
+    while (t->slots[i].key != NULL) {
+        intern_slot *s = &t->slots[i];
+        if (s->hash == h && s->len == len && memcmp(s->key, key, len) == 0) {
+            *inserted = 0;
+            return s;
+        }
+        i = (i + 1) & (t->cap - 1);
+    }
+
+    t->slots[i].key = key;
+    t->slots[i].len = len;
+    t->slots[i].hash = h;
+    t->slots[i].obj = NULL;
+    t->count++;
+    *inserted = 1;
+    return &t->slots[i];
+}
+
+
+/* ============================================================================
+ * HELPER: pre-passata e copia
+ * ============================================================================
+ */
+
+/* Byte del buffer decodificato (terminatore incluso): le stringhe possono
+ * contenere byte nulli, quindi da length e non da strlen() */
+static size_t decoded_bytes(B_TYPE type, const b_element *e) {
+    if (type == B_INT) {
+        return (size_t)e->length - 2 + 1;
+    }
+    return bytestring_payload_length(e->length) + 1;
+}
+
+/**
+ * @brief Byte necessari per copiare obj e i suoi discendenti
+ */
+static size_t clone_size(b_obj *obj, intern_table *keys) {
+    size_t total = ALIGN8(sizeof(b_obj)) + ALIGN8(sizeof(b_box));
+
+    switch (get_object_type(obj)) {
+
+        case B_INT:
+        case B_STR: {
+            b_element *e = obj->object->int_str;
+            total += ALIGN8(sizeof(b_element));
+            total += ALIGN8(decoded_bytes(obj->type, e));
+            total += ALIGN8((size_t)e->length + 1);
+            break;
+        }
+
+        case B_HEX:
+            total += ALIGN8(sizeof(b_pieces)) + ALIGN8((size_t)obj->object->pieces->length);
+            break;
+
+        case B_LIS: {
+            b_list *l = obj->object->list;
+            total += ALIGN8(sizeof(b_list));
+            size_t enc_len;
+            if (b_obj_encoded(obj, &enc_len) != NULL) {
+                total += ALIGN8(enc_len);
+            }
+            for (list_node *n = l->list; n != NULL; n = n->next) {
+                total += ALIGN8(sizeof(list_node)) + clone_size(n->object, keys);
+            }
+            break;
+        }
+
+        case B_DICT: {
+            b_dict *d = obj->object->dict;
+            total += ALIGN8(sizeof(b_dict));
+            size_t enc_len;
+            if (b_obj_encoded(obj, &enc_len) != NULL) {
+                total += ALIGN8(enc_len);
+            }
+            for (dict_node *n = d->dict; n != NULL; n = n->next) {
+                total += ALIGN8(sizeof(dict_node)) + clone_size(n->value, keys);
+
+                /* Chiave già vista: verrà condivisa, non occupa spazio */
+                int inserted = 1;
+                if (keys != NULL && n->key->type == B_STR) {
+                    b_element *k = n->key->object->int_str;
+                    intern_lookup(keys, k->encoded_element, (size_t)k->length, &inserted);
+                }
+                if (inserted) {
+                    total += clone_size(n->key, NULL);
+                }
+            }
+            break;
+        }
+
+        case B_NULL:
+            fprintf(stderr, "Error! Got B_NULL in clone_size!\n");
+            exit(-1);
+    }
+    return total;
+}
+
+/**
+ * @brief Copia obj nell'arena (il b_obj è sempre il primo blocco preso)
+ */
+static b_obj* clone_node(b_obj *src, arena *a, intern_table *keys) {
+    b_obj *dst = arena_take(a, sizeof(b_obj));
+    b_box *box = arena_take(a, sizeof(b_box));
+    dst->type = src->type;
+    dst->refs = B_OBJ_REFS_ARENA;
+    dst->object = box;
+
+    switch (src->type) {
+
+        case B_INT:
+        case B_STR: {
+            b_element *s = src->object->int_str;
+            b_element *e = arena_take(a, sizeof(b_element));
+            size_t dlen = decoded_bytes(src->type, s);
+            e->decoded_element = arena_take(a, dlen);
+            memcpy(e->decoded_element, s->decoded_element, dlen);
+            e->encoded_element = arena_take(a, (size_t)s->length + 1);
+            memcpy(e->encoded_element, s->encoded_element, (size_t)s->length);
+            e->encoded_element[s->length] = '\0';
+            e->length = s->length;
+            box->int_str = e;
+            break;
+        }
+
+        case B_HEX: {
+            b_pieces *s = src->object->pieces;
+            b_pieces *p = arena_take(a, sizeof(b_pieces));
+            p->decoded_pieces = arena_take(a, (size_t)s->length);
+            memcpy(p->decoded_pieces, s->decoded_pieces, (size_t)s->length);
+            p->length = s->length;
+            box->pieces = p;
+            break;
+        }
+
+        case B_LIS: {
+            b_list *s = src->object->list;
+            b_list *l = arena_take(a, sizeof(b_list));
+            size_t enc_len;
+            const char *enc = b_obj_encoded(src, &enc_len);
+            l->encoded_list = NULL;
+            l->length = 0;
+            if (enc != NULL) {
+                l->encoded_list = arena_take(a, enc_len);
+                memcpy(l->encoded_list, enc, enc_len);
+                l->length = (ssize_t)enc_len;
+            }
+            l->arena = 1;
+            l->mutated = 0;
+            l->verified = a->stamp;
+
+            list_node **tail = &l->list;
+            for (list_node *n = s->list; n != NULL; n = n->next) {
+                list_node *node = arena_take(a, sizeof(list_node));
+                node->object = clone_node(n->object, a, keys);
+                *tail = node;
+                tail = &node->next;
+            }
+            *tail = NULL;
+            box->list = l;
+            break;
+        }
+
+        case B_DICT: {
+            b_dict *s = src->object->dict;
+            b_dict *d = arena_take(a, sizeof(b_dict));
+            size_t enc_len;
+            const char *enc = b_obj_encoded(src, &enc_len);
+            d->encoded_dict = NULL;
+            d->length = 0;
+            if (enc != NULL) {
+                d->encoded_dict = arena_take(a, enc_len);
+                memcpy(d->encoded_dict, enc, enc_len);
+                d->length = (ssize_t)enc_len;
+            }
+            d->arena = 1;
+            d->mutated = 0;
+            d->verified = a->stamp;
+
+            dict_node **tail = &d->dict;
+            for (dict_node *n = s->dict; n != NULL; n = n->next) {
+                dict_node *node = arena_take(a, sizeof(dict_node));
+                node->value = clone_node(n->value, a, keys);
+
+                if (keys != NULL && n->key->type == B_STR) {
+                    b_element *k = n->key->object->int_str;
+                    int inserted;
+                    intern_slot *slot = intern_lookup(keys, k->encoded_element,
+                                                      (size_t)k->length, &inserted);
+                    if (slot->obj == NULL) {
+                        slot->obj = clone_node(n->key, a, NULL);
+                    }
+                    node->key = slot->obj;
+                } else {
+                    node->key = clone_node(n->key, a, NULL);
+                }
+
+                *tail = node;
+                tail = &node->next;
+            }
+            *tail = NULL;
+            box->dict = d;
+            break;
+        }
+
+        case B_NULL:
+            break;
+    }
+    return dst;
+}
+
+
+/* ============================================================================
+ * FUNZIONI: copia profonda
+ * ============================================================================
+ */
+
+size_t b_obj_clone_size(b_obj *obj, int flags) {
+
+    /* Input validation */
+    if(obj == NULL){
+        fprintf(stderr, "Error! NULL pointer parsed in function b_obj_clone_size()! ");
+        exit(-1);
+    }
+
+    intern_table keys = { NULL, 0, 0 };
+    size_t total = clone_size(obj, (flags & B_CLONE_INTERN_KEYS) ? &keys : NULL);
+    free(keys.slots);
+    return total;
+}
+
+/**
+ * @brief Copia profonda di un albero in un'unica arena
+ *
+ * La tabella di interning costruita dalla pre-passata viene riusata dalla
+ * copia: le due passate vedono le chiavi nello stesso ordine, quindi la
+ * prima occorrenza di ogni chiave è quella contata e copiata.
+ *
+ * Complessità: O(n) dove n è il numero di nodi, una sola malloc
+ */
+b_obj* b_obj_clone(b_obj *obj, int flags) {
+
+    /* Input validation */
+    if(obj == NULL){
+        fprintf(stderr, "Error! NULL pointer parsed in function b_obj_clone()! ");
+        exit(-1);
+    }
+
+    intern_table table = { NULL, 0, 0 };
+    intern_table *keys = (flags & B_CLONE_INTERN_KEYS) ? &table : NULL;
+
+    size_t total = clone_size(obj, keys);
+    char *block = malloc(total);
+    if (block == NULL) {
+        fprintf(stderr, "Malloc failed in function b_obj_clone!\n");
+        exit(-1);
+    }
+
+    arena a = { block, b_encoded_stamp() };
+    b_obj *clone = clone_node(obj, &a, keys);
+
+    free(table.slots);
+    return clone;
+}
+
+void b_obj_clone_free(b_obj *clone) {
+
+    /* Input validation */
+    if(clone == NULL){
+        fprintf(stderr, "Error! NULL pointer parsed in function b_obj_clone_free()! ");
+        exit(-1);
+    }
+
+    /* Margine di metà contatore: free_obj() sul clone lo decrementa senza liberare */
+    if (b_obj_refcount(clone) < B_OBJ_REFS_ARENA / 2) {
+        fprintf(stderr, "Error! Object not allocated by b_obj_clone in b_obj_clone_free!\n");
+        exit(-1);
+    }
+    free(clone);  /* La radice è all'inizio dell'arena */
+}
+
+
+/* ============================================================================
+ * FUNZIONI: uguaglianza
+ * ============================================================================
+ */
+
+/**
+ * @brief Uguaglianza strutturale di due alberi
+ *
+ * Percorsi rapidi, in ordine:
+ *   1. Stesso puntatore (sottoalberi condivisi dopo copy-on-write)
+ *   2. Tipo diverso
+ *   3. Contenitori con entrambe le forme codificate ancora valide
+ *      (b_obj_encoded()): il decoder è deterministico, quindi forme uguali
+ *      ⇔ alberi uguali e basta un memcmp
+ * Altrimenti confronto ricorsivo elemento per elemento.
+ */
+int b_obj_equal(b_obj *a, b_obj *b) {
+
+    /* Input validation */
+    if(a == NULL || b == NULL){
+        fprintf(stderr, "Error! NULL pointer parsed in function b_obj_equal()! ");
+        exit(-1);
+    }
+
+    if (a == b) {
+        return 1;
+    }
+    if (a->type != b->type) {
+        return 0;
+    }
+
+    switch (a->type) {
+
+        case B_INT:
+        case B_STR: {
+            b_element *x = a->object->int_str, *y = b->object->int_str;
+            return x->length == y->length &&
+                   memcmp(x->encoded_element, y->encoded_element, (size_t)x->length) == 0;
+        }
+
+        case B_HEX: {
+            b_pieces *x = a->object->pieces, *y = b->object->pieces;
+            return x->length == y->length &&
+                   memcmp(x->decoded_pieces, y->decoded_pieces,
+                          bytestring_payload_length(x->length)) == 0;
+        }
+
+        case B_LIS: {
+            size_t xlen, ylen;
+            const char *xenc = b_obj_encoded(a, &xlen), *yenc = b_obj_encoded(b, &ylen);
+            if (xenc != NULL && yenc != NULL) {
+                return xlen == ylen && memcmp(xenc, yenc, xlen) == 0;
+            }
+
+            b_list *x = a->object->list, *y = b->object->list;
+            list_node *n = x->list, *m = y->list;
+            for (; n != NULL && m != NULL; n = n->next, m = m->next) {
+                if (!b_obj_equal(n->object, m->object)) {
+                    return 0;
+                }
+            }
+            return n == NULL && m == NULL;
+        }
+
+        case B_DICT: {
+            size_t xlen, ylen;
+            const char *xenc = b_obj_encoded(a, &xlen), *yenc = b_obj_encoded(b, &ylen);
+            if (xenc != NULL && yenc != NULL) {
+                return xlen == ylen && memcmp(xenc, yenc, xlen) == 0;
+            }
+
+            b_dict *x = a->object->dict, *y = b->object->dict;
+            dict_node *n = x->dict, *m = y->dict;
+            for (; n != NULL && m != NULL; n = n->next, m = m->next) {
+                if (!b_obj_equal(n->key, m->key) || !b_obj_equal(n->value, m->value)) {
+                    return 0;
+                }
+            }
+            return n == NULL && m == NULL;
+        }
+
+        case B_NULL:
+            break;
+    }
+    return 0;
+}
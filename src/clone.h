@@ -0,0 +1,89 @@
+#ifndef CLONE_H
+#define CLONE_H
+
+#include <stddef.h>
+
+#include "structs.h"
+
+/* ============================================================================
+ * PANORAMICA: Copia profonda e uguaglianza strutturale
+ * ============================================================================
+ *
+ * b_obj_clone() copia un albero in UNA sola allocazione (arena):
+ *
+ *   1. Pre-passata: calcola i byte necessari per tutti i nodi, i wrapper,
+ *      le stringhe e le forme codificate (allineati a 8 byte)
+ *   2. malloc() unica della dimensione calcolata
+ *   3. Seconda passata: copia l'albero avanzando un puntatore nell'arena
+ *
+ * Il b_obj radice è all'inizio dell'arena: b_obj_clone_free() la libera con
+ * una sola free(). I nodi hanno refs = B_OBJ_REFS_ARENA (structs.h), quindi
+ * free_obj() su un nodo del clone non fa nulla.
+ *
+ * Il clone è in sola lettura: list_add(), dict_add() e b_obj_touch() su un
+ * suo nodo terminano il programma (la forma codificata e i nodi aggiunti
+ * non sarebbero liberati da b_obj_clone_free()). Per modificarlo si rende
+ * prima il cammino modificabile con b_obj_make_unique(), che copia i nodi
+ * in arena sullo heap.
+ *
+ * Con B_CLONE_INTERN_KEYS le chiavi dei dizionari con lo stesso contenuto
+ * diventano un unico b_obj condiviso (es. "length" e "path" in ogni voce
+ * di info.files).
+ *
+ * b_obj_equal() confronta due alberi. Se entrambi i lati hanno una forma
+ * codificata ancora valida (b_obj_encoded(): nessuna modifica in place nel
+ * sottoalbero), un memcmp tra le due forme decide subito senza scendere nei
+ * figli. Il clone copia solo le forme ancora valide.
+ *
+ * ============================================================================
+ */
+
+#define B_CLONE_INTERN_KEYS  0x1   /* Condivide le chiavi identiche */
+
+
+/* ============================================================================
+ * FUNZIONI: copia profonda
+ * ============================================================================
+ */
+
+/**
+ * @brief Copia profonda di un albero in un'unica arena
+ *
+ * @param obj   Radice da copiare
+ * @param flags 0 oppure B_CLONE_INTERN_KEYS
+ *
+ * @return Radice della copia, da liberare con b_obj_clone_free()
+ *
+ * @note Nessun nodo del clone deve essere usato dopo b_obj_clone_free(),
+ *       anche se nel frattempo è stato passato a b_obj_retain()
+ */
+b_obj* b_obj_clone(b_obj *obj, int flags);
+
+/**
+ * @brief Byte dell'arena che b_obj_clone(obj, flags) allocherebbe
+ */
+size_t b_obj_clone_size(b_obj *obj, int flags);
+
+/**
+ * @brief Libera un clone prodotto da b_obj_clone()
+ */
+void b_obj_clone_free(b_obj *clone);
+
+
+/* ============================================================================
+ * FUNZIONI: uguaglianza
+ * ============================================================================
+ */
+
+/**
+ * @brief Uguaglianza strutturale di due alberi
+ *
+ * Due alberi sono uguali se hanno lo stesso tipo, gli stessi valori e, per
+ * liste e dizionari, gli stessi elementi nello stesso ordine.
+ *
+ * @return 1 se uguali, 0 altrimenti
+ */
+int b_obj_equal(b_obj *a, b_obj *b);
+
+
+#endif  /* CLONE_H */
@@ -0,0 +1,444 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+
+#include "cow.h"
+#include "structs.h"
+
+/* ============================================================================
+ * HELPER: copia delle catene di nodi
+ * ============================================================================
+ */
+
+/**
+ * @brief Copia i nodi di una lista condividendo gli elementi
+ *
+ * Mantiene un puntatore alla coda: O(n) invece dell'O(n^2) di list_add().
+ */
+static b_list* list_copy_nodes(const b_list *src) {
+    b_list *dst = list_init();
+    list_node **tail = &dst->list;
+
+    for (list_node *n = src->list; n != NULL; n = n->next) {
+        list_node *copy = malloc(sizeof(list_node));
+        if (copy == NULL) {
+            fprintf(stderr, "Malloc failed in function list_copy_nodes!\n");
+            exit(-1);
+        }
+        copy->object = b_obj_retain(n->object);
+        copy->next = NULL;
+        *tail = copy;
+        tail = &copy->next;
+    }
+    return dst;
+}
+
+/**
+ * @brief Copia i nodi di un dizionario condividendo chiavi e valori
+ */
+static b_dict* dict_copy_nodes(const b_dict *src) {
+    b_dict *dst = dict_init();
+    dict_node **tail = &dst->dict;
+
+    for (dict_node *n = src->dict; n != NULL; n = n->next) {
+        dict_node *copy = malloc(sizeof(dict_node));
+        if (copy == NULL) {
+            fprintf(stderr, "Malloc failed in function dict_copy_nodes!\n");
+            exit(-1);
+        }
+        copy->key = b_obj_retain(n->key);
+        copy->value = b_obj_retain(n->value);
+        copy->next = NULL;
+        *tail = copy;
+        tail = &copy->next;
+    }
+    return dst;
+}
+
+/**
+ * @brief Duplica un buffer di len byte
+ */
+static void* dup_bytes(const void *src, size_t len, const char *caller) {
+    void *dst = malloc(len > 0 ? len : 1);
+    if (dst == NULL) {
+        fprintf(stderr, "Malloc failed in function %s!\n", caller);
+        exit(-1);
+    }
+    memcpy(dst, src, len);
+    return dst;
+}
+
+/**
+ * @brief Controlla che obj sia del tipo atteso, altrimenti termina
+ */
+static void expect_type(b_obj *obj, B_TYPE type, const char *caller) {
+    if (obj == NULL) {
+        fprintf(stderr, "Error! NULL pointer parsed in function %s()! ", caller);
+        exit(-1);
+    }
+    if (get_object_type(obj) != type) {
+        fprintf(stderr, "Error! Wrong object type in function %s()!\n", caller);
+        exit(-1);
+    }
+}
+
+
+/* ============================================================================
+ * FUNZIONI: copia e unicità
+ * ============================================================================
+ */
+
+/**
+ * @brief Copia superficiale di un oggetto
+ *
+ * Per gli scalari i buffer vengono duplicati: chi chiama b_obj_make_unique()
+ * su un B_STR condiviso deve poterlo modificare senza toccare gli altri.
+ * Per B_HEX vengono copiati length byte, la stessa dimensione allocata da
+ * decode_string().
+ */
+b_obj* b_obj_shallow_copy(b_obj *obj) {
+
+    /* Input validation */
+    if(obj == NULL){
+        fprintf(stderr, "Error! NULL pointer parsed in function b_obj_shallow_copy()! ");
+        exit(-1);
+    }
+
+    switch (get_object_type(obj)) {
+
+        case B_INT:
+        case B_STR: {
+            b_element *src = obj->object->int_str;
+            b_element *dst = malloc(sizeof(b_element));
+            b_box *box = malloc(sizeof(b_box));
+            b_obj *copy = malloc(sizeof(b_obj));
+            if (dst == NULL || box == NULL || copy == NULL) {
+                fprintf(stderr, "Malloc failed in function b_obj_shallow_copy!\n");
+                exit(-1);
+            }
+            /* Dalla lunghezza codificata, non da strlen(): una stringa può
+             * contenere byte nulli */
+            size_t decoded = obj->type == B_INT
+                             ? (size_t)src->length - 2 + 1    /* "i<n>e" senza 'i' ed 'e' */
+                             : bytestring_payload_length(src->length) + 1;
+            dst->decoded_element = dup_bytes(src->decoded_element, decoded,
+                                             "b_obj_shallow_copy");
+            dst->encoded_element = dup_bytes(src->encoded_element,
+                                             (size_t)src->length + 1,
+                                             "b_obj_shallow_copy");
+            dst->length = src->length;
+            box->int_str = dst;
+            copy->type = obj->type;
+            copy->refs = 1;
+            copy->object = box;
+            return copy;
+        }
+
+        case B_HEX: {
+            b_pieces *src = obj->object->pieces;
+            b_pieces *dst = malloc(sizeof(b_pieces));
+            b_box *box = malloc(sizeof(b_box));
+            b_obj *copy = malloc(sizeof(b_obj));
+            if (dst == NULL || box == NULL || copy == NULL) {
+                fprintf(stderr, "Malloc failed in function b_obj_shallow_copy!\n");
+                exit(-1);
+            }
+            dst->decoded_pieces = dup_bytes(src->decoded_pieces, (size_t)src->length,
+                                            "b_obj_shallow_copy");
+            dst->length = src->length;
+            box->pieces = dst;
+            copy->type = B_HEX;
+            copy->refs = 1;
+            copy->object = box;
+            return copy;
+        }
+
+        case B_LIS:
+            return b_obj_new_list(list_copy_nodes(obj->object->list));
+
+        case B_DICT:
+            return b_obj_new_dict(dict_copy_nodes(obj->object->dict));
+
+        case B_NULL:
+            break;
+    }
+
+    fprintf(stderr, "Error! Got B_NULL in b_obj_shallow_copy!\n");
+    exit(-1);
+}
+
+/**
+ * @brief Rende *slot modificabile in place
+ *
+ * refs == 1 significa che solo il chiamante (tramite slot) vede l'oggetto:
+ * nessun altro thread può ottenerne un riferimento, quindi la modifica in
+ * place è sicura. In entrambi i casi il contenitore restituito viene
+ * marcato con b_obj_touch(): la sua forma codificata viene scartata e
+ * quella degli antenati non viene più usata dai percorsi rapidi.
+ */
+b_obj* b_obj_make_unique(b_obj **slot) {
+
+    /* Input validation */
+    if(slot == NULL || *slot == NULL){
+        fprintf(stderr, "Error! NULL pointer parsed in function b_obj_make_unique()! ");
+        exit(-1);
+    }
+
+    if (b_obj_refcount(*slot) != 1) {
+        b_obj *copy = b_obj_shallow_copy(*slot);
+        b_obj_release(*slot);
+        *slot = copy;
+    }
+
+    /* Il chiamante sta per modificarlo: la forma codificata non vale più */
+    b_obj_touch(*slot);
+    return *slot;
+}
+
+
+/* ============================================================================
+ * FUNZIONI: modifiche copy-on-write
+ * ============================================================================
+ */
+
+b_obj* b_obj_cow_dict_set(b_obj *dict, const char *key, b_obj *val) {
+
+    /* Input validation */
+    if(key == NULL || val == NULL){
+        fprintf(stderr, "Error! NULL pointer parsed in function b_obj_cow_dict_set()! ");
+        exit(-1);
+    }
+    expect_type(dict, B_DICT, "b_obj_cow_dict_set");
+
+    b_obj *copy = b_obj_shallow_copy(dict);
+
+    /* Cerca la chiave o il punto di inserimento (prima chiave maggiore) */
+    dict_node **link = &copy->object->dict->dict;
+    while (*link != NULL) {
+        int cmp = strcmp((*link)->key->object->int_str->decoded_element, key);
+        if (cmp == 0) {
+            b_obj_release((*link)->value);
+            (*link)->value = val;
+            return copy;
+        }
+        if (cmp > 0) {
+            break;
+        }
+        link = &(*link)->next;
+    }
+
+    dict_node *node = malloc(sizeof(dict_node));
+    if (node == NULL) {
+        fprintf(stderr, "Malloc failed in function b_obj_cow_dict_set!\n");
+        exit(-1);
+    }
+    node->key = b_obj_new_str(key, strlen(key));
+    node->value = val;
+    node->next = *link;
+    *link = node;
+    return copy;
+}
+
+b_obj* b_obj_cow_dict_remove(b_obj *dict, const char *key) {
+
+    /* Input validation */
+    if(key == NULL){
+        fprintf(stderr, "Error! NULL pointer parsed in function b_obj_cow_dict_remove()! ");
+        exit(-1);
+    }
+    expect_type(dict, B_DICT, "b_obj_cow_dict_remove");
+
+    b_obj *copy = b_obj_shallow_copy(dict);
+
+    for (dict_node **link = &copy->object->dict->dict; *link != NULL; link = &(*link)->next) {
+        if (strcmp((*link)->key->object->int_str->decoded_element, key) == 0) {
+            dict_node *victim = *link;
+            *link = victim->next;
+            b_obj_release(victim->key);
+            b_obj_release(victim->value);
+            free(victim);
+            break;
+        }
+    }
+    return copy;
+}
+
+b_obj* b_obj_cow_list_append(b_obj *list, b_obj *val) {
+
+    /* Input validation */
+    if(val == NULL){
+        fprintf(stderr, "Error! NULL pointer parsed in function b_obj_cow_list_append()! ");
+        exit(-1);
+    }
+    expect_type(list, B_LIS, "b_obj_cow_list_append");
+
+    b_obj *copy = b_obj_shallow_copy(list);
+    list_add(copy->object->list, val);
+    return copy;
+}
+
+b_obj* b_obj_cow_list_set(b_obj *list, size_t index, b_obj *val) {
+
+    /* Input validation */
+    if(val == NULL){
+        fprintf(stderr, "Error! NULL pointer parsed in function b_obj_cow_list_set()! ");
+        exit(-1);
+    }
+    expect_type(list, B_LIS, "b_obj_cow_list_set");
+
+    /* Verifica l'indice prima di copiare */
+    list_node *n = list->object->list->list;
+    for (size_t i = 0; n != NULL && i < index; i++) {
+        n = n->next;
+    }
+    if (n == NULL) {
+        return NULL;
+    }
+
+    b_obj *copy = b_obj_shallow_copy(list);
+    n = copy->object->list->list;
+    for (size_t i = 0; i < index; i++) {
+        n = n->next;
+    }
+    b_obj_release(n->object);
+    n->object = val;
+    return copy;
+}
+
+/**
+ * @brief Nuova versione di root con il valore annidato sostituito
+ *
+ * Algoritmo (ricorsivo sulla profondità):
+ *   1. depth == 1: b_obj_cow_dict_set() sul livello corrente
+ *   2. Altrimenti prende (o crea vuoto) il sottodizionario keys[0],
+ *      ne produce la nuova versione ricorsivamente e la inserisce con
+ *      b_obj_cow_dict_set() in una copia del livello corrente
+ *
+ * Vengono copiati solo depth dizionari; tutto il resto è condiviso.
+ */
+b_obj* b_obj_cow_set_path(b_obj *root, const char *const *keys, size_t depth, b_obj *val) {
+
+    /* Input validation */
+    if(keys == NULL || val == NULL || depth == 0){
+        fprintf(stderr, "Error! NULL pointer parsed in function b_obj_cow_set_path()! ");
+        exit(-1);
+    }
+    expect_type(root, B_DICT, "b_obj_cow_set_path");
+
+    if (depth == 1) {
+        return b_obj_cow_dict_set(root, keys[0], val);
+    }
+
+    b_obj *child = dict_get(root->object->dict, keys[0]);
+    b_obj *new_child;
+
+    if (child == NULL) {
+        b_obj *empty = b_obj_new_dict(dict_init());
+        new_child = b_obj_cow_set_path(empty, keys + 1, depth - 1, val);
+        b_obj_release(empty);
+    } else if (get_object_type(child) != B_DICT) {
+        return NULL;
+    } else {
+        new_child = b_obj_cow_set_path(child, keys + 1, depth - 1, val);
+    }
+
+    if (new_child == NULL) {
+        return NULL;
+    }
+    return b_obj_cow_dict_set(root, keys[0], new_child);
+}
+
+
+/* ============================================================================
+ * FUNZIONI: slot condiviso
+ * ============================================================================
+ */
+
+static void shared_lock(b_shared_doc *shared) {
+    while (__atomic_exchange_n(&shared->lock, 1, __ATOMIC_ACQUIRE)) {
+        /* Attende in lettura per non contendere la linea di cache */
+        while (__atomic_load_n(&shared->lock, __ATOMIC_RELAXED)) {
+        }
+    }
+}
+
+static void shared_unlock(b_shared_doc *shared) {
+    __atomic_store_n(&shared->lock, 0, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief Periodo di grazia: nessun reader può ancora fare retain di un
+ *        puntatore letto prima dello scambio
+ *
+ * Un reader che ha letto il puntatore vecchio si è annunciato prima, in uno
+ * dei due contatori, e ci resta fino a dopo il retain. Ogni contatore viene
+ * atteso una volta dopo lo scambio; l'epoca avanza prima di ogni attesa,
+ * così i reader nuovi entrano nell'altro contatore e non la prolungano.
+ */
+static void shared_wait_readers(b_shared_doc *shared) {
+    for (int phase = 0; phase < 2; phase++) {
+        unsigned old = __atomic_fetch_add(&shared->epoch, 1, __ATOMIC_SEQ_CST) & 1;
+        while (__atomic_load_n(&shared->readers[old], __ATOMIC_SEQ_CST) != 0) {
+        }
+    }
+}
+
+void b_shared_init(b_shared_doc *shared, b_obj *doc) {
+
+    /* Input validation */
+    if(shared == NULL || doc == NULL){
+        fprintf(stderr, "Error! NULL pointer parsed in function b_shared_init()! ");
+        exit(-1);
+    }
+
+    shared->doc = doc;
+    shared->epoch = 0;
+    shared->readers[0] = 0;
+    shared->readers[1] = 0;
+    shared->lock = 0;
+}
+
+b_obj* b_shared_acquire(b_shared_doc *shared) {
+
+    /* Input validation */
+    if(shared == NULL){
+        fprintf(stderr, "Error! NULL pointer parsed in function b_shared_acquire()! ");
+        exit(-1);
+    }
+
+    unsigned e = __atomic_load_n(&shared->epoch, __ATOMIC_SEQ_CST) & 1;
+    __atomic_add_fetch(&shared->readers[e], 1, __ATOMIC_SEQ_CST);
+    b_obj *doc = b_obj_retain(__atomic_load_n(&shared->doc, __ATOMIC_SEQ_CST));
+    __atomic_sub_fetch(&shared->readers[e], 1, __ATOMIC_RELEASE);
+    return doc;
+}
+
+void b_shared_publish(b_shared_doc *shared, b_obj *doc) {
+
+    /* Input validation */
+    if(shared == NULL || doc == NULL){
+        fprintf(stderr, "Error! NULL pointer parsed in function b_shared_publish()! ");
+        exit(-1);
+    }
+
+    shared_lock(shared);
+    b_obj *old = __atomic_exchange_n(&shared->doc, doc, __ATOMIC_SEQ_CST);
+    shared_wait_readers(shared);
+    shared_unlock(shared);
+
+    /* Fuori dal lock: la liberazione di un albero grande non blocca i writer */
+    b_obj_release(old);
+}
+
+void b_shared_destroy(b_shared_doc *shared) {
+
+    /* Input validation */
+    if(shared == NULL){
+        fprintf(stderr, "Error! NULL pointer parsed in function b_shared_destroy()! ");
+        exit(-1);
+    }
+
+    b_obj_release(shared->doc);
+    shared->doc = NULL;
+}
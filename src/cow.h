@@ -0,0 +1,171 @@
+#ifndef COW_H
+#define COW_H
+
+#include <stddef.h>
+
+#include "structs.h"
+
+/* ============================================================================
+ * PANORAMICA: Sottoalberi condivisi e modifica copy-on-write
+ * ============================================================================
+ *
+ * Ogni b_obj ha un contatore atomico di riferimenti (structs.h). Un documento
+ * decodificato può quindi essere letto da più thread senza copie: ognuno
+ * tiene un riferimento alla radice e la rilascia a fine lettura.
+ *
+ * Un writer non modifica mai un nodo condiviso. Le funzioni b_obj_cow_*
+ * producono una NUOVA versione del contenitore: i nodi della catena vengono
+ * copiati, mentre chiavi e valori non toccati sono condivisi con la versione
+ * precedente (solo retain). Le modifiche annidate copiano il solo cammino
+ * dalla radice al nodo modificato (path copying).
+ *
+ * b_shared_doc è lo slot da cui i reader prendono la versione corrente e in
+ * cui il writer pubblica quella nuova:
+ *
+ *   reader:  doc = b_shared_acquire(&slot);  ...legge...  b_obj_release(doc);
+ *   writer:  old = b_shared_acquire(&slot);
+ *            new = b_obj_cow_set_path(old, keys, 2, b_obj_new_int(42));
+ *            b_obj_release(old);
+ *            b_shared_publish(&slot, new);
+ *
+ * I contenitori prodotti qui non hanno forma codificata (encoded_list /
+ * encoded_dict = NULL, length = 0): quella originale non è più valida.
+ *
+ * ============================================================================
+ */
+
+
+/* ============================================================================
+ * STRUCT: slot condiviso
+ * ============================================================================
+ */
+
+/**
+ * @struct b_shared_doc
+ * @brief Puntatore alla versione corrente di un documento condiviso
+ *
+ * I reader non prendono lock: annunciano l'ingresso in readers[epoch & 1],
+ * leggono il puntatore, fanno retain ed escono. Il writer scambia il
+ * puntatore in modo atomico e, prima di rilasciare la versione vecchia,
+ * aspetta un periodo di grazia: avanza l'epoca due volte e ogni volta
+ * attende che il contatore della parità precedente si svuoti. I nuovi
+ * reader entrano nell'altro contatore, quindi l'attesa è limitata. Lo
+ * spinlock serializza solo i writer.
+ */
+typedef struct {
+    b_obj *doc;             /* Versione corrente (lo slot ne possiede un riferimento) */
+    unsigned epoch;         /* La parità sceglie il contatore dei reader */
+    unsigned readers[2];    /* Reader dentro b_shared_acquire(), per parità */
+    int lock;               /* Spinlock tra writer: 0 libero, 1 occupato */
+} b_shared_doc;
+
+
+/* ============================================================================
+ * FUNZIONI: copia e unicità
+ * ============================================================================
+ */
+
+/**
+ * @brief Copia superficiale di un oggetto
+ *
+ * - B_LIS / B_DICT: nuova catena di nodi, figli condivisi (retain)
+ * - B_INT / B_STR / B_HEX: copia completa dei buffer
+ *
+ * @return Nuovo oggetto con refs = 1
+ */
+b_obj* b_obj_shallow_copy(b_obj *obj);
+
+/**
+ * @brief Rende *slot modificabile in place
+ *
+ * Se *slot ha più di un riferimento lo sostituisce con b_obj_shallow_copy()
+ * e rilascia l'originale. Un contenitore restituito è marcato con
+ * b_obj_touch(), quindi le forme codificate degli antenati non vengono più
+ * riusate.
+ *
+ * @return Il nuovo valore di *slot
+ */
+b_obj* b_obj_make_unique(b_obj **slot);
+
+
+/* ============================================================================
+ * FUNZIONI: modifiche copy-on-write
+ * ============================================================================
+ *
+ * Tutte le funzioni lasciano intatto l'input (che resta di proprietà del
+ * chiamante) e ritornano una nuova versione con refs = 1. Il riferimento a
+ * val passa alla nuova versione.
+ */
+
+/**
+ * @brief Nuova versione di dict con key = val
+ *
+ * Se la chiave esiste il valore viene sostituito, altrimenti la coppia è
+ * inserita rispettando l'ordine lessicografico delle chiavi.
+ */
+b_obj* b_obj_cow_dict_set(b_obj *dict, const char *key, b_obj *val);
+
+/**
+ * @brief Nuova versione di dict senza key (copia identica se key non esiste)
+ */
+b_obj* b_obj_cow_dict_remove(b_obj *dict, const char *key);
+
+/**
+ * @brief Nuova versione di list con val aggiunto in coda
+ */
+b_obj* b_obj_cow_list_append(b_obj *list, b_obj *val);
+
+/**
+ * @brief Nuova versione di list con l'elemento index sostituito da val
+ *
+ * @return NULL se index è fuori dalla lista (val non viene consumato)
+ */
+b_obj* b_obj_cow_list_set(b_obj *list, size_t index, b_obj *val);
+
+/**
+ * @brief Nuova versione di root con root[keys[0]]...[keys[depth-1]] = val
+ *
+ * Copia solo i dizionari lungo il cammino; i dizionari intermedi mancanti
+ * vengono creati.
+ *
+ * @return NULL se un nodo intermedio esiste ma non è un B_DICT
+ *         (val non viene consumato)
+ */
+b_obj* b_obj_cow_set_path(b_obj *root, const char *const *keys, size_t depth, b_obj *val);
+
+
+/* ============================================================================
+ * FUNZIONI: slot condiviso
+ * ============================================================================
+ */
+
+/**
+ * @brief Inizializza lo slot con doc (il riferimento passa allo slot)
+ */
+void b_shared_init(b_shared_doc *shared, b_obj *doc);
+
+/**
+ * @brief Versione corrente, con un riferimento per il chiamante
+ *
+ * Senza lock: non attende né i writer né gli altri reader.
+ *
+ * @note Il chiamante deve rilasciarla con b_obj_release()
+ */
+b_obj* b_shared_acquire(b_shared_doc *shared);
+
+/**
+ * @brief Pubblica doc come versione corrente (il riferimento passa allo slot)
+ *
+ * La versione precedente viene rilasciata dopo che i reader in corso di
+ * b_shared_acquire() ne hanno fatto retain: è liberata quando l'ultimo
+ * reader che la sta usando chiama b_obj_release().
+ */
+void b_shared_publish(b_shared_doc *shared, b_obj *doc);
+
+/**
+ * @brief Rilascia la versione corrente; lo slot non è più utilizzabile
+ */
+void b_shared_destroy(b_shared_doc *shared);
+
+
+#endif  /* COW_H */
@@ -0,0 +1,261 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "cursor.h"
+
+/* ============================================================================
+ * HELPER: stato del cursore
+ * ============================================================================
+ */
+
+static int fail(b_cursor *cur, ssize_t code) {
+    cur->error = (int)code;
+    return (int)code;
+}
+
+/**
+ * @brief Calcola (se non già nota) la fine del valore corrente
+ *
+ * Interi e bytestring sono già stati delimitati da b_cursor_next(); per i
+ * contenitori serve bencode_skip().
+ */
+static int resolve_value_end(b_cursor *cur) {
+    if (cur->value_end != 0) {
+        return 0;
+    }
+    ssize_t r = bencode_skip(cur->buf, cur->len, cur->value_pos);
+    if (r < 0) {
+        return fail(cur, r);
+    }
+    cur->value_end = (size_t)r;
+    return 0;
+}
+
+
+/* ============================================================================
+ * FUNZIONI: navigazione
+ * ============================================================================
+ */
+
+int b_cursor_init(b_cursor *cur, const char *buf, size_t len) {
+
+    /* Input validation */
+    if(cur == NULL || (buf == NULL && len > 0)){
+        fprintf(stderr, "Error! NULL pointer parsed in function b_cursor_init()! ");
+        exit(-1);
+    }
+
+    memset(cur, 0, sizeof(*cur));
+    cur->buf = buf;
+    cur->len = len;
+    if (len == 0) {
+        return fail(cur, B_SCHEMA_INCOMPLETE);
+    }
+    if (buf[0] != 'l' && buf[0] != 'd') {
+        return fail(cur, B_SCHEMA_TYPE);
+    }
+    cur->kind = buf[0];
+    cur->pos = 1;
+    return 0;
+}
+
+/**
+ * @brief Avanza all'elemento successivo
+ *
+ * Salta il valore corrente (riusando value_end se già noto), legge la
+ * chiave se il contenitore è un dizionario e delimita subito i valori
+ * scalari: per loro value_end costa quanto leggerli.
+ */
+int b_cursor_next(b_cursor *cur) {
+
+    /* Input validation */
+    if(cur == NULL){
+        fprintf(stderr, "Error! NULL pointer parsed in function b_cursor_next()! ");
+        exit(-1);
+    }
+
+    if (cur->error != 0) {
+        return cur->error;
+    }
+    if (cur->end != 0) {
+        return 0;
+    }
+
+    /* Salta il valore corrente */
+    if (cur->value_pos != 0) {
+        int rc = resolve_value_end(cur);
+        if (rc < 0) {
+            return rc;
+        }
+        cur->pos = cur->value_end;
+        cur->value_pos = 0;
+        cur->value_end = 0;
+    }
+
+    if (cur->pos >= cur->len) {
+        return fail(cur, B_SCHEMA_INCOMPLETE);
+    }
+    if (cur->buf[cur->pos] == 'e') {
+        cur->end = cur->pos + 1;
+        cur->key.ptr = NULL;
+        cur->key.len = 0;
+        return 0;
+    }
+
+    size_t pos = cur->pos;
+    if (cur->kind == 'd') {
+        ssize_t r = bencode_read_bytes(cur->buf, cur->len, pos, &cur->key);
+        if (r < 0) {
+            return fail(cur, r == B_SCHEMA_TYPE ? B_SCHEMA_INVALID : r);
+        }
+        pos = (size_t)r;
+    }
+    if (pos >= cur->len) {
+        return fail(cur, B_SCHEMA_INCOMPLETE);
+    }
+
+    cur->value_pos = pos;
+    char c = cur->buf[pos];
+    ssize_t r = 0;
+    if (c == 'i') {
+        r = bencode_read_int(cur->buf, cur->len, pos, NULL);
+    } else if (c >= '0' && c <= '9') {
+        r = bencode_read_bytes(cur->buf, cur->len, pos, NULL);
+    } else if (c != 'l' && c != 'd') {
+        r = B_SCHEMA_INVALID;
+    }
+    if (r < 0) {
+        return fail(cur, r);
+    }
+    cur->value_end = (size_t)r;
+    return 1;
+}
+
+int b_cursor_find(b_cursor *cur, const char *key, size_t key_len) {
+
+    /* Input validation */
+    if(cur == NULL || (key == NULL && key_len > 0)){
+        fprintf(stderr, "Error! NULL pointer parsed in function b_cursor_find()! ");
+        exit(-1);
+    }
+
+    if (cur->kind != 'd') {
+        return B_SCHEMA_TYPE;
+    }
+
+    int rc;
+    while ((rc = b_cursor_next(cur)) > 0) {
+        if (cur->key.len == key_len && memcmp(cur->key.ptr, key, key_len) == 0) {
+            return 1;
+        }
+    }
+    return rc;
+}
+
+int b_cursor_descend(const b_cursor *cur, b_cursor *child) {
+
+    /* Input validation */
+    if(cur == NULL || child == NULL){
+        fprintf(stderr, "Error! NULL pointer parsed in function b_cursor_descend()! ");
+        exit(-1);
+    }
+
+    if (cur->value_pos == 0 || cur->error != 0) {
+        return B_SCHEMA_TYPE;
+    }
+
+    /* Il figlio vede il resto del buffer: la sua fine la trova da sé */
+    return b_cursor_init(child, cur->buf + cur->value_pos, cur->len - cur->value_pos);
+}
+
+void b_cursor_ascend(b_cursor *cur, const b_cursor *child) {
+
+    /* Input validation */
+    if(cur == NULL || child == NULL){
+        fprintf(stderr, "Error! NULL pointer parsed in function b_cursor_ascend()! ");
+        exit(-1);
+    }
+
+    if (child->end != 0 && child->buf == cur->buf + cur->value_pos) {
+        cur->value_end = cur->value_pos + child->end;
+    }
+}
+
+
+/* ============================================================================
+ * FUNZIONI: elemento corrente
+ * ============================================================================
+ */
+
+b_span b_cursor_key(const b_cursor *cur) {
+    b_span key = { NULL, 0 };
+    if (cur != NULL && cur->kind == 'd' && cur->value_pos != 0) {
+        key = cur->key;
+    }
+    return key;
+}
+
+B_TYPE b_cursor_type(const b_cursor *cur) {
+    if (cur == NULL || cur->value_pos == 0) {
+        return B_NULL;
+    }
+    char c = cur->buf[cur->value_pos];
+    if (c == 'i') {
+        return B_INT;
+    }
+    if (c == 'l') {
+        return B_LIS;
+    }
+    if (c == 'd') {
+        return B_DICT;
+    }
+    return B_STR;
+}
+
+b_span b_cursor_value_span(b_cursor *cur) {
+    b_span span = { NULL, 0 };
+
+    /* Input validation */
+    if(cur == NULL){
+        fprintf(stderr, "Error! NULL pointer parsed in function b_cursor_value_span()! ");
+        exit(-1);
+    }
+
+    if (cur->value_pos == 0 || resolve_value_end(cur) < 0) {
+        return span;
+    }
+    span.ptr = cur->buf + cur->value_pos;
+    span.len = cur->value_end - cur->value_pos;
+    return span;
+}
+
+int b_cursor_value_int(b_cursor *cur, int64_t *out) {
+
+    /* Input validation */
+    if(cur == NULL || out == NULL){
+        fprintf(stderr, "Error! NULL pointer parsed in function b_cursor_value_int()! ");
+        exit(-1);
+    }
+
+    if (cur->value_pos == 0) {
+        return B_SCHEMA_TYPE;
+    }
+    ssize_t r = bencode_read_int(cur->buf, cur->len, cur->value_pos, out);
+    return r < 0 ? (int)r : 0;
+}
+
+int b_cursor_value_bytes(b_cursor *cur, b_span *out) {
+
+    /* Input validation */
+    if(cur == NULL || out == NULL){
+        fprintf(stderr, "Error! NULL pointer parsed in function b_cursor_value_bytes()! ");
+        exit(-1);
+    }
+
+    if (cur->value_pos == 0) {
+        return B_SCHEMA_TYPE;
+    }
+    ssize_t r = bencode_read_bytes(cur->buf, cur->len, cur->value_pos, out);
+    return r < 0 ? (int)r : 0;
+}
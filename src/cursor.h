@@ -0,0 +1,153 @@
+#ifndef CURSOR_H
+#define CURSOR_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+#include "structs.h"
+#include "schema.h"
+
+/* ============================================================================
+ * PANORAMICA: Cursori su liste e dizionari codificati
+ * ============================================================================
+ *
+ * Per leggere un campo di una lista non serve decode_list() e poi scorrere
+ * list_node->next: un b_cursor scorre direttamente il buffer bencode.
+ *
+ *   b_cursor root, info, files, file;
+ *   b_cursor_init(&root, buf, len);
+ *   b_cursor_find(&root, "info", 4);   b_cursor_descend(&root, &info);
+ *   b_cursor_find(&info, "files", 5);  b_cursor_descend(&info, &files);
+ *   while (b_cursor_next(&files) > 0) {
+ *       b_cursor_descend(&files, &file);
+ *       ... b_cursor_find(&file, "length", 6), b_cursor_value_int() ...
+ *       b_cursor_ascend(&files, &file);
+ *   }
+ *
+ * Un cursore è una piccola struct sullo stack e non alloca nulla. Ogni
+ * elemento viene attraversato una sola volta: la fine del valore corrente
+ * si calcola solo quando serve (b_cursor_next, b_cursor_value_span), e
+ * b_cursor_ascend() riporta al genitore la fine già trovata dal figlio,
+ * così scendere in un valore e poi avanzare non lo scandisce due volte.
+ *
+ * Gli errori usano i codici B_SCHEMA_* e restano nel cursore: dopo un
+ * errore b_cursor_next() continua a restituirlo.
+ *
+ * ============================================================================
+ */
+
+
+/* ============================================================================
+ * STRUCT: cursore
+ * ============================================================================
+ */
+
+/**
+ * @struct b_cursor
+ * @brief Posizione dentro una lista o un dizionario codificato
+ *
+ * Campi:
+ * - buf, len:   buffer (il contenitore e ciò che segue fino a len)
+ * - kind:       'l' oppure 'd'
+ * - pos:        inizio del prossimo elemento (chiave per i dizionari)
+ * - key:        chiave dell'elemento corrente (vuota per le liste)
+ * - value_pos:  inizio del valore corrente
+ * - value_end:  fine del valore corrente, 0 se non ancora calcolata
+ * - end:        offset dopo la 'e' finale, 0 finché non è stata raggiunta
+ * - error:      primo errore incontrato (0 se nessuno)
+ */
+typedef struct {
+    const char *buf;
+    size_t len;
+    char kind;
+    size_t pos;
+    b_span key;
+    size_t value_pos;
+    size_t value_end;
+    size_t end;
+    int error;
+} b_cursor;
+
+
+/* ============================================================================
+ * FUNZIONI: navigazione
+ * ============================================================================
+ */
+
+/**
+ * @brief Posiziona il cursore prima del primo elemento del contenitore in buf[0]
+ *
+ * @return 0, oppure B_SCHEMA_TYPE (buf[0] non è 'l'/'d') / B_SCHEMA_INCOMPLETE
+ */
+int b_cursor_init(b_cursor *cur, const char *buf, size_t len);
+
+/**
+ * @brief Avanza all'elemento successivo
+ *
+ * @return 1 se c'è un elemento corrente, 0 a fine contenitore, un codice
+ *         B_SCHEMA_* negativo in caso di errore
+ */
+int b_cursor_next(b_cursor *cur);
+
+/**
+ * @brief Avanza fino alla chiave indicata (solo dizionari)
+ *
+ * Scorre in avanti dalla posizione corrente: per cercare più chiavi di un
+ * dizionario ordinato conviene cercarle in ordine.
+ *
+ * @return 1 se trovata (elemento corrente), 0 se assente, errore negativo
+ */
+int b_cursor_find(b_cursor *cur, const char *key, size_t key_len);
+
+/**
+ * @brief Crea un cursore sul valore corrente (lista o dizionario)
+ *
+ * @return 0, oppure B_SCHEMA_TYPE se il valore non è un contenitore
+ */
+int b_cursor_descend(const b_cursor *cur, b_cursor *child);
+
+/**
+ * @brief Riporta al genitore la fine del valore già scandito dal figlio
+ *
+ * Facoltativa: se il figlio non è arrivato in fondo non ha effetto.
+ */
+void b_cursor_ascend(b_cursor *cur, const b_cursor *child);
+
+
+/* ============================================================================
+ * FUNZIONI: elemento corrente
+ * ============================================================================
+ */
+
+/**
+ * @brief Chiave dell'elemento corrente (ptr NULL per le liste)
+ */
+b_span b_cursor_key(const b_cursor *cur);
+
+/**
+ * @brief Tipo del valore corrente: B_INT, B_STR, B_LIS, B_DICT o B_NULL
+ */
+B_TYPE b_cursor_type(const b_cursor *cur);
+
+/**
+ * @brief Codifica completa del valore corrente (ptr NULL in caso di errore)
+ */
+b_span b_cursor_value_span(b_cursor *cur);
+
+/**
+ * @brief Valore intero corrente
+ *
+ * @return 0, oppure un codice B_SCHEMA_* negativo
+ */
+int b_cursor_value_int(b_cursor *cur, int64_t *out);
+
+/**
+ * @brief Contenuto della bytestring corrente (senza "<n>:")
+ *
+ * @return 0, oppure un codice B_SCHEMA_* negativo
+ */
+int b_cursor_value_bytes(b_cursor *cur, b_span *out);
+
+
+#endif  /* CURSOR_H */
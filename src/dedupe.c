@@ -0,0 +1,379 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#include "dedupe.h"
+
+/* ============================================================================
+ * HELPER: posizioni ricavate dall'hash
+ * ============================================================================
+ *
+ * Byte 0..7 → impronta (e bit del filtro), byte 8..15 → posizione nella
+ * tabella, byte 16..19 → blocco del filtro. Gli hash SHA-1 sono uniformi,
+ * quindi le tre parti sono indipendenti.
+ */
+
+static inline uint64_t load_u64(const unsigned char *p) {
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline uint64_t hash_fingerprint(const unsigned char *hash) {
+    uint64_t fp = load_u64(hash);
+    return fp ? fp : 1;
+}
+
+static inline size_t hash_slot(const b_dedupe *idx, const unsigned char *hash) {
+    return (size_t)load_u64(hash + 8) & (idx->capacity - 1);
+}
+
+static inline uint64_t* bloom_block(const b_dedupe *idx, const unsigned char *hash) {
+    uint32_t b;
+    memcpy(&b, hash + 16, sizeof(b));
+    return idx->bloom + (size_t)(b & (idx->bloom_blocks - 1)) * 8;
+}
+
+static void bloom_set(b_dedupe *idx, const unsigned char *hash) {
+    uint64_t *block = bloom_block(idx, hash);
+    uint64_t fp = load_u64(hash);
+    for (int k = 0; k < B_DEDUPE_BLOOM_PROBES; k++) {
+        unsigned bit = (unsigned)(fp >> (9 * k)) & 511;
+        __atomic_fetch_or(&block[bit >> 6], (uint64_t)1 << (bit & 63), __ATOMIC_RELAXED);
+    }
+}
+
+static int bloom_test(const b_dedupe *idx, const unsigned char *hash) {
+    const uint64_t *block = bloom_block(idx, hash);
+    uint64_t fp = load_u64(hash);
+    for (int k = 0; k < B_DEDUPE_BLOOM_PROBES; k++) {
+        unsigned bit = (unsigned)(fp >> (9 * k)) & 511;
+        if (!(block[bit >> 6] & ((uint64_t)1 << (bit & 63)))) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static size_t next_pow2(size_t n) {
+    size_t p = 1;
+    while (p < n) {
+        p <<= 1;
+    }
+    return p;
+}
+
+
+/* ============================================================================
+ * FUNZIONI: costruzione
+ * ============================================================================
+ */
+
+b_dedupe* b_dedupe_new(size_t expected_pieces) {
+    if (expected_pieces == 0) {
+        expected_pieces = 1;
+    }
+
+    b_dedupe *idx = malloc(sizeof(b_dedupe));
+    if (idx == NULL) {
+        fprintf(stderr, "Malloc failed in function b_dedupe_new!\n");
+        exit(-1);
+    }
+
+    idx->capacity = next_pow2((size_t)(expected_pieces / B_DEDUPE_MAX_LOAD) + 1);
+    idx->max_count = (size_t)(idx->capacity * B_DEDUPE_MAX_LOAD);
+    idx->bloom_blocks = next_pow2((expected_pieces * B_DEDUPE_BLOOM_BITS + 511) / 512);
+    idx->count = 0;
+
+    /* Blocchi del filtro allineati alla riga di cache */
+    idx->entries = calloc(idx->capacity, sizeof(b_dedupe_entry));
+    idx->bloom = aligned_alloc(64, idx->bloom_blocks * 64);
+    if (idx->entries == NULL || idx->bloom == NULL) {
+        fprintf(stderr, "Malloc failed in function b_dedupe_new!\n");
+        exit(-1);
+    }
+    memset(idx->bloom, 0, idx->bloom_blocks * 64);
+
+    return idx;
+}
+
+void b_dedupe_free(b_dedupe *idx) {
+    if (idx == NULL) {
+        return;
+    }
+    free(idx->entries);
+    free(idx->bloom);
+    free(idx);
+}
+
+/**
+ * @brief Inserisce gli hash di un torrent
+ *
+ * Lo spazio per tutti i pezzi è riservato in anticipo con un solo
+ * incremento atomico di count; ogni voce si occupa con un CAS
+ * sull'impronta (0 → fp), quindi più thread possono inserire insieme.
+ */
+int b_dedupe_add(b_dedupe *idx, uint32_t torrent, const unsigned char *hashes, size_t n_pieces) {
+
+    /* Input validation */
+    if(idx == NULL || (hashes == NULL && n_pieces > 0)){
+        fprintf(stderr, "Error! NULL pointer parsed in function b_dedupe_add()! ");
+        exit(-1);
+    }
+
+    size_t before = __atomic_fetch_add(&idx->count, n_pieces, __ATOMIC_RELAXED);
+    if (before + n_pieces > idx->max_count) {
+        __atomic_fetch_sub(&idx->count, n_pieces, __ATOMIC_RELAXED);
+        return B_DEDUPE_FULL;
+    }
+
+    size_t mask = idx->capacity - 1;
+    for (size_t p = 0; p < n_pieces; p++) {
+        const unsigned char *hash = hashes + p * B_SHA1_DIGEST_LENGTH;
+        uint64_t fp = hash_fingerprint(hash);
+        size_t slot = hash_slot(idx, hash);
+
+        while (1) {
+            b_dedupe_entry *e = &idx->entries[slot];
+            uint64_t empty = 0;
+            if (__atomic_load_n(&e->fingerprint, __ATOMIC_RELAXED) == 0 &&
+                __atomic_compare_exchange_n(&e->fingerprint, &empty, fp, 0,
+                                            __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                e->torrent = torrent;
+                e->piece = (uint32_t)p;
+                break;
+            }
+            slot = (slot + 1) & mask;
+        }
+        bloom_set(idx, hash);
+    }
+    return 0;
+}
+
+size_t b_dedupe_pieces(const b_obj *obj, const unsigned char **hashes) {
+
+    /* Input validation */
+    if(obj == NULL || hashes == NULL){
+        fprintf(stderr, "Error! NULL pointer parsed in function b_dedupe_pieces()! ");
+        exit(-1);
+    }
+
+    *hashes = NULL;
+    if (obj->type != B_HEX || obj->object == NULL || obj->object->pieces == NULL) {
+        return 0;
+    }
+
+    const b_pieces *pieces = obj->object->pieces;
+    if (pieces->length <= 0) {
+        return 0;
+    }
+    size_t n = bytestring_payload_length(pieces->length);
+    if (n % B_SHA1_DIGEST_LENGTH != 0) {
+        return 0;
+    }
+    *hashes = pieces->decoded_pieces;
+    return n / B_SHA1_DIGEST_LENGTH;
+}
+
+/* ============================================================================
+ * HELPER: inserimento parallelo
+ * ============================================================================
+ */
+
+typedef struct {
+    b_dedupe *idx;
+    const b_dedupe_torrent *torrents;
+    size_t from, to;
+    int result;
+} dedupe_job;
+
+static void* dedupe_worker(void *arg) {
+    dedupe_job *job = arg;
+    job->result = 0;
+    for (size_t i = job->from; i < job->to; i++) {
+        const b_dedupe_torrent *t = &job->torrents[i];
+        if (b_dedupe_add(job->idx, t->id, t->hashes, t->n_pieces) != 0) {
+            job->result = B_DEDUPE_FULL;
+            break;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Divide i torrent in intervalli contigui con circa lo stesso numero di pezzi
+ */
+int b_dedupe_add_bulk(b_dedupe *idx, const b_dedupe_torrent *torrents, size_t n, int n_threads) {
+
+    /* Input validation */
+    if(idx == NULL || (torrents == NULL && n > 0)){
+        fprintf(stderr, "Error! NULL pointer parsed in function b_dedupe_add_bulk()! ");
+        exit(-1);
+    }
+
+    long threads = n_threads > 0 ? n_threads : sysconf(_SC_NPROCESSORS_ONLN);
+    if (threads < 1) {
+        threads = 1;
+    }
+    if ((size_t)threads > n) {
+        threads = n ? (long)n : 1;
+    }
+
+    size_t total = 0;
+    for (size_t i = 0; i < n; i++) {
+        total += torrents[i].n_pieces;
+    }
+
+    dedupe_job *jobs = malloc(sizeof(dedupe_job) * (size_t)threads);
+    pthread_t *tids = malloc(sizeof(pthread_t) * (size_t)threads);
+    if (jobs == NULL || tids == NULL) {
+        fprintf(stderr, "Malloc failed in function b_dedupe_add_bulk!\n");
+        exit(-1);
+    }
+
+    size_t i = 0, acc = 0;
+    for (long t = 0; t < threads; t++) {
+        size_t target = total / (size_t)threads * (size_t)(t + 1);
+        jobs[t].idx = idx;
+        jobs[t].torrents = torrents;
+        jobs[t].from = i;
+        while (i < n && (t == threads - 1 || acc < target)) {
+            acc += torrents[i].n_pieces;
+            i++;
+        }
+        jobs[t].to = i;
+    }
+
+    /* Il thread chiamante fa il lavoro del primo intervallo */
+    for (long t = 1; t < threads; t++) {
+        if (pthread_create(&tids[t], NULL, dedupe_worker, &jobs[t]) != 0) {
+            fprintf(stderr, "Error! pthread_create failed in function b_dedupe_add_bulk!\n");
+            exit(-1);
+        }
+    }
+    dedupe_worker(&jobs[0]);
+
+    int result = jobs[0].result;
+    for (long t = 1; t < threads; t++) {
+        pthread_join(tids[t], NULL);
+        if (jobs[t].result != 0) {
+            result = jobs[t].result;
+        }
+    }
+
+    free(jobs);
+    free(tids);
+    return result;
+}
+
+
+/* ============================================================================
+ * FUNZIONI: ricerca
+ * ============================================================================
+ */
+
+size_t b_dedupe_find(const b_dedupe *idx, const unsigned char *hashes, size_t n_pieces,
+                     b_dedupe_match *out, size_t max) {
+
+    /* Input validation */
+    if(idx == NULL || (hashes == NULL && n_pieces > 0) || (out == NULL && max > 0)){
+        fprintf(stderr, "Error! NULL pointer parsed in function b_dedupe_find()! ");
+        exit(-1);
+    }
+
+    size_t mask = idx->capacity - 1;
+    size_t found = 0;
+    for (size_t p = 0; p < n_pieces; p++) {
+        const unsigned char *hash = hashes + p * B_SHA1_DIGEST_LENGTH;
+        if (!bloom_test(idx, hash)) {
+            continue;
+        }
+
+        uint64_t fp = hash_fingerprint(hash);
+        for (size_t slot = hash_slot(idx, hash); idx->entries[slot].fingerprint != 0;
+             slot = (slot + 1) & mask) {
+            const b_dedupe_entry *e = &idx->entries[slot];
+            if (e->fingerprint != fp) {
+                continue;
+            }
+            if (found < max) {
+                out[found].torrent = e->torrent;
+                out[found].piece = e->piece;
+                out[found].query_piece = (uint32_t)p;
+            }
+            found++;
+        }
+    }
+    return found;
+}
+
+static int cmp_match(const void *x, const void *y) {
+    const b_dedupe_match *a = x, *b = y;
+    if (a->torrent != b->torrent) {
+        return a->torrent < b->torrent ? -1 : 1;
+    }
+    return (a->query_piece > b->query_piece) - (a->query_piece < b->query_piece);
+}
+
+static int cmp_shared(const void *x, const void *y) {
+    const b_dedupe_shared *a = x, *b = y;
+    if (a->pieces != b->pieces) {
+        return a->pieces > b->pieces ? -1 : 1;
+    }
+    return (a->torrent > b->torrent) - (a->torrent < b->torrent);
+}
+
+/**
+ * @brief Raggruppa le corrispondenze per torrent
+ *
+ * I pezzi in comune si contano sui pezzi distinti della query: un hash
+ * ripetuto dentro lo stesso torrent non li gonfia.
+ */
+size_t b_dedupe_shared_torrents(const b_dedupe *idx, const unsigned char *hashes, size_t n_pieces,
+                                b_dedupe_shared *out, size_t max) {
+
+    /* Input validation */
+    if(idx == NULL || (hashes == NULL && n_pieces > 0) || (out == NULL && max > 0)){
+        fprintf(stderr, "Error! NULL pointer parsed in function b_dedupe_shared_torrents()! ");
+        exit(-1);
+    }
+
+    size_t n = b_dedupe_find(idx, hashes, n_pieces, NULL, 0);
+    if (n == 0) {
+        return 0;
+    }
+    b_dedupe_match *matches = malloc(n * sizeof(b_dedupe_match));
+    if (matches == NULL) {
+        fprintf(stderr, "Malloc failed in function b_dedupe_shared_torrents!\n");
+        exit(-1);
+    }
+    b_dedupe_find(idx, hashes, n_pieces, matches, n);
+    qsort(matches, n, sizeof(b_dedupe_match), cmp_match);
+
+    /* Compatta in place: matches diventa un array di b_dedupe_shared */
+    b_dedupe_shared *groups = (b_dedupe_shared *)matches;
+    size_t n_groups = 0;
+    for (size_t i = 0; i < n; ) {
+        uint32_t torrent = matches[i].torrent;
+        uint32_t distinct = 0;
+        uint32_t last = UINT32_MAX;
+        for (; i < n && matches[i].torrent == torrent; i++) {
+            if (matches[i].query_piece != last) {
+                distinct++;
+                last = matches[i].query_piece;
+            }
+        }
+        groups[n_groups].torrent = torrent;
+        groups[n_groups].pieces = distinct;
+        n_groups++;
+    }
+    qsort(groups, n_groups, sizeof(b_dedupe_shared), cmp_shared);
+
+    if (max > 0) {
+        memcpy(out, groups, (n_groups < max ? n_groups : max) * sizeof(b_dedupe_shared));
+    }
+    free(matches);
+    return n_groups;
+}
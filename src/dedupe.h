@@ -0,0 +1,175 @@
+#ifndef DEDUPE_H
+#define DEDUPE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "structs.h"
+#include "hash.h"
+
+/* ============================================================================
+ * PANORAMICA: Indice degli hash dei pezzi tra torrent diversi
+ * ============================================================================
+ *
+ * I repack e le raccolte condividono spesso pezzi con altri torrent. Questo
+ * indice raccoglie gli hash SHA-1 da 20 byte del campo "pieces" di un
+ * intero corpus e risponde a "quali torrent condividono contenuto con
+ * questo?".
+ *
+ * Struttura:
+ *   - Tabella a indirizzamento aperto (sondaggio lineare) di voci da 16 byte:
+ *     impronta a 64 bit dell'hash, id del torrent, indice del pezzo. Gli
+ *     hash SHA-1 sono già uniformi: impronta e posizione sono i loro byte,
+ *     senza rimescolare
+ *   - Filtro di Bloom a blocchi davanti alla tabella: tutti i bit di un hash
+ *     stanno in una riga di cache da 64 byte, così un pezzo assente (il caso
+ *     comune) costa un solo accesso in memoria
+ *
+ * La tabella è una multimappa: lo stesso pezzo in più torrent occupa più
+ * voci. Un'impronta a 64 bit può collidere con probabilità ~ voci / 2^64
+ * per ricerca, trascurabile anche con miliardi di pezzi.
+ *
+ * L'inserimento è lock-free (compare-and-swap sulla voce, OR atomico sul
+ * filtro) e b_dedupe_add_bulk() lo distribuisce su più thread. Le ricerche
+ * vanno fatte dopo la fine degli inserimenti.
+ *
+ * ============================================================================
+ */
+
+#define B_DEDUPE_FULL          -1   /* Tabella oltre il carico massimo */
+
+#define B_DEDUPE_MAX_LOAD      0.85 /* Frazione massima di voci occupate */
+#define B_DEDUPE_BLOOM_BITS    12   /* Bit del filtro per voce prevista */
+#define B_DEDUPE_BLOOM_PROBES  7    /* Bit impostati per hash */
+
+
+/* ============================================================================
+ * STRUCT: indice
+ * ============================================================================
+ */
+
+/**
+ * @struct b_dedupe_entry
+ * @brief Voce della tabella (fingerprint 0 = libera)
+ */
+typedef struct {
+    uint64_t fingerprint;
+    uint32_t torrent;
+    uint32_t piece;
+} b_dedupe_entry;
+
+/**
+ * @struct b_dedupe
+ * @brief Indice hash → (torrent, pezzo)
+ *
+ * Campi:
+ * - entries:     tabella di capacity voci (potenza di 2)
+ * - bloom:       filtro di bloom_blocks blocchi da 512 bit
+ * - count:       voci occupate (aggiornato atomicamente)
+ * - max_count:   limite di carico
+ */
+typedef struct {
+    b_dedupe_entry *entries;
+    uint64_t *bloom;
+    size_t capacity;
+    size_t bloom_blocks;
+    size_t count;
+    size_t max_count;
+} b_dedupe;
+
+/**
+ * @struct b_dedupe_torrent
+ * @brief Hash concatenati di un torrent da inserire (n_pieces * 20 byte)
+ */
+typedef struct {
+    uint32_t id;
+    const unsigned char *hashes;
+    size_t n_pieces;
+} b_dedupe_torrent;
+
+/**
+ * @struct b_dedupe_match
+ * @brief Pezzo in comune: query_piece della query è piece del torrent
+ */
+typedef struct {
+    uint32_t torrent;
+    uint32_t piece;
+    uint32_t query_piece;
+} b_dedupe_match;
+
+/**
+ * @struct b_dedupe_shared
+ * @brief Torrent che condivide pieces pezzi con la query
+ */
+typedef struct {
+    uint32_t torrent;
+    uint32_t pieces;
+} b_dedupe_shared;
+
+
+/* ============================================================================
+ * FUNZIONI: costruzione
+ * ============================================================================
+ */
+
+/**
+ * @brief Crea un indice dimensionato per expected_pieces hash
+ */
+b_dedupe* b_dedupe_new(size_t expected_pieces);
+
+/**
+ * @brief Libera l'indice
+ */
+void b_dedupe_free(b_dedupe *idx);
+
+/**
+ * @brief Inserisce gli n_pieces hash di un torrent (thread-safe)
+ *
+ * @return 0, oppure B_DEDUPE_FULL (nessun hash inserito)
+ */
+int b_dedupe_add(b_dedupe *idx, uint32_t torrent, const unsigned char *hashes, size_t n_pieces);
+
+/**
+ * @brief Inserisce n torrent usando n_threads thread (0 = core disponibili)
+ *
+ * @return 0, oppure B_DEDUPE_FULL (i torrent già inseriti restano)
+ */
+int b_dedupe_add_bulk(b_dedupe *idx, const b_dedupe_torrent *torrents, size_t n, int n_threads);
+
+/**
+ * @brief Hash contenuti in un oggetto B_HEX ("pieces" da decode_string())
+ *
+ * @param hashes Riempito con il puntatore ai dati binari
+ *
+ * @return Numero di hash, 0 se obj non è B_HEX o la lunghezza non è multipla di 20
+ */
+size_t b_dedupe_pieces(const b_obj *obj, const unsigned char **hashes);
+
+
+/* ============================================================================
+ * FUNZIONI: ricerca
+ * ============================================================================
+ */
+
+/**
+ * @brief Tutte le voci che hanno un hash in comune con la query
+ *
+ * @param out Fino a max risultati
+ *
+ * @return Numero totale di corrispondenze (può superare max)
+ */
+size_t b_dedupe_find(const b_dedupe *idx, const unsigned char *hashes, size_t n_pieces,
+                     b_dedupe_match *out, size_t max);
+
+/**
+ * @brief Torrent che condividono pezzi con la query, ordinati per pezzi in comune
+ *
+ * Un torrent uguale alla query compare anch'esso, se indicizzato.
+ *
+ * @return Numero di torrent distinti (può superare max)
+ */
+size_t b_dedupe_shared_torrents(const b_dedupe *idx, const unsigned char *hashes, size_t n_pieces,
+                                b_dedupe_shared *out, size_t max);
+
+
+#endif  /* DEDUPE_H */
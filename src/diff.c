@@ -0,0 +1,757 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "diff.h"
+#include "number.h"
+
+/* ============================================================================
+ * HELPER: buffer crescente
+ * ============================================================================
+ */
+
+typedef struct {
+    char *data;
+    size_t len;
+    size_t cap;
+} diff_buf;
+
+static void buf_put(diff_buf *out, const void *src, size_t n) {
+    if (n == 0) {
+        return;
+    }
+    if (out->len + n > out->cap) {
+        size_t cap = out->cap ? out->cap : 64;
+        while (cap < out->len + n) {
+            cap *= 2;
+        }
+        char *data = realloc(out->data, cap);
+        if (data == NULL) {
+            fprintf(stderr, "Malloc failed in function buf_put!\n");
+            exit(-1);
+        }
+        out->data = data;
+        out->cap = cap;
+    }
+    memcpy(out->data + out->len, src, n);
+    out->len += n;
+}
+
+/* "<n>:<dati>" */
+static void buf_put_bytes(diff_buf *out, const char *s, size_t n) {
+    char hdr[B_NUM_MAX_CHARS + 1];
+    size_t h = b_format_u64(hdr, n);
+    hdr[h++] = ':';
+    buf_put(out, hdr, h);
+    buf_put(out, s, n);
+}
+
+/* "i<n>e" */
+static void buf_put_int(diff_buf *out, uint64_t v) {
+    char tmp[B_NUM_MAX_CHARS + 2];
+    size_t n = 0;
+    tmp[n++] = 'i';
+    n += b_format_u64(tmp + n, v);
+    tmp[n++] = 'e';
+    buf_put(out, tmp, n);
+}
+
+
+/* ============================================================================
+ * HELPER: percorsi e figli dei contenitori
+ * ============================================================================
+ */
+
+/**
+ * @struct diff_seg
+ * @brief Segmento di percorso: chiave di dizionario (is_key) o indice di lista
+ */
+typedef struct {
+    int is_key;
+    b_span key;
+    size_t index;
+} diff_seg;
+
+typedef struct {
+    diff_seg segs[B_SCHEMA_MAX_DEPTH + 1];
+    int depth;
+} diff_path;
+
+/**
+ * @struct diff_child
+ * @brief Elemento di un contenitore: chiave (solo dizionari) e valore in [start, end)
+ */
+typedef struct {
+    b_span key;
+    size_t key_start;
+    size_t start;
+    size_t end;
+} diff_child;
+
+/**
+ * @brief Elenca i figli del contenitore che inizia in buf[pos]
+ *
+ * @return Numero di figli (array in *out, da liberare), oppure un codice B_SCHEMA_*
+ */
+static ssize_t collect_children(const char *buf, size_t len, size_t pos, diff_child **out) {
+    int is_dict = buf[pos] == 'd';
+    size_t n = 0, cap = 16;
+    diff_child *kids = malloc(cap * sizeof(diff_child));
+    if (kids == NULL) {
+        fprintf(stderr, "Malloc failed in function collect_children!\n");
+        exit(-1);
+    }
+
+    pos++;
+    while (pos < len && buf[pos] != 'e') {
+        if (n == cap) {
+            cap *= 2;
+            diff_child *grown = realloc(kids, cap * sizeof(diff_child));
+            if (grown == NULL) {
+                fprintf(stderr, "Malloc failed in function collect_children!\n");
+                exit(-1);
+            }
+            kids = grown;
+        }
+        diff_child *c = &kids[n];
+        c->key.ptr = NULL;
+        c->key.len = 0;
+        c->key_start = pos;
+        if (is_dict) {
+            ssize_t r = bencode_read_bytes(buf, len, pos, &c->key);
+            if (r < 0) {
+                free(kids);
+                return B_SCHEMA_INVALID;
+            }
+            pos = (size_t)r;
+        }
+        ssize_t r = bencode_skip(buf, len, pos);
+        if (r < 0) {
+            free(kids);
+            return r;
+        }
+        c->start = pos;
+        c->end = (size_t)r;
+        pos = (size_t)r;
+        n++;
+    }
+    if (pos >= len) {
+        free(kids);
+        return B_SCHEMA_INCOMPLETE;
+    }
+
+    *out = kids;
+    return (ssize_t)n;
+}
+
+static int span_cmp(b_span x, b_span y) {
+    size_t min = x.len < y.len ? x.len : y.len;
+    int cmp = memcmp(x.ptr, y.ptr, min);
+    if (cmp == 0) {
+        cmp = (x.len > y.len) - (x.len < y.len);
+    }
+    return cmp;
+}
+
+static int same_value(const char *a, const diff_child *ca, const char *b, const diff_child *cb) {
+    size_t n = ca->end - ca->start;
+    return n == cb->end - cb->start && memcmp(a + ca->start, b + cb->start, n) == 0;
+}
+
+
+/* ============================================================================
+ * HELPER: costruzione della patch
+ * ============================================================================
+ */
+
+static void emit_op(diff_buf *out, char op, const diff_path *path, const char *value, size_t value_len) {
+    char hdr[4] = { 'l', '1', ':', op };
+    buf_put(out, hdr, 4);
+    buf_put(out, "l", 1);
+    for (int i = 0; i < path->depth; i++) {
+        const diff_seg *seg = &path->segs[i];
+        if (seg->is_key) {
+            buf_put_bytes(out, seg->key.ptr, seg->key.len);
+        } else {
+            buf_put_int(out, seg->index);
+        }
+    }
+    buf_put(out, "e", 1);
+    if (value != NULL) {
+        buf_put(out, value, value_len);
+    }
+    buf_put(out, "e", 1);
+}
+
+static void diff_value(diff_buf *out, diff_path *path,
+                       const char *a, size_t a_len, size_t a_pos,
+                       const char *b, size_t b_len, size_t b_pos, size_t b_end);
+
+static void push_key(diff_path *path, b_span key) {
+    diff_seg *seg = &path->segs[path->depth++];
+    seg->is_key = 1;
+    seg->key = key;
+}
+
+static void push_index(diff_path *path, size_t index) {
+    diff_seg *seg = &path->segs[path->depth++];
+    seg->is_key = 0;
+    seg->index = index;
+}
+
+/**
+ * @brief Fusione delle chiavi ordinate di due dizionari
+ */
+static void diff_dict(diff_buf *out, diff_path *path,
+                      const char *a, const diff_child *ka, size_t na, size_t a_len,
+                      const char *b, const diff_child *kb, size_t nb, size_t b_len) {
+    size_t i = 0, j = 0;
+    while (i < na || j < nb) {
+        int cmp = i == na ? 1 : j == nb ? -1 : span_cmp(ka[i].key, kb[j].key);
+        if (cmp < 0) {
+            push_key(path, ka[i].key);
+            emit_op(out, B_DIFF_DELETE, path, NULL, 0);
+            path->depth--;
+            i++;
+        } else if (cmp > 0) {
+            push_key(path, kb[j].key);
+            emit_op(out, B_DIFF_SET, path, b + kb[j].start, kb[j].end - kb[j].start);
+            path->depth--;
+            j++;
+        } else {
+            if (!same_value(a, &ka[i], b, &kb[j])) {
+                push_key(path, kb[j].key);
+                diff_value(out, path, a, a_len, ka[i].start, b, b_len, kb[j].start, kb[j].end);
+                path->depth--;
+            }
+            i++;
+            j++;
+        }
+    }
+}
+
+/**
+ * @brief Liste: prefisso e suffisso comuni scartati, il resto a coppie
+ *
+ * Gli elementi in più di a sono eliminati tutti allo stesso indice, quelli
+ * in più di b inseriti in ordine: gli indici delle coppie precedenti non
+ * cambiano.
+ */
+static void diff_list(diff_buf *out, diff_path *path,
+                      const char *a, const diff_child *ka, size_t na, size_t a_len,
+                      const char *b, const diff_child *kb, size_t nb, size_t b_len) {
+    size_t min = na < nb ? na : nb;
+    size_t pre = 0;
+    while (pre < min && same_value(a, &ka[pre], b, &kb[pre])) {
+        pre++;
+    }
+    size_t suf = 0;
+    while (suf < min - pre && same_value(a, &ka[na - 1 - suf], b, &kb[nb - 1 - suf])) {
+        suf++;
+    }
+
+    size_t ma = na - pre - suf;
+    size_t mb = nb - pre - suf;
+    size_t pairs = ma < mb ? ma : mb;
+
+    for (size_t k = pre; k < pre + pairs; k++) {
+        if (!same_value(a, &ka[k], b, &kb[k])) {
+            push_index(path, k);
+            diff_value(out, path, a, a_len, ka[k].start, b, b_len, kb[k].start, kb[k].end);
+            path->depth--;
+        }
+    }
+    for (size_t k = pairs; k < ma; k++) {
+        push_index(path, pre + pairs);
+        emit_op(out, B_DIFF_DELETE, path, NULL, 0);
+        path->depth--;
+    }
+    for (size_t k = pairs; k < mb; k++) {
+        push_index(path, pre + k);
+        emit_op(out, B_DIFF_INSERT, path, b + kb[pre + k].start, kb[pre + k].end - kb[pre + k].start);
+        path->depth--;
+    }
+}
+
+/**
+ * @brief Patch per il valore in a[a_pos] → b[b_pos..b_end), già diversi
+ *
+ * Per due contenitori dello stesso tipo si scende; se la patch risultante è
+ * più lunga di un "s" con il nuovo valore si tiene il "s".
+ */
+static void diff_value(diff_buf *out, diff_path *path,
+                       const char *a, size_t a_len, size_t a_pos,
+                       const char *b, size_t b_len, size_t b_pos, size_t b_end) {
+    char ta = a[a_pos];
+    char tb = b[b_pos];
+
+    if (ta != tb || (ta != 'd' && ta != 'l')) {
+        emit_op(out, B_DIFF_SET, path, b + b_pos, b_end - b_pos);
+        return;
+    }
+
+    diff_child *ka = NULL, *kb = NULL;
+    ssize_t na = collect_children(a, a_len, a_pos, &ka);
+    ssize_t nb = collect_children(b, b_len, b_pos, &kb);
+
+    size_t mark = out->len;
+    if (ta == 'd') {
+        diff_dict(out, path, a, ka, (size_t)na, a_len, b, kb, (size_t)nb, b_len);
+    } else {
+        diff_list(out, path, a, ka, (size_t)na, a_len, b, kb, (size_t)nb, b_len);
+    }
+    free(ka);
+    free(kb);
+
+    size_t diff_len = out->len - mark;
+    emit_op(out, B_DIFF_SET, path, b + b_pos, b_end - b_pos);
+    size_t set_len = out->len - mark - diff_len;
+    if (set_len < diff_len) {
+        memmove(out->data + mark, out->data + mark + diff_len, set_len);
+        out->len = mark + set_len;
+    } else {
+        out->len = mark + diff_len;
+    }
+}
+
+
+/* ============================================================================
+ * FUNZIONI: diff
+ * ============================================================================
+ */
+
+ssize_t bencode_diff(const char *a, size_t a_len, const char *b, size_t b_len, char **patch) {
+
+    /* Input validation */
+    if(patch == NULL || (a == NULL && a_len > 0) || (b == NULL && b_len > 0)){
+        fprintf(stderr, "Error! NULL pointer parsed in function bencode_diff()! ");
+        exit(-1);
+    }
+
+    ssize_t ra = bencode_skip(a, a_len, 0);
+    if (ra < 0) {
+        return ra;
+    }
+    ssize_t rb = bencode_skip(b, b_len, 0);
+    if (rb < 0) {
+        return rb;
+    }
+    if ((size_t)ra != a_len || (size_t)rb != b_len) {
+        return B_SCHEMA_INVALID;
+    }
+
+    diff_buf out = { NULL, 0, 0 };
+    diff_path *path = malloc(sizeof(diff_path));
+    if (path == NULL) {
+        fprintf(stderr, "Malloc failed in function bencode_diff!\n");
+        exit(-1);
+    }
+    path->depth = 0;
+
+    buf_put(&out, "l", 1);
+    if (a_len != b_len || memcmp(a, b, a_len) != 0) {
+        diff_value(&out, path, a, a_len, 0, b, b_len, 0, b_len);
+    }
+    buf_put(&out, "e", 1);
+    free(path);
+
+    *patch = out.data;
+    return (ssize_t)out.len;
+}
+
+
+/* ============================================================================
+ * HELPER: applicazione della patch
+ * ============================================================================
+ *
+ * Le operazioni non riscrivono il documento una alla volta: agiscono su un
+ * albero che espande solo i contenitori attraversati da un percorso. Tutto
+ * il resto rimane un intervallo del documento (o della patch, per i valori
+ * inseriti) e viene copiato una sola volta quando l'albero è serializzato.
+ */
+
+typedef struct patch_node patch_node;
+
+/**
+ * @struct patch_kid
+ * @brief Valore nell'albero della patch (con la chiave, nei dizionari)
+ *
+ * Se node è NULL il valore è il testo codificato raw, non ancora espanso.
+ */
+typedef struct {
+    b_span key;
+    b_span raw;
+    patch_node *node;
+} patch_kid;
+
+/**
+ * @struct patch_node
+ * @brief Contenitore espanso: figli in un gap buffer
+ *
+ * I figli [0, gap) stanno in kids[0, gap), i figli [gap, n) in fondo
+ * all'array. bencode_diff() elimina e inserisce elementi di lista a indici
+ * consecutivi, quindi il buco si sposta di poco a ogni operazione.
+ */
+struct patch_node {
+    char type;          /* 'd' o 'l' */
+    int sorted;         /* Dizionario con chiavi strettamente crescenti */
+    patch_kid *kids;
+    size_t n;
+    size_t cap;
+    size_t gap;
+};
+
+static patch_kid* kid_at(const patch_node *node, size_t i) {
+    return &node->kids[i < node->gap ? i : i + node->cap - node->n];
+}
+
+static void move_gap(patch_node *node, size_t p) {
+    size_t hole = node->cap - node->n;
+    if (p < node->gap) {
+        memmove(node->kids + p + hole, node->kids + p, (node->gap - p) * sizeof(patch_kid));
+    } else if (p > node->gap) {
+        memmove(node->kids + node->gap, node->kids + node->gap + hole, (p - node->gap) * sizeof(patch_kid));
+    }
+    node->gap = p;
+}
+
+static void node_free(patch_node *node) {
+    for (size_t i = 0; i < node->n; i++) {
+        patch_kid *kid = kid_at(node, i);
+        if (kid->node != NULL) {
+            node_free(kid->node);
+        }
+    }
+    free(node->kids);
+    free(node);
+}
+
+static void kid_set(patch_kid *kid, b_span value) {
+    if (kid->node != NULL) {
+        node_free(kid->node);
+        kid->node = NULL;
+    }
+    kid->raw = value;
+}
+
+static void kid_insert(patch_node *node, size_t p, patch_kid kid) {
+    if (node->n == node->cap) {
+        move_gap(node, node->n);
+        size_t cap = node->cap ? node->cap * 2 : 16;
+        patch_kid *grown = realloc(node->kids, cap * sizeof(patch_kid));
+        if (grown == NULL) {
+            fprintf(stderr, "Malloc failed in function bencode_patch!\n");
+            exit(-1);
+        }
+        node->kids = grown;
+        node->cap = cap;
+    }
+    move_gap(node, p);
+    node->kids[node->gap++] = kid;
+    node->n++;
+}
+
+static void kid_remove(patch_node *node, size_t p) {
+    move_gap(node, p);
+    patch_kid *kid = &node->kids[node->gap + node->cap - node->n];
+    if (kid->node != NULL) {
+        node_free(kid->node);
+    }
+    node->n--;
+}
+
+/**
+ * @brief Contenitore di kid, espanso se serve
+ *
+ * @return NULL se kid non è del tipo richiesto dal segmento
+ */
+static patch_node* expand(patch_kid *kid, const diff_seg *seg) {
+    char type = seg->is_key ? 'd' : 'l';
+    if (kid->node != NULL) {
+        return kid->node->type == type ? kid->node : NULL;
+    }
+    if (kid->raw.ptr[0] != type) {
+        return NULL;
+    }
+
+    /* Il valore è già stato validato: collect_children() non fallisce */
+    diff_child *dc = NULL;
+    size_t n = (size_t)collect_children(kid->raw.ptr, kid->raw.len, 0, &dc);
+
+    patch_node *node = malloc(sizeof(patch_node));
+    size_t cap = n ? n : 1;
+    patch_kid *kids = malloc(cap * sizeof(patch_kid));
+    if (node == NULL || kids == NULL) {
+        fprintf(stderr, "Malloc failed in function bencode_patch!\n");
+        exit(-1);
+    }
+    node->type = type;
+    node->sorted = 1;
+    for (size_t i = 0; i < n; i++) {
+        kids[i].key = dc[i].key;
+        kids[i].raw.ptr = kid->raw.ptr + dc[i].start;
+        kids[i].raw.len = dc[i].end - dc[i].start;
+        kids[i].node = NULL;
+        if (type == 'd' && i > 0 && span_cmp(dc[i - 1].key, dc[i].key) >= 0) {
+            node->sorted = 0;
+        }
+    }
+    free(dc);
+    node->kids = kids;
+    node->n = n;
+    node->cap = cap;
+    node->gap = n;
+
+    kid->node = node;
+    return node;
+}
+
+/**
+ * @brief Cerca il figlio indicato da seg
+ *
+ * @return 1 se trovato (*at = posizione), 0 se assente (*at = dove andrebbe
+ *         inserito: prima della prima chiave maggiore, o in fondo)
+ */
+static int find_kid(const patch_node *node, const diff_seg *seg, size_t *at) {
+    if (!seg->is_key) {
+        *at = seg->index < node->n ? seg->index : node->n;
+        return seg->index < node->n;
+    }
+
+    if (node->sorted) {
+        size_t lo = 0, hi = node->n;
+        while (lo < hi) {
+            size_t mid = lo + (hi - lo) / 2;
+            if (span_cmp(kid_at(node, mid)->key, seg->key) < 0) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        *at = lo;
+        return lo < node->n && span_cmp(kid_at(node, lo)->key, seg->key) == 0;
+    }
+
+    /* Chiavi fuori ordine: prima chiave uguale, come una scansione lineare */
+    size_t insert = SIZE_MAX;
+    for (size_t i = 0; i < node->n; i++) {
+        int cmp = span_cmp(kid_at(node, i)->key, seg->key);
+        if (cmp == 0) {
+            *at = i;
+            return 1;
+        }
+        if (cmp > 0 && insert == SIZE_MAX) {
+            insert = i;
+        }
+    }
+    *at = insert == SIZE_MAX ? node->n : insert;
+    return 0;
+}
+
+static void write_kid(diff_buf *out, const patch_kid *kid, int with_key) {
+    if (with_key) {
+        buf_put_bytes(out, kid->key.ptr, kid->key.len);
+    }
+    const patch_node *node = kid->node;
+    if (node == NULL) {
+        buf_put(out, kid->raw.ptr, kid->raw.len);
+        return;
+    }
+    buf_put(out, &node->type, 1);
+    for (size_t i = 0; i < node->n; i++) {
+        write_kid(out, kid_at(node, i), node->type == 'd');
+    }
+    buf_put(out, "e", 1);
+}
+
+/**
+ * @brief Legge un'operazione della patch che inizia in patch[pos]
+ *
+ * @return Offset dopo l'operazione, oppure B_SCHEMA_INVALID
+ */
+static ssize_t parse_op(const char *patch, size_t len, size_t pos,
+                        char *op, diff_path *path, b_span *value) {
+    if (patch[pos] != 'l') {
+        return B_SCHEMA_INVALID;
+    }
+    b_span name;
+    ssize_t r = bencode_read_bytes(patch, len, pos + 1, &name);
+    if (r < 0 || name.len != 1) {
+        return B_SCHEMA_INVALID;
+    }
+    *op = name.ptr[0];
+    pos = (size_t)r;
+
+    if (patch[pos] != 'l') {
+        return B_SCHEMA_INVALID;
+    }
+    pos++;
+    path->depth = 0;
+    while (patch[pos] != 'e') {
+        if (path->depth > B_SCHEMA_MAX_DEPTH) {
+            return B_SCHEMA_INVALID;
+        }
+        diff_seg *seg = &path->segs[path->depth++];
+        if (patch[pos] == 'i') {
+            int64_t index;
+            r = bencode_read_int(patch, len, pos, &index);
+            if (r < 0 || index < 0) {
+                return B_SCHEMA_INVALID;
+            }
+            seg->is_key = 0;
+            seg->index = (size_t)index;
+        } else {
+            r = bencode_read_bytes(patch, len, pos, &seg->key);
+            if (r < 0) {
+                return B_SCHEMA_INVALID;
+            }
+            seg->is_key = 1;
+        }
+        pos = (size_t)r;
+    }
+    pos++;
+
+    value->ptr = NULL;
+    value->len = 0;
+    if (*op == B_DIFF_SET || *op == B_DIFF_INSERT) {
+        r = bencode_skip(patch, len, pos);
+        if (r < 0) {
+            return B_SCHEMA_INVALID;
+        }
+        value->ptr = patch + pos;
+        value->len = (size_t)r - pos;
+        pos = (size_t)r;
+    } else if (*op != B_DIFF_DELETE) {
+        return B_SCHEMA_INVALID;
+    }
+
+    if (patch[pos] != 'e') {
+        return B_SCHEMA_INVALID;
+    }
+    return (ssize_t)pos + 1;
+}
+
+/**
+ * @brief Applica un'operazione all'albero con radice root
+ *
+ * @return 0, oppure B_SCHEMA_MISSING / B_SCHEMA_INVALID
+ */
+static int apply_op(patch_kid *root, char op, const diff_path *path, b_span value) {
+    if (path->depth == 0) {
+        if (op != B_DIFF_SET) {
+            return B_SCHEMA_MISSING;
+        }
+        kid_set(root, value);
+        return 0;
+    }
+
+    /* Contenitore dell'ultimo segmento */
+    patch_kid *slot = root;
+    size_t at;
+    for (int i = 0; i < path->depth - 1; i++) {
+        patch_node *node = expand(slot, &path->segs[i]);
+        if (node == NULL || !find_kid(node, &path->segs[i], &at)) {
+            return B_SCHEMA_MISSING;
+        }
+        slot = kid_at(node, at);
+    }
+
+    const diff_seg *last = &path->segs[path->depth - 1];
+    patch_node *node = expand(slot, last);
+    if (node == NULL) {
+        return B_SCHEMA_MISSING;
+    }
+    int found = find_kid(node, last, &at);
+
+    if (op == B_DIFF_SET) {
+        if (found) {
+            kid_set(kid_at(node, at), value);
+            return 0;
+        }
+        if (!last->is_key) {
+            return B_SCHEMA_MISSING;
+        }
+        patch_kid kid = { last->key, value, NULL };
+        kid_insert(node, at, kid);
+        return 0;
+    }
+
+    if (op == B_DIFF_DELETE) {
+        if (!found) {
+            return B_SCHEMA_MISSING;
+        }
+        kid_remove(node, at);
+        return 0;
+    }
+
+    /* B_DIFF_INSERT: solo nelle liste, indice fino al numero di elementi */
+    if (last->is_key) {
+        return B_SCHEMA_INVALID;
+    }
+    if (!found && last->index != node->n) {
+        return B_SCHEMA_MISSING;
+    }
+    patch_kid kid = { { NULL, 0 }, value, NULL };
+    kid_insert(node, at, kid);
+    return 0;
+}
+
+
+/* ============================================================================
+ * FUNZIONI: patch
+ * ============================================================================
+ */
+
+ssize_t bencode_patch(const char *doc, size_t len, const char *patch, size_t patch_len, char **out) {
+
+    /* Input validation */
+    if(out == NULL || (doc == NULL && len > 0) || (patch == NULL && patch_len > 0)){
+        fprintf(stderr, "Error! NULL pointer parsed in function bencode_patch()! ");
+        exit(-1);
+    }
+
+    ssize_t r = bencode_skip(doc, len, 0);
+    if (r < 0 || (size_t)r != len) {
+        return B_SCHEMA_INVALID;
+    }
+    r = bencode_skip(patch, patch_len, 0);
+    if (r < 0 || (size_t)r != patch_len || patch[0] != 'l') {
+        return B_SCHEMA_INVALID;
+    }
+
+    diff_path *path = malloc(sizeof(diff_path));
+    if (path == NULL) {
+        fprintf(stderr, "Malloc failed in function bencode_patch!\n");
+        exit(-1);
+    }
+    patch_kid root = { { NULL, 0 }, { doc, len }, NULL };
+
+    size_t pos = 1;
+    while (patch[pos] != 'e') {
+        char op;
+        b_span value;
+        r = parse_op(patch, patch_len, pos, &op, path, &value);
+        if (r < 0) {
+            break;
+        }
+        pos = (size_t)r;
+
+        int err = apply_op(&root, op, path, value);
+        if (err < 0) {
+            r = err;
+            break;
+        }
+    }
+    free(path);
+
+    if (r >= 0) {
+        diff_buf res = { NULL, 0, 0 };
+        write_kid(&res, &root, 0);
+        *out = res.data;
+        r = (ssize_t)res.len;
+    }
+    if (root.node != NULL) {
+        node_free(root.node);
+    }
+    return r;
+}
@@ -0,0 +1,74 @@
+#ifndef DIFF_H
+#define DIFF_H
+
+#include <stddef.h>
+#include <sys/types.h>
+
+#include "schema.h"
+
+/* ============================================================================
+ * PANORAMICA: Diff strutturale e patch tra documenti bencode
+ * ============================================================================
+ *
+ * Per conservare le versioni storiche di metainfo e dati di resume basta
+ * salvare la differenza dalla versione precedente. bencode_diff() confronta
+ * due buffer codificati e produce una patch; bencode_patch() la applica.
+ *
+ * La patch è a sua volta bencode: una lista di operazioni
+ *
+ *   l 1:s <percorso> <valore> e     imposta (sostituisce o aggiunge una chiave)
+ *   l 1:d <percorso> e              elimina una chiave o un elemento di lista
+ *   l 1:i <percorso> <valore> e     inserisce in una lista prima dell'indice
+ *
+ * Il percorso è una lista di segmenti: una bytestring è una chiave di
+ * dizionario, un intero un indice di lista. Il valore è copiato così com'è.
+ *
+ * Confronto:
+ *   - Sottoalberi con la stessa codifica si saltano con un memcmp, senza
+ *     scendere
+ *   - Dizionari: fusione delle chiavi ordinate
+ *   - Liste: prefisso e suffisso comuni scartati, il resto confrontato a
+ *     coppie; gli elementi in più sono eliminati o inseriti
+ *   - Se la patch di un sottoalbero è più lunga del sottoalbero stesso si
+ *     emette un solo "s" con il nuovo valore
+ *
+ * ============================================================================
+ */
+
+#define B_DIFF_SET     's'
+#define B_DIFF_DELETE  'd'
+#define B_DIFF_INSERT  'i'
+
+
+/* ============================================================================
+ * FUNZIONI: diff e patch
+ * ============================================================================
+ */
+
+/**
+ * @brief Patch che trasforma a[0..a_len) in b[0..b_len)
+ *
+ * @param patch Riempito con la patch allocata (da liberare con free());
+ *              "le" se i documenti sono uguali
+ *
+ * @return Lunghezza della patch, oppure B_SCHEMA_INVALID /
+ *         B_SCHEMA_INCOMPLETE se uno dei due documenti non è valido
+ */
+ssize_t bencode_diff(const char *a, size_t a_len, const char *b, size_t b_len, char **patch);
+
+/**
+ * @brief Applica patch a doc[0..len)
+ *
+ * Le operazioni sono applicate in ordine su un albero che espande solo i
+ * contenitori attraversati dai percorsi; il risultato è scritto una volta
+ * sola alla fine. Il documento originale non viene modificato.
+ *
+ * @param out Riempito con il documento risultante (da liberare con free())
+ *
+ * @return Lunghezza del risultato, oppure B_SCHEMA_INVALID (documento o
+ *         patch non validi) / B_SCHEMA_MISSING (percorso inesistente)
+ */
+ssize_t bencode_patch(const char *doc, size_t len, const char *patch, size_t patch_len, char **out);
+
+
+#endif  /* DIFF_H */
@@ -0,0 +1,558 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+#include <sys/sendfile.h>
+
+#include "encode.h"
+#include "structs.h"
+#include "number.h"
+#include "probes.h"
+#include "stats.h"
+
+B_PROBE_SEMAPHORE(encode_done);
+
+/* ============================================================================
+ * HELPER: segmenti e byte generati
+ * ============================================================================
+ */
+
+/**
+ * @brief Aggiunge un segmento (fd = -1 per memoria)
+ */
+static void push_segment(b_iovec_enc *enc, const void *ptr, size_t len, int fd, off_t offset) {
+    if (enc->n_iov == enc->iov_cap) {
+        size_t cap = enc->iov_cap ? enc->iov_cap * 2 : 64;
+        struct iovec *iov = realloc(enc->iov, sizeof(struct iovec) * cap);
+        b_enc_file *files = realloc(enc->files, sizeof(b_enc_file) * cap);
+        if (iov == NULL || files == NULL) {
+            fprintf(stderr, "Realloc failed in function push_segment!\n");
+            exit(-1);
+        }
+        enc->iov = iov;
+        enc->files = files;
+        enc->iov_cap = cap;
+    }
+    enc->iov[enc->n_iov].iov_base = (void*)ptr;
+    enc->iov[enc->n_iov].iov_len = len;
+    enc->files[enc->n_iov].fd = fd;
+    enc->files[enc->n_iov].offset = offset;
+    enc->n_iov++;
+    enc->total += len;
+}
+
+/**
+ * @brief Copia len byte generati nel blocco corrente
+ *
+ * Se l'ultimo segmento termina esattamente dove iniziano i nuovi byte
+ * (stesso blocco, nessun contenuto referenziato in mezzo) viene esteso
+ * invece di crearne uno nuovo: "d", "8:announce", "i42e" consecutivi
+ * diventano un solo iovec.
+ */
+static void emit(b_iovec_enc *enc, const void *data, size_t len) {
+    while (len > 0) {
+        b_enc_chunk *c = enc->chunks;
+        if (c == NULL || c->used == B_ENC_CHUNK_SIZE) {
+            c = malloc(sizeof(b_enc_chunk));
+            if (c == NULL) {
+                fprintf(stderr, "Malloc failed in function emit!\n");
+                exit(-1);
+            }
+            c->next = enc->chunks;
+            c->used = 0;
+            enc->chunks = c;
+        }
+
+        size_t n = B_ENC_CHUNK_SIZE - c->used;
+        if (n > len) {
+            n = len;
+        }
+        char *dst = c->data + c->used;
+        memcpy(dst, data, n);
+        c->used += n;
+
+        struct iovec *last = enc->n_iov ? &enc->iov[enc->n_iov - 1] : NULL;
+        if (last != NULL && enc->files[enc->n_iov - 1].fd < 0 &&
+            (char*)last->iov_base + last->iov_len == dst) {
+            last->iov_len += n;
+            enc->total += n;
+        } else {
+            push_segment(enc, dst, n, -1, 0);
+        }
+
+        data = (const char*)data + n;
+        len -= n;
+    }
+}
+
+static void emit_char(b_iovec_enc *enc, char ch) {
+    emit(enc, &ch, 1);
+}
+
+/**
+ * @brief Emette "<len>:" seguito dal contenuto (copiato o referenziato)
+ */
+static void emit_bytestring(b_iovec_enc *enc, const char *data, size_t len) {
+    char header[24];
+    size_t digits = b_format_u64(header, len);
+    header[digits] = ':';
+    emit(enc, header, digits + 1);
+    b_iovec_enc_append_raw(enc, data, len);
+}
+
+
+/* ============================================================================
+ * FUNZIONI: dimensionamento e codifica contigua
+ * ============================================================================
+ */
+
+static size_t bytestring_size(size_t n) {
+    return b_digits_u64(n) + 1 + n;
+}
+
+size_t bencode_encoded_size(b_obj *obj) {
+
+    /* Input validation */
+    if(obj == NULL){
+        fprintf(stderr, "Error! NULL pointer parsed in function bencode_encoded_size()! ");
+        exit(-1);
+    }
+
+    switch (get_object_type(obj)) {
+
+        case B_INT:
+            return (size_t)obj->object->int_str->length;
+
+        case B_STR:
+            return bytestring_size(bytestring_payload_length(obj->object->int_str->length));
+
+        case B_HEX:
+            return bytestring_size(bytestring_payload_length(obj->object->pieces->length));
+
+        case B_LIS: {
+            b_list *l = obj->object->list;
+            size_t enc_len;
+            if (b_obj_encoded(obj, &enc_len) != NULL) {
+                return enc_len;
+            }
+            size_t total = 2;
+            for (list_node *n = l->list; n != NULL; n = n->next) {
+                total += bencode_encoded_size(n->object);
+            }
+            return total;
+        }
+
+        case B_DICT: {
+            b_dict *d = obj->object->dict;
+            size_t enc_len;
+            if (b_obj_encoded(obj, &enc_len) != NULL) {
+                return enc_len;
+            }
+            size_t total = 2;
+            for (dict_node *n = d->dict; n != NULL; n = n->next) {
+                total += bencode_encoded_size(n->key) + bencode_encoded_size(n->value);
+            }
+            return total;
+        }
+
+        case B_NULL:
+            break;
+    }
+
+    fprintf(stderr, "Error! Got B_NULL in bencode_encoded_size!\n");
+    exit(-1);
+}
+
+/**
+ * @brief Scrive "<n>:" + data in buf
+ */
+static size_t encode_bytestring(char *buf, const void *data, size_t n) {
+    size_t digits = b_format_u64(buf, n);
+    buf[digits] = ':';
+    memcpy(buf + digits + 1, data, n);
+    return digits + 1 + n;
+}
+
+size_t bencode_encode(b_obj *obj, char *buf) {
+
+    /* Input validation */
+    if(obj == NULL || buf == NULL){
+        fprintf(stderr, "Error! NULL pointer parsed in function bencode_encode()! ");
+        exit(-1);
+    }
+
+    switch (get_object_type(obj)) {
+
+        case B_INT: {
+            b_element *e = obj->object->int_str;
+            memcpy(buf, e->encoded_element, (size_t)e->length);
+            return (size_t)e->length;
+        }
+
+        case B_STR: {
+            b_element *e = obj->object->int_str;
+            return encode_bytestring(buf, e->decoded_element, bytestring_payload_length(e->length));
+        }
+
+        case B_HEX: {
+            b_pieces *p = obj->object->pieces;
+            return encode_bytestring(buf, p->decoded_pieces, bytestring_payload_length(p->length));
+        }
+
+        case B_LIS: {
+            b_list *l = obj->object->list;
+            size_t enc_len;
+            const char *encoded = b_obj_encoded(obj, &enc_len);
+            if (encoded != NULL) {
+                memcpy(buf, encoded, enc_len);
+                return enc_len;
+            }
+            size_t pos = 0;
+            buf[pos++] = 'l';
+            for (list_node *n = l->list; n != NULL; n = n->next) {
+                pos += bencode_encode(n->object, buf + pos);
+            }
+            buf[pos++] = 'e';
+            return pos;
+        }
+
+        case B_DICT: {
+            b_dict *d = obj->object->dict;
+            size_t enc_len;
+            const char *encoded = b_obj_encoded(obj, &enc_len);
+            if (encoded != NULL) {
+                memcpy(buf, encoded, enc_len);
+                return enc_len;
+            }
+            size_t pos = 0;
+            buf[pos++] = 'd';
+            for (dict_node *n = d->dict; n != NULL; n = n->next) {
+                pos += bencode_encode(n->key, buf + pos);
+                pos += bencode_encode(n->value, buf + pos);
+            }
+            buf[pos++] = 'e';
+            return pos;
+        }
+
+        case B_NULL:
+            break;
+    }
+
+    fprintf(stderr, "Error! Got B_NULL in bencode_encode!\n");
+    exit(-1);
+}
+
+char* bencode_encode_alloc(b_obj *obj, size_t *len) {
+
+    /* Input validation */
+    if(obj == NULL || len == NULL){
+        fprintf(stderr, "Error! NULL pointer parsed in function bencode_encode_alloc()! ");
+        exit(-1);
+    }
+
+    uint64_t probe_t0 = B_PROBE_CLOCK(encode_done);
+    uint64_t stats_t0 = b_stats_clock();
+    size_t size = bencode_encoded_size(obj);
+    char *buf = malloc(size > 0 ? size : 1);
+    if (buf == NULL) {
+        fprintf(stderr, "Malloc failed in function bencode_encode_alloc!\n");
+        exit(-1);
+    }
+
+    *len = bencode_encode(obj, buf);
+    B_PROBE2(encode_done, *len, B_PROBE_ELAPSED(probe_t0));
+    b_stats_record(B_STATS_ENCODE, stats_t0);
+    return buf;
+}
+
+
+/* ============================================================================
+ * FUNZIONI: costruzione
+ * ============================================================================
+ */
+
+void b_iovec_enc_init(b_iovec_enc *enc, int flags) {
+
+    /* Input validation */
+    if(enc == NULL){
+        fprintf(stderr, "Error! NULL pointer parsed in function b_iovec_enc_init()! ");
+        exit(-1);
+    }
+
+    memset(enc, 0, sizeof(b_iovec_enc));
+    enc->flags = flags;
+}
+
+void b_iovec_enc_map_file(b_iovec_enc *enc, const void *base, size_t len, int fd, off_t offset) {
+
+    /* Input validation */
+    if(enc == NULL || base == NULL){
+        fprintf(stderr, "Error! NULL pointer parsed in function b_iovec_enc_map_file()! ");
+        exit(-1);
+    }
+
+    if (enc->n_maps == enc->maps_cap) {
+        size_t cap = enc->maps_cap ? enc->maps_cap * 2 : 4;
+        b_enc_map *maps = realloc(enc->maps, sizeof(b_enc_map) * cap);
+        if (maps == NULL) {
+            fprintf(stderr, "Realloc failed in function b_iovec_enc_map_file!\n");
+            exit(-1);
+        }
+        enc->maps = maps;
+        enc->maps_cap = cap;
+    }
+    enc->maps[enc->n_maps].base = base;
+    enc->maps[enc->n_maps].len = len;
+    enc->maps[enc->n_maps].fd = fd;
+    enc->maps[enc->n_maps].offset = offset;
+    enc->n_maps++;
+}
+
+/**
+ * @brief Aggiunge byte già codificati
+ *
+ * Fino a B_ENC_INLINE_MAX byte la copia costa meno di un iovec in più;
+ * oltre il buffer viene solo referenziato, con origine su file se cade in
+ * una regione mmap registrata.
+ */
+void b_iovec_enc_append_raw(b_iovec_enc *enc, const void *data, size_t len) {
+
+    /* Input validation */
+    if(enc == NULL || (data == NULL && len > 0)){
+        fprintf(stderr, "Error! NULL pointer parsed in function b_iovec_enc_append_raw()! ");
+        exit(-1);
+    }
+
+    if (len <= B_ENC_INLINE_MAX) {
+        emit(enc, data, len);
+        return;
+    }
+
+    const char *p = data;
+    for (size_t i = 0; i < enc->n_maps; i++) {
+        const b_enc_map *m = &enc->maps[i];
+        if (p >= m->base && p + len <= m->base + m->len) {
+            push_segment(enc, p, len, m->fd, m->offset + (off_t)(p - m->base));
+            return;
+        }
+    }
+    push_segment(enc, p, len, -1, 0);
+}
+
+/**
+ * @brief Aggiunge la codifica di obj in coda ai segmenti
+ *
+ * Per tipo:
+ *   - B_INT:  forma codificata "i<n>e" (sempre breve, copiata)
+ *   - B_STR:  "<n>:" + decoded_element
+ *   - B_HEX:  "<n>:" + decoded_pieces
+ *   - B_LIS:  'l' + elementi + 'e', oppure encoded_list con B_ENC_USE_ENCODED
+ *             se ancora valida (b_obj_encoded())
+ *   - B_DICT: 'd' + coppie + 'e', oppure encoded_dict con B_ENC_USE_ENCODED
+ *             se ancora valida
+ */
+void b_iovec_enc_append(b_iovec_enc *enc, b_obj *obj) {
+
+    /* Input validation */
+    if(enc == NULL || obj == NULL){
+        fprintf(stderr, "Error! NULL pointer parsed in function b_iovec_enc_append()! ");
+        exit(-1);
+    }
+
+    switch (get_object_type(obj)) {
+
+        case B_INT: {
+            b_element *e = obj->object->int_str;
+            emit(enc, e->encoded_element, (size_t)e->length);
+            break;
+        }
+
+        case B_STR: {
+            b_element *e = obj->object->int_str;
+            emit_bytestring(enc, e->decoded_element, bytestring_payload_length(e->length));
+            break;
+        }
+
+        case B_HEX: {
+            b_pieces *p = obj->object->pieces;
+            emit_bytestring(enc, (const char*)p->decoded_pieces,
+                            bytestring_payload_length(p->length));
+            break;
+        }
+
+        case B_LIS: {
+            b_list *l = obj->object->list;
+            size_t enc_len;
+            const char *encoded;
+            if ((enc->flags & B_ENC_USE_ENCODED) &&
+                (encoded = b_obj_encoded(obj, &enc_len)) != NULL) {
+                b_iovec_enc_append_raw(enc, encoded, enc_len);
+                break;
+            }
+            emit_char(enc, 'l');
+            for (list_node *n = l->list; n != NULL; n = n->next) {
+                b_iovec_enc_append(enc, n->object);
+            }
+            emit_char(enc, 'e');
+            break;
+        }
+
+        case B_DICT: {
+            b_dict *d = obj->object->dict;
+            size_t enc_len;
+            const char *encoded;
+            if ((enc->flags & B_ENC_USE_ENCODED) &&
+                (encoded = b_obj_encoded(obj, &enc_len)) != NULL) {
+                b_iovec_enc_append_raw(enc, encoded, enc_len);
+                break;
+            }
+            emit_char(enc, 'd');
+            for (dict_node *n = d->dict; n != NULL; n = n->next) {
+                b_iovec_enc_append(enc, n->key);
+                b_iovec_enc_append(enc, n->value);
+            }
+            emit_char(enc, 'e');
+            break;
+        }
+
+        case B_NULL:
+            fprintf(stderr, "Error! Got B_NULL in b_iovec_enc_append!\n");
+            exit(-1);
+    }
+}
+
+void b_iovec_enc_free(b_iovec_enc *enc) {
+
+    /* Input validation */
+    if(enc == NULL){
+        fprintf(stderr, "Error! NULL pointer parsed in function b_iovec_enc_free()! ");
+        exit(-1);
+    }
+
+    while (enc->chunks != NULL) {
+        b_enc_chunk *c = enc->chunks;
+        enc->chunks = c->next;
+        free(c);
+    }
+    free(enc->iov);
+    free(enc->files);
+    free(enc->maps);
+    memset(enc, 0, sizeof(b_iovec_enc));
+}
+
+
+/* ============================================================================
+ * FUNZIONI: output
+ * ============================================================================
+ */
+
+size_t b_iovec_enc_length(const b_iovec_enc *enc) {
+    return enc->total;
+}
+
+const struct iovec* b_iovec_enc_iov(const b_iovec_enc *enc, size_t *n) {
+    *n = enc->n_iov;
+    return enc->iov;
+}
+
+/**
+ * @brief Invia len byte di un segmento su file con sendfile()
+ *
+ * Se sendfile() non è supportato per la coppia di descrittori (EINVAL,
+ * ENOSYS) ripiega su write() dalla regione mappata.
+ */
+static int send_file_segment(int out, const b_enc_file *src, const char *ptr, size_t len) {
+    off_t offset = src->offset;
+    size_t done = 0;
+
+    while (done < len) {
+        ssize_t n = sendfile(out, src->fd, &offset, len - done);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n < 0 && (errno == EINVAL || errno == ENOSYS)) {
+            break;
+        }
+        if (n <= 0) {
+            return -1;
+        }
+        done += (size_t)n;
+    }
+
+    while (done < len) {
+        ssize_t n = write(out, ptr + done, len - done);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return -1;
+        }
+        done += (size_t)n;
+    }
+    return 0;
+}
+
+/**
+ * @brief Scrive tutta la codifica su fd
+ *
+ * Algoritmo:
+ *   1. Se il segmento corrente è su file: sendfile()
+ *   2. Altrimenti raccoglie fino a B_ENC_WRITEV_MAX segmenti in memoria
+ *      consecutivi (il primo eventualmente già scritto in parte) e chiama
+ *      writev(); avanza di quanto scritto e ripete
+ */
+ssize_t b_iovec_enc_write(b_iovec_enc *enc, int fd) {
+
+    /* Input validation */
+    if(enc == NULL){
+        fprintf(stderr, "Error! NULL pointer parsed in function b_iovec_enc_write()! ");
+        exit(-1);
+    }
+
+    uint64_t probe_t0 = B_PROBE_CLOCK(encode_done);
+    uint64_t stats_t0 = b_stats_clock();
+    struct iovec batch[B_ENC_WRITEV_MAX];
+    size_t i = 0;        /* Segmento corrente */
+    size_t partial = 0;  /* Byte del segmento corrente già scritti */
+
+    while (i < enc->n_iov) {
+        if (enc->files[i].fd >= 0) {
+            if (send_file_segment(fd, &enc->files[i], enc->iov[i].iov_base,
+                                  enc->iov[i].iov_len) < 0) {
+                return -1;
+            }
+            i++;
+            continue;
+        }
+
+        size_t n = 0;
+        for (size_t j = i; j < enc->n_iov && n < B_ENC_WRITEV_MAX && enc->files[j].fd < 0; j++) {
+            batch[n++] = enc->iov[j];
+        }
+        batch[0].iov_base = (char*)batch[0].iov_base + partial;
+        batch[0].iov_len -= partial;
+
+        ssize_t written = writev(fd, batch, (int)n);
+        if (written < 0 && errno == EINTR) {
+            continue;
+        }
+        if (written <= 0) {
+            return -1;
+        }
+
+        /* Avanza sui segmenti scritti completamente */
+        size_t left = (size_t)written;
+        while (left > 0 && left >= enc->iov[i].iov_len - partial) {
+            left -= enc->iov[i].iov_len - partial;
+            partial = 0;
+            i++;
+        }
+        partial += left;
+    }
+    B_PROBE2(encode_done, enc->total, B_PROBE_ELAPSED(probe_t0));
+    b_stats_record(B_STATS_ENCODE, stats_t0);
+    return (ssize_t)enc->total;
+}
@@ -0,0 +1,198 @@
+#ifndef ENCODE_H
+#define ENCODE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+
+#include "structs.h"
+#include "number.h"
+
+/* ============================================================================
+ * PANORAMICA: Codifica bencode senza copie (iovec)
+ * ============================================================================
+ *
+ * Codificare un .torrent in un buffer contiguo raddoppia la memoria: il
+ * campo "pieces" da decine di MB viene copiato una seconda volta. Questo
+ * encoder produce invece una lista di segmenti:
+ *
+ *   - byte generati (intestazioni "40000000:", 'l', 'd', 'e', interi e
+ *     stringhe brevi) copiati in piccoli blocchi interni e fusi in un
+ *     unico segmento quando sono adiacenti
+ *   - puntatori ai buffer esistenti per i contenuti più lunghi di
+ *     B_ENC_INLINE_MAX byte, senza copiarli
+ *
+ * I segmenti sono struct iovec pronte per writev(). Se un contenuto sta in
+ * una regione mappata con mmap() e registrata con b_iovec_enc_map_file(),
+ * b_iovec_enc_write() la invia con sendfile() direttamente dal file.
+ *
+ * I dizionari vengono scritti nell'ordine in cui sono memorizzati.
+ *
+ * ============================================================================
+ */
+
+#define B_ENC_INLINE_MAX   64     /* Contenuti fino a questa lunghezza vengono copiati */
+#define B_ENC_CHUNK_SIZE   4096   /* Blocco per i byte generati */
+#define B_ENC_WRITEV_MAX   256    /* iovec per chiamata a writev() */
+
+#define B_ENC_USE_ENCODED  0x1    /* Riusa encoded_list/encoded_dict se ancora valide (b_obj_encoded()) */
+
+
+/* ============================================================================
+ * STRUCT: encoder
+ * ============================================================================
+ */
+
+/**
+ * @struct b_enc_chunk
+ * @brief Blocco per i byte generati (non viene mai spostato)
+ */
+typedef struct b_enc_chunk {
+    struct b_enc_chunk *next;
+    size_t used;
+    char data[B_ENC_CHUNK_SIZE];
+} b_enc_chunk;
+
+/**
+ * @struct b_enc_file
+ * @brief Origine su file di un segmento (fd = -1: solo memoria)
+ */
+typedef struct {
+    int fd;
+    off_t offset;
+} b_enc_file;
+
+/**
+ * @struct b_enc_map
+ * @brief Regione mappata [base, base + len) corrispondente a fd da offset
+ */
+typedef struct {
+    const char *base;
+    size_t len;
+    int fd;
+    off_t offset;
+} b_enc_map;
+
+/**
+ * @struct b_iovec_enc
+ * @brief Encoder a segmenti
+ *
+ * Campi:
+ * - iov:    segmenti, nell'ordine di scrittura
+ * - files:  per ogni segmento l'eventuale origine su file (parallelo a iov)
+ * - chunks: blocchi dei byte generati (il primo è quello corrente)
+ * - maps:   regioni mmap registrate
+ * - total:  byte totali codificati
+ */
+typedef struct {
+    struct iovec *iov;
+    b_enc_file *files;
+    size_t n_iov, iov_cap;
+    b_enc_chunk *chunks;
+    b_enc_map *maps;
+    size_t n_maps, maps_cap;
+    size_t total;
+    int flags;
+} b_iovec_enc;
+
+
+/* ============================================================================
+ * FUNZIONI: dimensionamento e codifica contigua
+ * ============================================================================
+ */
+
+/**
+ * @brief Lunghezza esatta della codifica di obj, senza scrivere nulla
+ *
+ * Contenitori con forma codificata ancora valida (b_obj_encoded()): O(1)
+ * se nessun sottoalbero è stato modificato in place. Altrimenti somma
+ * per ogni bytestring cifre(n) + 1 + n, per ogni contenitore 2 + i figli.
+ */
+size_t bencode_encoded_size(b_obj *obj);
+
+/**
+ * @brief Codifica obj in buf, che deve avere almeno bencode_encoded_size(obj) byte
+ *
+ * @return Byte scritti (sempre uguale a bencode_encoded_size(obj))
+ */
+size_t bencode_encode(b_obj *obj, char *buf);
+
+/**
+ * @brief Codifica obj in un buffer allocato esattamente una volta
+ *
+ * @param len Riempito con la lunghezza della codifica
+ *
+ * @return Buffer di *len byte (non null-terminated), da liberare con free()
+ */
+char* bencode_encode_alloc(b_obj *obj, size_t *len);
+
+
+/* ============================================================================
+ * FUNZIONI: costruzione
+ * ============================================================================
+ */
+
+/**
+ * @brief Inizializza un encoder vuoto
+ *
+ * @param flags 0 oppure B_ENC_USE_ENCODED
+ */
+void b_iovec_enc_init(b_iovec_enc *enc, int flags);
+
+/**
+ * @brief Registra una regione mmap di fd (offset della regione nel file)
+ *
+ * I contenuti che cadono interamente nella regione verranno inviati con
+ * sendfile() da b_iovec_enc_write().
+ */
+void b_iovec_enc_map_file(b_iovec_enc *enc, const void *base, size_t len, int fd, off_t offset);
+
+/**
+ * @brief Aggiunge la codifica di obj in coda ai segmenti
+ *
+ * @note I buffer di obj devono restare validi finché i segmenti vengono usati
+ */
+void b_iovec_enc_append(b_iovec_enc *enc, b_obj *obj);
+
+/**
+ * @brief Aggiunge byte già codificati (copiati se brevi, altrimenti referenziati)
+ */
+void b_iovec_enc_append_raw(b_iovec_enc *enc, const void *data, size_t len);
+
+/**
+ * @brief Libera segmenti e blocchi (non i buffer referenziati)
+ */
+void b_iovec_enc_free(b_iovec_enc *enc);
+
+
+/* ============================================================================
+ * FUNZIONI: output
+ * ============================================================================
+ */
+
+/**
+ * @brief Byte totali codificati
+ */
+size_t b_iovec_enc_length(const b_iovec_enc *enc);
+
+/**
+ * @brief Segmenti come array di iovec (valido fino alla prossima append)
+ *
+ * @param n Riempito con il numero di segmenti
+ */
+const struct iovec* b_iovec_enc_iov(const b_iovec_enc *enc, size_t *n);
+
+/**
+ * @brief Scrive tutta la codifica su fd (file o socket bloccante)
+ *
+ * Le sequenze di segmenti in memoria vanno in writev() (a blocchi di al
+ * più B_ENC_WRITEV_MAX), i segmenti su file in sendfile(). Le scritture
+ * parziali e EINTR vengono gestite internamente.
+ *
+ * @return Byte scritti, -1 in caso di errore (errno impostato)
+ */
+ssize_t b_iovec_enc_write(b_iovec_enc *enc, int fd);
+
+
+#endif  /* ENCODE_H */
@@ -0,0 +1,144 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#define B_FOOTPRINT_USABLE 1
+#endif
+
+#include "footprint.h"
+
+/* ============================================================================
+ * HELPER: conteggio dei blocchi
+ * ============================================================================
+ */
+
+/**
+ * @brief Aggiunge il blocco ptr alla categoria cat
+ *
+ * @param requested Dimensione logica, usata per i nodi in arena e senza glibc
+ */
+static void account(b_footprint *fp, size_t *cat, const void *ptr, size_t requested, int in_arena) {
+    if (ptr == NULL) {
+        return;
+    }
+    if (in_arena) {
+        *cat += requested;
+        return;
+    }
+
+#ifdef B_FOOTPRINT_USABLE
+    *cat += malloc_usable_size((void *)ptr);
+    fp->overhead += sizeof(size_t);
+#else
+    *cat += requested;
+#endif
+    fp->blocks++;
+}
+
+/**
+ * @brief Byte del contenuto decodificato di un elemento, '\0' compreso
+ *
+ * Dalla lunghezza codificata, non da strlen(): una stringa può contenere
+ * byte nulli.
+ */
+static size_t decoded_size(B_TYPE type, const b_element *e) {
+    if (type == B_INT) {
+        return (size_t)e->length - 2 + 1;  /* "i<n>e" senza 'i' ed 'e' */
+    }
+    return bytestring_payload_length(e->length) + 1;
+}
+
+static void walk(b_obj *obj, b_footprint *fp) {
+    if (obj == NULL) {
+        return;
+    }
+
+    int arena = (obj->refs & B_OBJ_REFS_ARENA) != 0;
+    account(fp, &fp->nodes, obj, sizeof(b_obj), arena);
+    account(fp, &fp->nodes, obj->object, sizeof(b_box), arena);
+    if (obj->object == NULL) {
+        return;
+    }
+
+    switch (obj->type) {
+        case B_INT:
+        case B_STR: {
+            b_element *e = obj->object->int_str;
+            account(fp, &fp->nodes, e, sizeof(b_element), arena);
+            if (e != NULL) {
+                account(fp, &fp->strings, e->encoded_element, (size_t)e->length + 1, arena);
+                account(fp, &fp->strings, e->decoded_element, decoded_size(obj->type, e), arena);
+            }
+            break;
+        }
+
+        case B_HEX: {
+            b_pieces *p = obj->object->pieces;
+            account(fp, &fp->nodes, p, sizeof(b_pieces), arena);
+            if (p != NULL) {
+                account(fp, &fp->binary, p->decoded_pieces,
+                        bytestring_payload_length(p->length), arena);
+            }
+            break;
+        }
+
+        case B_LIS: {
+            b_list *l = obj->object->list;
+            account(fp, &fp->nodes, l, sizeof(b_list), arena);
+            if (l == NULL) {
+                break;
+            }
+            account(fp, &fp->strings, l->encoded_list, (size_t)l->length, arena);
+            for (list_node *n = l->list; n != NULL; n = n->next) {
+                account(fp, &fp->nodes, n, sizeof(list_node), arena);
+                walk(n->object, fp);
+            }
+            break;
+        }
+
+        case B_DICT: {
+            b_dict *d = obj->object->dict;
+            account(fp, &fp->nodes, d, sizeof(b_dict), arena);
+            if (d == NULL) {
+                break;
+            }
+            account(fp, &fp->strings, d->encoded_dict, (size_t)d->length, arena);
+            for (dict_node *n = d->dict; n != NULL; n = n->next) {
+                account(fp, &fp->nodes, n, sizeof(dict_node), arena);
+                walk(n->key, fp);
+                walk(n->value, fp);
+            }
+            break;
+        }
+
+        case B_NULL:
+            break;
+    }
+}
+
+
+/* ============================================================================
+ * FUNZIONI: conteggio
+ * ============================================================================
+ */
+
+size_t b_obj_footprint(b_obj *obj, b_footprint *out) {
+
+    /* Input validation */
+    if(obj == NULL){
+        fprintf(stderr, "Error! NULL pointer parsed in function b_obj_footprint()! ");
+        exit(-1);
+    }
+
+    b_footprint fp;
+    memset(&fp, 0, sizeof(fp));
+    walk(obj, &fp);
+    fp.total = fp.nodes + fp.strings + fp.binary + fp.overhead;
+
+    if (out != NULL) {
+        *out = fp;
+    }
+    return fp.total;
+}
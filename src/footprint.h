@@ -0,0 +1,72 @@
+#ifndef FOOTPRINT_H
+#define FOOTPRINT_H
+
+#include <stddef.h>
+
+#include "structs.h"
+
+/* ============================================================================
+ * PANORAMICA: Memoria occupata da un albero decodificato
+ * ============================================================================
+ *
+ * decode_*(), list_add() e dict_add() spargono un documento su molte
+ * malloc: b_obj, b_box, b_element/b_pieces/b_list/b_dict, nodi delle liste,
+ * forme codificate e decodificate. b_obj_footprint() percorre l'albero e
+ * somma i byte realmente assegnati dall'allocatore a ogni blocco
+ * (malloc_usable_size() con glibc), divisi per categoria:
+ *
+ *   - nodes:    strutture (b_obj, b_box, contenitori, list_node/dict_node)
+ *   - strings:  forme codificate e decodificate di interi, stringhe, liste
+ *               e dizionari
+ *   - binary:   dati di B_HEX ("pieces")
+ *   - overhead: intestazione dei blocchi dell'allocatore (una parola per
+ *               blocco in glibc)
+ *
+ * I nodi in arena (refs con B_OBJ_REFS_ARENA: b_obj_clone(), pdecode) non
+ * hanno blocchi propri: contano la loro dimensione logica e nessun
+ * overhead. Il totale dell'arena intera si ottiene da b_obj_clone_size()
+ * o bencode_decode_parallel_bytes().
+ *
+ * Senza glibc si usano le dimensioni richieste, senza overhead.
+ *
+ * ============================================================================
+ */
+
+
+/* ============================================================================
+ * STRUCT: conteggio
+ * ============================================================================
+ */
+
+/**
+ * @struct b_footprint
+ * @brief Byte occupati da un albero, per categoria (total è la somma)
+ */
+typedef struct {
+    size_t nodes;
+    size_t strings;
+    size_t binary;
+    size_t overhead;
+    size_t total;
+    size_t blocks;   /* Blocchi malloc attraversati */
+} b_footprint;
+
+
+/* ============================================================================
+ * FUNZIONI: conteggio
+ * ============================================================================
+ */
+
+/**
+ * @brief Byte di heap occupati dall'albero obj
+ *
+ * Un sottoalbero condiviso (b_obj_retain()) è contato ogni volta che compare.
+ *
+ * @param out Riempito con il dettaglio per categoria (può essere NULL)
+ *
+ * @return Totale in byte
+ */
+size_t b_obj_footprint(b_obj *obj, b_footprint *out);
+
+
+#endif  /* FOOTPRINT_H */
@@ -0,0 +1,752 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define B_HASH_X86 1
+#endif
+
+#include "hash.h"
+#include "probes.h"
+
+B_PROBE_SEMAPHORE(piece_hashed);
+B_PROBE_SEMAPHORE(piece_verified);
+
+/* ============================================================================
+ * HELPER: lettura/scrittura big-endian e rotazioni
+ * ============================================================================
+ */
+
+static inline uint32_t load_be32(const unsigned char *p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) |
+           ((uint32_t)p[2] << 8)  |  (uint32_t)p[3];
+}
+
+static inline void store_be32(unsigned char *p, uint32_t v) {
+    p[0] = (unsigned char)(v >> 24);
+    p[1] = (unsigned char)(v >> 16);
+    p[2] = (unsigned char)(v >> 8);
+    p[3] = (unsigned char)v;
+}
+
+static inline void store_be64(unsigned char *p, uint64_t v) {
+    store_be32(p, (uint32_t)(v >> 32));
+    store_be32(p + 4, (uint32_t)v);
+}
+
+#define ROTL32(x, n) (((x) << (n)) | ((x) >> (32 - (n))))
+#define ROTR32(x, n) (((x) >> (n)) | ((x) << (32 - (n))))
+
+
+/* ============================================================================
+ * COSTANTI
+ * ============================================================================
+ */
+
+static const uint32_t SHA1_IV[5] = {
+    0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0
+};
+
+static const uint32_t SHA256_IV[8] = {
+    0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+    0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+};
+
+static const uint32_t SHA256_K[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+
+/* ============================================================================
+ * BACKEND SCALARE: compressione portabile (riferimento)
+ * ============================================================================
+ */
+
+/**
+ * @brief Comprime nblocks blocchi da 64 byte nello stato SHA-1 (versione scalare)
+ */
+static void sha1_compress_scalar(uint32_t state[5], const unsigned char *data, size_t nblocks) {
+    uint32_t w[16];
+
+    while (nblocks--) {
+        uint32_t a = state[0], b = state[1], c = state[2], d = state[3], e = state[4];
+
+        for (int t = 0; t < 80; t++) {
+            uint32_t f, k;
+
+            /* Schedule del messaggio su finestra circolare di 16 parole */
+            if (t < 16) {
+                w[t] = load_be32(data + 4 * t);
+            } else {
+                uint32_t x = w[(t + 13) & 15] ^ w[(t + 8) & 15] ^ w[(t + 2) & 15] ^ w[t & 15];
+                w[t & 15] = ROTL32(x, 1);
+            }
+
+            if (t < 20)      { f = (b & c) | (~b & d);          k = 0x5A827999; }
+            else if (t < 40) { f = b ^ c ^ d;                   k = 0x6ED9EBA1; }
+            else if (t < 60) { f = (b & c) | (b & d) | (c & d); k = 0x8F1BBCDC; }
+            else             { f = b ^ c ^ d;                   k = 0xCA62C1D6; }
+
+            uint32_t tmp = ROTL32(a, 5) + f + e + k + w[t & 15];
+            e = d;
+            d = c;
+            c = ROTL32(b, 30);
+            b = a;
+            a = tmp;
+        }
+
+        state[0] += a; state[1] += b; state[2] += c; state[3] += d; state[4] += e;
+        data += B_SHA_BLOCK_LENGTH;
+    }
+}
+
+/**
+ * @brief Comprime nblocks blocchi da 64 byte nello stato SHA-256 (versione scalare)
+ */
+static void sha256_compress_scalar(uint32_t state[8], const unsigned char *data, size_t nblocks) {
+    uint32_t w[64];
+
+    while (nblocks--) {
+        for (int t = 0; t < 16; t++) {
+            w[t] = load_be32(data + 4 * t);
+        }
+        for (int t = 16; t < 64; t++) {
+            uint32_t s0 = ROTR32(w[t - 15], 7) ^ ROTR32(w[t - 15], 18) ^ (w[t - 15] >> 3);
+            uint32_t s1 = ROTR32(w[t - 2], 17) ^ ROTR32(w[t - 2], 19) ^ (w[t - 2] >> 10);
+            w[t] = w[t - 16] + s0 + w[t - 7] + s1;
+        }
+
+        uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+        uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+
+        for (int t = 0; t < 64; t++) {
+            uint32_t S1 = ROTR32(e, 6) ^ ROTR32(e, 11) ^ ROTR32(e, 25);
+            uint32_t ch = (e & f) ^ (~e & g);
+            uint32_t t1 = h + S1 + ch + SHA256_K[t] + w[t];
+            uint32_t S0 = ROTR32(a, 2) ^ ROTR32(a, 13) ^ ROTR32(a, 22);
+            uint32_t mj = (a & b) ^ (a & c) ^ (b & c);
+            uint32_t t2 = S0 + mj;
+            h = g; g = f; f = e; e = d + t1;
+            d = c; c = b; b = a; a = t1 + t2;
+        }
+
+        state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+        state[4] += e; state[5] += f; state[6] += g; state[7] += h;
+        data += B_SHA_BLOCK_LENGTH;
+    }
+}
+
+
+/* ============================================================================
+ * BACKEND SHA-NI: istruzioni dedicate Intel/AMD
+ * ============================================================================
+ *
+ * Le funzioni sono compilate con l'attributo target, quindi il resto del
+ * modulo resta compilabile per qualsiasi x86-64; vengono chiamate solo se
+ * __builtin_cpu_supports("sha") è vero.
+ */
+
+#ifdef B_HASH_X86
+
+/*
+ * Un gruppo di 4 round SHA-1 (round 16..79). MSG[] ruota su 4 registri:
+ * il gruppo k consuma MSG[k%4], completa lo schedule di MSG[(k+1)%4] e
+ * prepara MSG[(k+2)%4] e MSG[(k+3)%4]. Le operazioni di schedule eccedenti
+ * negli ultimi gruppi producono valori inutilizzati (innocue).
+ */
+#define SHA1_NI_GROUP(k, EIN, EOUT)                                          \
+    do {                                                                     \
+        EIN = _mm_sha1nexte_epu32(EIN, msg[(k) % 4]);                        \
+        EOUT = abcd;                                                         \
+        msg[((k) + 1) % 4] = _mm_sha1msg2_epu32(msg[((k) + 1) % 4], msg[(k) % 4]); \
+        abcd = _mm_sha1rnds4_epu32(abcd, EIN, (k) / 5);                      \
+        msg[((k) + 3) % 4] = _mm_sha1msg1_epu32(msg[((k) + 3) % 4], msg[(k) % 4]); \
+        msg[((k) + 2) % 4] = _mm_xor_si128(msg[((k) + 2) % 4], msg[(k) % 4]); \
+    } while (0)
+
+__attribute__((target("sha,sse4.1,ssse3")))
+static void sha1_compress_shani(uint32_t state[5], const unsigned char *data, size_t nblocks) {
+    const __m128i mask = _mm_set_epi64x(0x0001020304050607ULL, 0x08090a0b0c0d0e0fULL);
+    __m128i abcd, abcd_save, e0, e0_save, e1;
+    __m128i msg[4];
+
+    abcd = _mm_loadu_si128((const __m128i*)state);
+    abcd = _mm_shuffle_epi32(abcd, 0x1B);
+    e0   = _mm_set_epi32((int)state[4], 0, 0, 0);
+
+    while (nblocks--) {
+        abcd_save = abcd;
+        e0_save   = e0;
+
+        for (int i = 0; i < 4; i++) {
+            msg[i] = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(data + 16 * i)), mask);
+        }
+
+        /* Round 0-15: lo schedule è ancora in fase di caricamento */
+        e0   = _mm_add_epi32(e0, msg[0]);
+        e1   = abcd;
+        abcd = _mm_sha1rnds4_epu32(abcd, e0, 0);
+
+        e1     = _mm_sha1nexte_epu32(e1, msg[1]);
+        e0     = abcd;
+        abcd   = _mm_sha1rnds4_epu32(abcd, e1, 0);
+        msg[0] = _mm_sha1msg1_epu32(msg[0], msg[1]);
+
+        e0     = _mm_sha1nexte_epu32(e0, msg[2]);
+        e1     = abcd;
+        abcd   = _mm_sha1rnds4_epu32(abcd, e0, 0);
+        msg[1] = _mm_sha1msg1_epu32(msg[1], msg[2]);
+        msg[0] = _mm_xor_si128(msg[0], msg[2]);
+
+        SHA1_NI_GROUP(3, e1, e0);
+
+        /* Round 16-79: schema regolare */
+        SHA1_NI_GROUP(4,  e0, e1); SHA1_NI_GROUP(5,  e1, e0);
+        SHA1_NI_GROUP(6,  e0, e1); SHA1_NI_GROUP(7,  e1, e0);
+        SHA1_NI_GROUP(8,  e0, e1); SHA1_NI_GROUP(9,  e1, e0);
+        SHA1_NI_GROUP(10, e0, e1); SHA1_NI_GROUP(11, e1, e0);
+        SHA1_NI_GROUP(12, e0, e1); SHA1_NI_GROUP(13, e1, e0);
+        SHA1_NI_GROUP(14, e0, e1); SHA1_NI_GROUP(15, e1, e0);
+        SHA1_NI_GROUP(16, e0, e1); SHA1_NI_GROUP(17, e1, e0);
+        SHA1_NI_GROUP(18, e0, e1); SHA1_NI_GROUP(19, e1, e0);
+
+        e0   = _mm_sha1nexte_epu32(e0, e0_save);
+        abcd = _mm_add_epi32(abcd, abcd_save);
+
+        data += B_SHA_BLOCK_LENGTH;
+    }
+
+    abcd = _mm_shuffle_epi32(abcd, 0x1B);
+    _mm_storeu_si128((__m128i*)state, abcd);
+    state[4] = (uint32_t)_mm_extract_epi32(e0, 3);
+}
+
+/*
+ * Un gruppo di 4 round SHA-256 (round 12..63), stesso schema a rotazione
+ * di SHA1_NI_GROUP.
+ */
+#define SHA256_NI_GROUP(k)                                                   \
+    do {                                                                     \
+        m = _mm_add_epi32(msg[(k) % 4],                                      \
+                          _mm_loadu_si128((const __m128i*)&SHA256_K[4 * (k)])); \
+        state1 = _mm_sha256rnds2_epu32(state1, state0, m);                   \
+        tmp = _mm_alignr_epi8(msg[(k) % 4], msg[((k) + 3) % 4], 4);          \
+        msg[((k) + 1) % 4] = _mm_add_epi32(msg[((k) + 1) % 4], tmp);         \
+        msg[((k) + 1) % 4] = _mm_sha256msg2_epu32(msg[((k) + 1) % 4], msg[(k) % 4]); \
+        m = _mm_shuffle_epi32(m, 0x0E);                                      \
+        state0 = _mm_sha256rnds2_epu32(state0, state1, m);                   \
+        msg[((k) + 3) % 4] = _mm_sha256msg1_epu32(msg[((k) + 3) % 4], msg[(k) % 4]); \
+    } while (0)
+
+__attribute__((target("sha,sse4.1,ssse3")))
+static void sha256_compress_shani(uint32_t state[8], const unsigned char *data, size_t nblocks) {
+    const __m128i mask = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+    __m128i state0, state1, save0, save1, m, tmp;
+    __m128i msg[4];
+
+    /* Riordina lo stato nel layout ABEF/CDGH richiesto da sha256rnds2 */
+    tmp    = _mm_loadu_si128((const __m128i*)&state[0]);
+    state1 = _mm_loadu_si128((const __m128i*)&state[4]);
+    tmp    = _mm_shuffle_epi32(tmp, 0xB1);
+    state1 = _mm_shuffle_epi32(state1, 0x1B);
+    state0 = _mm_alignr_epi8(tmp, state1, 8);
+    state1 = _mm_blend_epi16(state1, tmp, 0xF0);
+
+    while (nblocks--) {
+        save0 = state0;
+        save1 = state1;
+
+        for (int i = 0; i < 4; i++) {
+            msg[i] = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(data + 16 * i)), mask);
+        }
+
+        /* Round 0-11 */
+        for (int k = 0; k < 3; k++) {
+            m = _mm_add_epi32(msg[k], _mm_loadu_si128((const __m128i*)&SHA256_K[4 * k]));
+            state1 = _mm_sha256rnds2_epu32(state1, state0, m);
+            m = _mm_shuffle_epi32(m, 0x0E);
+            state0 = _mm_sha256rnds2_epu32(state0, state1, m);
+            if (k > 0) {
+                msg[k - 1] = _mm_sha256msg1_epu32(msg[k - 1], msg[k]);
+            }
+        }
+
+        /* Round 12-63 */
+        SHA256_NI_GROUP(3);  SHA256_NI_GROUP(4);  SHA256_NI_GROUP(5);
+        SHA256_NI_GROUP(6);  SHA256_NI_GROUP(7);  SHA256_NI_GROUP(8);
+        SHA256_NI_GROUP(9);  SHA256_NI_GROUP(10); SHA256_NI_GROUP(11);
+        SHA256_NI_GROUP(12); SHA256_NI_GROUP(13); SHA256_NI_GROUP(14);
+        SHA256_NI_GROUP(15);
+
+        state0 = _mm_add_epi32(state0, save0);
+        state1 = _mm_add_epi32(state1, save1);
+
+        data += B_SHA_BLOCK_LENGTH;
+    }
+
+    /* Ripristina l'ordine A..H */
+    tmp    = _mm_shuffle_epi32(state0, 0x1B);
+    state1 = _mm_shuffle_epi32(state1, 0xB1);
+    state0 = _mm_blend_epi16(tmp, state1, 0xF0);
+    state1 = _mm_alignr_epi8(state1, tmp, 8);
+
+    _mm_storeu_si128((__m128i*)&state[0], state0);
+    _mm_storeu_si128((__m128i*)&state[4], state1);
+}
+
+#endif  /* B_HASH_X86 */
+
+
+/* ============================================================================
+ * DISPATCH: selezione del backend
+ * ============================================================================
+ */
+
+/**
+ * @brief Ritorna 1 se la CPU supporta le estensioni SHA (SHA-NI)
+ *
+ * __builtin_cpu_supports legge una tabella inizializzata da un costruttore
+ * di libgcc, quindi è economica e thread-safe.
+ */
+static int have_shani(void) {
+#ifdef B_HASH_X86
+    return __builtin_cpu_supports("sha") && __builtin_cpu_supports("sse4.1") &&
+           __builtin_cpu_supports("ssse3");
+#else
+    return 0;
+#endif
+}
+
+static void sha1_compress(uint32_t state[5], const unsigned char *data, size_t nblocks) {
+#ifdef B_HASH_X86
+    if (have_shani()) {
+        sha1_compress_shani(state, data, nblocks);
+        return;
+    }
+#endif
+    sha1_compress_scalar(state, data, nblocks);
+}
+
+static void sha256_compress(uint32_t state[8], const unsigned char *data, size_t nblocks) {
+#ifdef B_HASH_X86
+    if (have_shani()) {
+        sha256_compress_shani(state, data, nblocks);
+        return;
+    }
+#endif
+    sha256_compress_scalar(state, data, nblocks);
+}
+
+const char* b_hash_backend(void) {
+    if (have_shani()) {
+        return "sha-ni";
+    }
+#ifdef B_HASH_X86
+    if (__builtin_cpu_supports("avx2")) {
+        return "multi-buffer avx2";
+    }
+    return "multi-buffer sse2";
+#else
+    return "scalar";
+#endif
+}
+
+
+/* ============================================================================
+ * FUNZIONI: API di streaming
+ * ============================================================================
+ *
+ * SHA-1 e SHA-256 condividono lo stesso padding Merkle-Damgård (0x80, zeri,
+ * lunghezza in bit big-endian a 64 bit), implementato dalle macro seguenti
+ * sui campi comuni dei due contesti.
+ */
+
+#define SHA_UPDATE(ctx, data, len, compress)                                 \
+    do {                                                                     \
+        const unsigned char *p = (const unsigned char*)(data);               \
+        size_t n = (len);                                                    \
+        (ctx)->total += n;                                                   \
+        /* Completa il blocco parziale, se presente */                       \
+        if ((ctx)->used > 0) {                                               \
+            size_t take = B_SHA_BLOCK_LENGTH - (ctx)->used;                  \
+            if (take > n) take = n;                                          \
+            memcpy((ctx)->buffer + (ctx)->used, p, take);                    \
+            (ctx)->used += take;                                             \
+            p += take;                                                       \
+            n -= take;                                                       \
+            if ((ctx)->used < B_SHA_BLOCK_LENGTH) break;                     \
+            compress((ctx)->state, (ctx)->buffer, 1);                        \
+            (ctx)->used = 0;                                                 \
+        }                                                                    \
+        /* Blocchi interi direttamente dal buffer del chiamante */           \
+        if (n >= B_SHA_BLOCK_LENGTH) {                                       \
+            compress((ctx)->state, p, n / B_SHA_BLOCK_LENGTH);               \
+            p += n & ~(size_t)(B_SHA_BLOCK_LENGTH - 1);                      \
+            n &= B_SHA_BLOCK_LENGTH - 1;                                     \
+        }                                                                    \
+        memcpy((ctx)->buffer, p, n);                                         \
+        (ctx)->used = n;                                                     \
+    } while (0)
+
+#define SHA_PAD(ctx, compress)                                               \
+    do {                                                                     \
+        uint64_t bits = (ctx)->total * 8;                                    \
+        (ctx)->buffer[(ctx)->used++] = 0x80;                                 \
+        if ((ctx)->used > B_SHA_BLOCK_LENGTH - 8) {                          \
+            memset((ctx)->buffer + (ctx)->used, 0, B_SHA_BLOCK_LENGTH - (ctx)->used); \
+            compress((ctx)->state, (ctx)->buffer, 1);                        \
+            (ctx)->used = 0;                                                 \
+        }                                                                    \
+        memset((ctx)->buffer + (ctx)->used, 0, B_SHA_BLOCK_LENGTH - 8 - (ctx)->used); \
+        store_be64((ctx)->buffer + B_SHA_BLOCK_LENGTH - 8, bits);            \
+        compress((ctx)->state, (ctx)->buffer, 1);                            \
+    } while (0)
+
+void b_sha1_init(b_sha1_ctx *ctx) {
+
+    /* Input validation */
+    if(ctx == NULL){
+        fprintf(stderr, "Error! NULL pointer parsed in function b_sha1_init()! ");
+        exit(-1);
+    }
+
+    memcpy(ctx->state, SHA1_IV, sizeof(SHA1_IV));
+    ctx->total = 0;
+    ctx->used  = 0;
+}
+
+void b_sha1_update(b_sha1_ctx *ctx, const void *data, size_t len) {
+
+    /* Input validation */
+    if(ctx == NULL || (data == NULL && len > 0)){
+        fprintf(stderr, "Error! NULL pointer parsed in function b_sha1_update()! ");
+        exit(-1);
+    }
+
+    SHA_UPDATE(ctx, data, len, sha1_compress);
+}
+
+void b_sha1_final(b_sha1_ctx *ctx, unsigned char *digest) {
+
+    /* Input validation */
+    if(ctx == NULL || digest == NULL){
+        fprintf(stderr, "Error! NULL pointer parsed in function b_sha1_final()! ");
+        exit(-1);
+    }
+
+    SHA_PAD(ctx, sha1_compress);
+    for (int i = 0; i < 5; i++) {
+        store_be32(digest + 4 * i, ctx->state[i]);
+    }
+}
+
+void b_sha1(const void *data, size_t len, unsigned char *digest) {
+    b_sha1_ctx ctx;
+    b_sha1_init(&ctx);
+    b_sha1_update(&ctx, data, len);
+    b_sha1_final(&ctx, digest);
+}
+
+void b_sha256_init(b_sha256_ctx *ctx) {
+
+    /* Input validation */
+    if(ctx == NULL){
+        fprintf(stderr, "Error! NULL pointer parsed in function b_sha256_init()! ");
+        exit(-1);
+    }
+
+    memcpy(ctx->state, SHA256_IV, sizeof(SHA256_IV));
+    ctx->total = 0;
+    ctx->used  = 0;
+}
+
+void b_sha256_update(b_sha256_ctx *ctx, const void *data, size_t len) {
+
+    /* Input validation */
+    if(ctx == NULL || (data == NULL && len > 0)){
+        fprintf(stderr, "Error! NULL pointer parsed in function b_sha256_update()! ");
+        exit(-1);
+    }
+
+    SHA_UPDATE(ctx, data, len, sha256_compress);
+}
+
+void b_sha256_final(b_sha256_ctx *ctx, unsigned char *digest) {
+
+    /* Input validation */
+    if(ctx == NULL || digest == NULL){
+        fprintf(stderr, "Error! NULL pointer parsed in function b_sha256_final()! ");
+        exit(-1);
+    }
+
+    SHA_PAD(ctx, sha256_compress);
+    for (int i = 0; i < 8; i++) {
+        store_be32(digest + 4 * i, ctx->state[i]);
+    }
+}
+
+void b_sha256(const void *data, size_t len, unsigned char *digest) {
+    b_sha256_ctx ctx;
+    b_sha256_init(&ctx);
+    b_sha256_update(&ctx, data, len);
+    b_sha256_final(&ctx, digest);
+}
+
+
+/* ============================================================================
+ * BACKEND MULTI-BUFFER: 8 messaggi SHA-1 in parallelo
+ * ============================================================================
+ *
+ * Ogni lane di un vettore da 8 parole a 32 bit porta avanti un messaggio
+ * diverso. I tipi vettoriali di GCC vengono abbassati a SSE2 (2 registri da
+ * 128 bit) o, tramite target_clones, ad AVX2 (un registro da 256 bit) se la
+ * CPU lo supporta: la selezione avviene una volta sola al caricamento.
+ */
+
+typedef uint32_t v8u32 __attribute__((vector_size(32)));
+
+#define VROTL(x, n) (((x) << (n)) | ((x) >> (32 - (n))))
+
+/**
+ * @brief Comprime un blocco per ciascuna delle 8 lane
+ *
+ * @param state  Stato trasposto: state[i][lane] = Hi della lane
+ * @param blocks 8 puntatori a blocchi da 64 byte (uno per lane)
+ */
+#ifdef B_HASH_X86
+__attribute__((target_clones("avx2", "default")))
+#endif
+static void sha1_compress_x8(v8u32 state[5], const unsigned char *const blocks[B_SHA1_LANES]) {
+    v8u32 w[16];
+    v8u32 a = state[0], b = state[1], c = state[2], d = state[3], e = state[4];
+
+    /* Caricamento trasposto: la parola t di ogni lane finisce in w[t][lane] */
+    for (int t = 0; t < 16; t++) {
+        for (int l = 0; l < B_SHA1_LANES; l++) {
+            w[t][l] = load_be32(blocks[l] + 4 * t);
+        }
+    }
+
+    for (int t = 0; t < 80; t++) {
+        v8u32 f;
+        uint32_t k;
+
+        if (t >= 16) {
+            v8u32 x = w[(t + 13) & 15] ^ w[(t + 8) & 15] ^ w[(t + 2) & 15] ^ w[t & 15];
+            w[t & 15] = VROTL(x, 1);
+        }
+
+        if (t < 20)      { f = (b & c) | (~b & d);          k = 0x5A827999; }
+        else if (t < 40) { f = b ^ c ^ d;                   k = 0x6ED9EBA1; }
+        else if (t < 60) { f = (b & c) | (b & d) | (c & d); k = 0x8F1BBCDC; }
+        else             { f = b ^ c ^ d;                   k = 0xCA62C1D6; }
+
+        v8u32 tmp = VROTL(a, 5) + f + e + k + w[t & 15];
+        e = d;
+        d = c;
+        c = VROTL(b, 30);
+        b = a;
+        a = tmp;
+    }
+
+    state[0] += a; state[1] += b; state[2] += c; state[3] += d; state[4] += e;
+}
+
+/**
+ * @struct sha1_lane
+ * @brief Stato di avanzamento di un messaggio assegnato a una lane
+ *
+ * I blocchi interi vengono letti direttamente dal buffer del chiamante; il
+ * padding finale (1 o 2 blocchi) è preparato in tail.
+ */
+typedef struct {
+    const unsigned char *data;   /* Dati del messaggio (NULL = lane inattiva) */
+    size_t full_blocks;          /* Blocchi interi nel buffer del chiamante */
+    size_t next_block;           /* Prossimo blocco da comprimere */
+    size_t tail_blocks;          /* Blocchi di padding (1 o 2) */
+    size_t job;                  /* Indice del messaggio nell'input */
+    unsigned char tail[2 * B_SHA_BLOCK_LENGTH];
+} sha1_lane;
+
+static void lane_start(sha1_lane *lane, v8u32 state[5], int l,
+                       const unsigned char *data, size_t len, size_t job) {
+    size_t rem = len % B_SHA_BLOCK_LENGTH;
+
+    lane->data        = data;
+    lane->full_blocks = len / B_SHA_BLOCK_LENGTH;
+    lane->next_block  = 0;
+    lane->job         = job;
+    lane->tail_blocks = (rem + 1 + 8 > B_SHA_BLOCK_LENGTH) ? 2 : 1;
+
+    memset(lane->tail, 0, sizeof(lane->tail));
+    if (rem > 0) {
+        memcpy(lane->tail, data + len - rem, rem);
+    }
+    lane->tail[rem] = 0x80;
+    store_be64(lane->tail + lane->tail_blocks * B_SHA_BLOCK_LENGTH - 8, (uint64_t)len * 8);
+
+    for (int i = 0; i < 5; i++) {
+        state[i][l] = SHA1_IV[i];
+    }
+}
+
+void b_sha1_multi(const unsigned char *const *bufs, const size_t *lens, size_t n,
+                  unsigned char *digests) {
+
+    /* Input validation */
+    if((bufs == NULL || lens == NULL || digests == NULL) && n > 0){
+        fprintf(stderr, "Error! NULL pointer parsed in function b_sha1_multi()! ");
+        exit(-1);
+    }
+
+    /* Con SHA-NI un singolo stream è già più veloce di 8 lane SIMD */
+    if (have_shani()) {
+        for (size_t i = 0; i < n; i++) {
+            b_sha1(bufs[i], lens[i], digests + i * B_SHA1_DIGEST_LENGTH);
+        }
+        return;
+    }
+
+    static const unsigned char idle_block[B_SHA_BLOCK_LENGTH];
+    sha1_lane lanes[B_SHA1_LANES];
+    v8u32 state[5];
+    const unsigned char *blocks[B_SHA1_LANES];
+    size_t next_job = 0, active = 0;
+
+    memset(state, 0, sizeof(state));
+
+    /* Assegna un messaggio iniziale a ogni lane */
+    for (int l = 0; l < B_SHA1_LANES; l++) {
+        if (next_job < n) {
+            lane_start(&lanes[l], state, l, bufs[next_job], lens[next_job], next_job);
+            next_job++;
+            active++;
+        } else {
+            lanes[l].data = NULL;
+        }
+    }
+
+    while (active > 0) {
+        /* Blocco corrente di ogni lane: dati del chiamante, padding o blocco fittizio */
+        for (int l = 0; l < B_SHA1_LANES; l++) {
+            sha1_lane *ln = &lanes[l];
+            if (ln->data == NULL) {
+                blocks[l] = idle_block;
+            } else if (ln->next_block < ln->full_blocks) {
+                blocks[l] = ln->data + ln->next_block * B_SHA_BLOCK_LENGTH;
+            } else {
+                blocks[l] = ln->tail + (ln->next_block - ln->full_blocks) * B_SHA_BLOCK_LENGTH;
+            }
+        }
+
+        sha1_compress_x8(state, blocks);
+
+        /* Avanza le lane; quelle concluse emettono il digest e prendono un nuovo messaggio */
+        for (int l = 0; l < B_SHA1_LANES; l++) {
+            sha1_lane *ln = &lanes[l];
+            if (ln->data == NULL) {
+                continue;
+            }
+            ln->next_block++;
+            if (ln->next_block < ln->full_blocks + ln->tail_blocks) {
+                continue;
+            }
+
+            unsigned char *out = digests + ln->job * B_SHA1_DIGEST_LENGTH;
+            for (int i = 0; i < 5; i++) {
+                store_be32(out + 4 * i, state[i][l]);
+            }
+
+            if (next_job < n) {
+                lane_start(ln, state, l, bufs[next_job], lens[next_job], next_job);
+                next_job++;
+            } else {
+                ln->data = NULL;
+                active--;
+            }
+        }
+    }
+}
+
+
+/* ============================================================================
+ * FUNZIONI: hashing dei pezzi (creazione e verifica .torrent)
+ * ============================================================================
+ */
+
+/* Pezzi elaborati per ogni chiamata a b_sha1_multi() */
+#define PIECES_BATCH 64
+
+size_t b_sha1_pieces(const unsigned char *data, size_t len, size_t piece_len,
+                     unsigned char *out) {
+
+    /* Input validation */
+    if((data == NULL && len > 0) || out == NULL || piece_len == 0){
+        fprintf(stderr, "Error! Invalid argument parsed in function b_sha1_pieces()! ");
+        exit(-1);
+    }
+
+    size_t n_pieces = (len + piece_len - 1) / piece_len;
+    const unsigned char *bufs[PIECES_BATCH];
+    size_t lens[PIECES_BATCH];
+
+    for (size_t first = 0; first < n_pieces; first += PIECES_BATCH) {
+        size_t count = n_pieces - first < PIECES_BATCH ? n_pieces - first : PIECES_BATCH;
+        for (size_t i = 0; i < count; i++) {
+            size_t off = (first + i) * piece_len;
+            bufs[i] = data + off;
+            lens[i] = len - off < piece_len ? len - off : piece_len;
+        }
+        b_sha1_multi(bufs, lens, count, out + first * B_SHA1_DIGEST_LENGTH);
+        for (size_t i = 0; i < count; i++) {
+            B_PROBE3(piece_hashed, first + i, lens[i], out + (first + i) * B_SHA1_DIGEST_LENGTH);
+        }
+    }
+
+    return n_pieces;
+}
+
+size_t b_sha1_verify_pieces(const unsigned char *data, size_t len, size_t piece_len,
+                            const unsigned char *pieces, size_t n_pieces,
+                            unsigned char *ok) {
+
+    /* Input validation */
+    if((data == NULL && len > 0) || pieces == NULL || ok == NULL || piece_len == 0){
+        fprintf(stderr, "Error! Invalid argument parsed in function b_sha1_verify_pieces()! ");
+        exit(-1);
+    }
+
+    unsigned char digests[PIECES_BATCH * B_SHA1_DIGEST_LENGTH];
+    const unsigned char *bufs[PIECES_BATCH];
+    size_t lens[PIECES_BATCH];
+    size_t matched = 0;
+
+    for (size_t first = 0; first < n_pieces; first += PIECES_BATCH) {
+        size_t count = n_pieces - first < PIECES_BATCH ? n_pieces - first : PIECES_BATCH;
+        for (size_t i = 0; i < count; i++) {
+            size_t off = (first + i) * piece_len;
+            bufs[i] = data + (off < len ? off : len);
+            lens[i] = off >= len ? 0 : (len - off < piece_len ? len - off : piece_len);
+        }
+        b_sha1_multi(bufs, lens, count, digests);
+
+        for (size_t i = 0; i < count; i++) {
+            ok[first + i] = memcmp(digests + i * B_SHA1_DIGEST_LENGTH,
+                                   pieces + (first + i) * B_SHA1_DIGEST_LENGTH,
+                                   B_SHA1_DIGEST_LENGTH) == 0;
+            matched += ok[first + i];
+            B_PROBE3(piece_verified, first + i, lens[i], ok[first + i]);
+        }
+    }
+
+    return matched;
+}
@@ -0,0 +1,169 @@
+#ifndef HASH_H
+#define HASH_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* ============================================================================
+ * PANORAMICA: Modulo di hashing SHA-1 / SHA-256
+ * ============================================================================
+ *
+ * Questo modulo fornisce le primitive di hashing usate dal protocollo
+ * BitTorrent: SHA-1 per gli hash dei pezzi (campo "pieces") e per l'info-hash
+ * v1, SHA-256 per i metafile v2.
+ *
+ * Strategia di esecuzione (scelta a runtime, una sola volta):
+ *   - SHA-NI presente  → compressione con istruzioni dedicate (sha1rnds4,
+ *                        sha256rnds2), un buffer alla volta
+ *   - SHA-NI assente   → per l'hashing di molti buffer indipendenti (pezzi)
+ *                        si usa il percorso multi-buffer: 8 messaggi in
+ *                        parallelo, un messaggio per lane SIMD (SSE2/AVX2)
+ *   - altrimenti       → implementazione scalare portabile
+ *
+ * L'API di streaming (init/update/final) permette di calcolare l'hash di
+ * dati che arrivano a blocchi senza doverli concatenare in memoria.
+ *
+ * ============================================================================
+ */
+
+#define B_SHA1_DIGEST_LENGTH    20   /* Lunghezza di un digest SHA-1 */
+#define B_SHA256_DIGEST_LENGTH  32   /* Lunghezza di un digest SHA-256 */
+#define B_SHA_BLOCK_LENGTH      64   /* Blocco di compressione (SHA-1 e SHA-256) */
+#define B_SHA1_LANES            8    /* Messaggi in volo nel percorso multi-buffer */
+
+
+/* ============================================================================
+ * STRUCT: contesti di streaming
+ * ============================================================================
+ */
+
+/**
+ * @struct b_sha1_ctx
+ * @brief Stato di un calcolo SHA-1 incrementale
+ *
+ * Campi:
+ * - state:  le cinque parole di stato H0..H4
+ * - total:  byte totali ricevuti finora (serve per il padding finale)
+ * - buffer: blocco parziale in attesa di essere compresso
+ * - used:   byte validi in buffer
+ */
+typedef struct {
+    uint32_t state[5];
+    uint64_t total;
+    unsigned char buffer[B_SHA_BLOCK_LENGTH];
+    size_t used;
+} b_sha1_ctx;
+
+/**
+ * @struct b_sha256_ctx
+ * @brief Stato di un calcolo SHA-256 incrementale (stessi campi di b_sha1_ctx)
+ */
+typedef struct {
+    uint32_t state[8];
+    uint64_t total;
+    unsigned char buffer[B_SHA_BLOCK_LENGTH];
+    size_t used;
+} b_sha256_ctx;
+
+
+/* ============================================================================
+ * FUNZIONI: SHA-1
+ * ============================================================================
+ */
+
+/**
+ * @brief Inizializza un contesto SHA-1
+ *
+ * @param ctx Contesto da inizializzare. Non deve essere NULL.
+ */
+void b_sha1_init(b_sha1_ctx *ctx);
+
+/**
+ * @brief Aggiunge dati al calcolo SHA-1 in corso
+ *
+ * @param ctx  Contesto inizializzato con b_sha1_init()
+ * @param data Dati da accodare (può essere NULL solo se len == 0)
+ * @param len  Numero di byte
+ */
+void b_sha1_update(b_sha1_ctx *ctx, const void *data, size_t len);
+
+/**
+ * @brief Completa il calcolo e scrive il digest di 20 byte
+ *
+ * @param ctx    Contesto da finalizzare (va reinizializzato per essere riusato)
+ * @param digest Buffer di almeno B_SHA1_DIGEST_LENGTH byte
+ */
+void b_sha1_final(b_sha1_ctx *ctx, unsigned char *digest);
+
+/**
+ * @brief Calcola SHA-1 di un buffer in una sola chiamata
+ *
+ * Sostituto diretto di SHA1() di OpenSSL.
+ */
+void b_sha1(const void *data, size_t len, unsigned char *digest);
+
+/**
+ * @brief Calcola SHA-1 di n buffer indipendenti
+ *
+ * Se la CPU dispone di SHA-NI i buffer sono elaborati in sequenza con le
+ * istruzioni dedicate; altrimenti si usa il percorso multi-buffer con
+ * B_SHA1_LANES messaggi in volo contemporaneamente.
+ *
+ * @param bufs    Array di n puntatori ai dati
+ * @param lens    Array di n lunghezze
+ * @param n       Numero di buffer
+ * @param digests Output: n digest consecutivi da 20 byte (n * 20 byte)
+ */
+void b_sha1_multi(const unsigned char *const *bufs, const size_t *lens, size_t n,
+                  unsigned char *digests);
+
+/**
+ * @brief Calcola il campo "pieces" di un contenuto (creazione .torrent)
+ *
+ * Divide data in pezzi da piece_len byte (l'ultimo può essere più corto) e
+ * scrive gli hash SHA-1 concatenati in out.
+ *
+ * @param out Buffer di almeno ceil(len / piece_len) * 20 byte
+ *
+ * @return Numero di pezzi elaborati
+ */
+size_t b_sha1_pieces(const unsigned char *data, size_t len, size_t piece_len,
+                     unsigned char *out);
+
+/**
+ * @brief Verifica un contenuto contro il campo "pieces" di un .torrent
+ *
+ * @param pieces  Hash attesi (n_pieces * 20 byte, es. decoded_pieces di un B_HEX)
+ * @param ok      Output: ok[i] = 1 se il pezzo i corrisponde, 0 altrimenti
+ *
+ * @return Numero di pezzi che corrispondono
+ */
+size_t b_sha1_verify_pieces(const unsigned char *data, size_t len, size_t piece_len,
+                            const unsigned char *pieces, size_t n_pieces,
+                            unsigned char *ok);
+
+
+/* ============================================================================
+ * FUNZIONI: SHA-256
+ * ============================================================================
+ */
+
+void b_sha256_init(b_sha256_ctx *ctx);
+void b_sha256_update(b_sha256_ctx *ctx, const void *data, size_t len);
+void b_sha256_final(b_sha256_ctx *ctx, unsigned char *digest);
+void b_sha256(const void *data, size_t len, unsigned char *digest);
+
+
+/* ============================================================================
+ * FUNZIONI: diagnostica
+ * ============================================================================
+ */
+
+/**
+ * @brief Ritorna il nome del backend selezionato ("sha-ni", "multi-buffer avx2",
+ *        "multi-buffer sse2", "scalar")
+ */
+const char* b_hash_backend(void);
+
+
+#endif  /* HASH_H */
@@ -0,0 +1,646 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define B_INV_SSE2 1
+#endif
+
+#include "invindex.h"
+
+/* ============================================================================
+ * HELPER: tabella dei termini in costruzione
+ * ============================================================================
+ */
+
+/**
+ * @struct inv_term
+ * @brief Termine con la sua lista di documenti non compressa
+ *
+ * Il testo è chars[off .. off + len) della tabella; docs è crescente
+ * perché ogni thread visita i propri documenti in ordine.
+ */
+typedef struct {
+    uint32_t off;
+    uint32_t len;
+    uint32_t hash;
+    uint32_t n;
+    uint32_t cap;
+    uint32_t *docs;
+} inv_term;
+
+/**
+ * @struct inv_table
+ * @brief Tabella a indirizzamento aperto termine → inv_term (docs NULL = libera)
+ */
+typedef struct {
+    inv_term *slots;
+    size_t cap;
+    size_t used;
+    char *chars;
+    size_t chars_len;
+    size_t chars_cap;
+} inv_table;
+
+static uint32_t term_hash(const char *s, size_t len) {
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < len; i++) {
+        h = (h ^ (unsigned char)s[i]) * 16777619u;
+    }
+    return h;
+}
+
+static void table_init(inv_table *tab) {
+    tab->cap = 1024;
+    tab->used = 0;
+    tab->slots = calloc(tab->cap, sizeof(inv_term));
+    tab->chars_cap = 16384;
+    tab->chars_len = 0;
+    tab->chars = malloc(tab->chars_cap);
+    if (tab->slots == NULL || tab->chars == NULL) {
+        fprintf(stderr, "Malloc failed in function table_init!\n");
+        exit(-1);
+    }
+}
+
+static void table_free(inv_table *tab) {
+    for (size_t i = 0; i < tab->cap; i++) {
+        free(tab->slots[i].docs);
+    }
+    free(tab->slots);
+    free(tab->chars);
+}
+
+static void table_grow(inv_table *tab) {
+    size_t cap = tab->cap * 2;
+    inv_term *slots = calloc(cap, sizeof(inv_term));
+    if (slots == NULL) {
+        fprintf(stderr, "Malloc failed in function table_grow!\n");
+        exit(-1);
+    }
+    for (size_t i = 0; i < tab->cap; i++) {
+        if (tab->slots[i].docs == NULL) {
+            continue;
+        }
+        size_t s = tab->slots[i].hash & (cap - 1);
+        while (slots[s].docs != NULL) {
+            s = (s + 1) & (cap - 1);
+        }
+        slots[s] = tab->slots[i];
+    }
+    free(tab->slots);
+    tab->slots = slots;
+    tab->cap = cap;
+}
+
+/**
+ * @brief Trova il termine, inserendolo (con lista vuota) se assente
+ */
+static inv_term* table_get(inv_table *tab, const char *term, size_t len, uint32_t hash) {
+    size_t s = hash & (tab->cap - 1);
+    while (tab->slots[s].docs != NULL) {
+        inv_term *t = &tab->slots[s];
+        if (t->hash == hash && t->len == len && memcmp(tab->chars + t->off, term, len) == 0) {
+            return t;
+        }
+        s = (s + 1) & (tab->cap - 1);
+    }
+
+    if ((tab->used + 1) * 2 > tab->cap) {
+        table_grow(tab);
+        return table_get(tab, term, len, hash);
+    }
+
+    if (tab->chars_len + len > tab->chars_cap) {
+        while (tab->chars_len + len > tab->chars_cap) {
+            tab->chars_cap *= 2;
+        }
+        char *chars = realloc(tab->chars, tab->chars_cap);
+        if (chars == NULL) {
+            fprintf(stderr, "Malloc failed in function table_get!\n");
+            exit(-1);
+        }
+        tab->chars = chars;
+    }
+    memcpy(tab->chars + tab->chars_len, term, len);
+
+    inv_term *t = &tab->slots[s];
+    t->off = (uint32_t)tab->chars_len;
+    t->len = (uint32_t)len;
+    t->hash = hash;
+    t->n = 0;
+    t->cap = 4;
+    t->docs = malloc(t->cap * sizeof(uint32_t));
+    if (t->docs == NULL) {
+        fprintf(stderr, "Malloc failed in function table_get!\n");
+        exit(-1);
+    }
+    tab->chars_len += len;
+    tab->used++;
+    return t;
+}
+
+static void term_append(inv_term *t, const uint32_t *docs, uint32_t n) {
+    if (t->n + n > t->cap) {
+        while (t->n + n > t->cap) {
+            t->cap *= 2;
+        }
+        uint32_t *grown = realloc(t->docs, t->cap * sizeof(uint32_t));
+        if (grown == NULL) {
+            fprintf(stderr, "Malloc failed in function term_append!\n");
+            exit(-1);
+        }
+        t->docs = grown;
+    }
+    memcpy(t->docs + t->n, docs, n * sizeof(uint32_t));
+    t->n += n;
+}
+
+
+/* ============================================================================
+ * HELPER: divisione in termini ed estrazione dai documenti
+ * ============================================================================
+ */
+
+static inline int is_term_char(unsigned char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c >= 0x80;
+}
+
+/**
+ * @brief Divide s in termini e chiama emit per ognuno (in minuscolo)
+ */
+static void tokenize(const char *s, size_t len,
+                     void (*emit)(void *ctx, const char *term, size_t len), void *ctx) {
+    char term[B_INV_MAX_TERM];
+    size_t i = 0;
+    while (i < len) {
+        while (i < len && !is_term_char((unsigned char)s[i])) {
+            i++;
+        }
+        size_t n = 0;
+        int too_long = 0;
+        while (i < len && is_term_char((unsigned char)s[i])) {
+            unsigned char c = (unsigned char)s[i++];
+            if (n == B_INV_MAX_TERM) {
+                too_long = 1;
+                continue;
+            }
+            term[n++] = (char)(c >= 'A' && c <= 'Z' ? c + ('a' - 'A') : c);
+        }
+        if (n > 0 && !too_long) {
+            emit(ctx, term, n);
+        }
+    }
+}
+
+typedef struct {
+    inv_table *tab;
+    uint32_t doc;
+} inv_doc_ctx;
+
+static void emit_doc_term(void *arg, const char *term, size_t len) {
+    inv_doc_ctx *ctx = arg;
+    inv_term *t = table_get(ctx->tab, term, len, term_hash(term, len));
+    /* Un termine ripetuto nello stesso documento compare una volta */
+    if (t->n == 0 || t->docs[t->n - 1] != ctx->doc) {
+        term_append(t, &ctx->doc, 1);
+    }
+}
+
+static void index_string(inv_doc_ctx *ctx, b_obj *obj) {
+    if (obj == NULL || obj->type != B_STR) {
+        return;
+    }
+    const char *s = obj->object->int_str->decoded_element;
+    tokenize(s, strlen(s), emit_doc_term, ctx);
+}
+
+static b_dict* as_dict(b_obj *obj) {
+    return obj != NULL && obj->type == B_DICT ? obj->object->dict : NULL;
+}
+
+static b_list* as_list(b_obj *obj) {
+    return obj != NULL && obj->type == B_LIS ? obj->object->list : NULL;
+}
+
+/* info.name e ogni elemento di info.files[*].path */
+static void index_doc(inv_table *tab, b_obj *root, uint32_t doc) {
+    b_dict *meta = as_dict(root);
+    b_dict *info = meta ? as_dict(dict_get(meta, "info")) : NULL;
+    if (info == NULL) {
+        return;
+    }
+
+    inv_doc_ctx ctx = { tab, doc };
+    index_string(&ctx, dict_get(info, "name"));
+
+    b_list *files = as_list(dict_get(info, "files"));
+    for (list_node *f = files ? files->list : NULL; f != NULL; f = f->next) {
+        b_dict *file = as_dict(f->object);
+        b_list *path = file ? as_list(dict_get(file, "path")) : NULL;
+        for (list_node *p = path ? path->list : NULL; p != NULL; p = p->next) {
+            index_string(&ctx, p->object);
+        }
+    }
+}
+
+
+/* ============================================================================
+ * HELPER: costruzione parallela
+ * ============================================================================
+ */
+
+typedef struct {
+    b_obj *const *docs;
+    uint32_t from, to;
+    inv_table tab;
+} inv_job;
+
+static void* inv_worker(void *arg) {
+    inv_job *job = arg;
+    table_init(&job->tab);
+    for (uint32_t d = job->from; d < job->to; d++) {
+        if (job->docs[d] != NULL) {
+            index_doc(&job->tab, job->docs[d], d);
+        }
+    }
+    return NULL;
+}
+
+typedef struct {
+    const char *ptr;
+    uint32_t len;
+    const inv_term *term;
+} inv_sorted;
+
+static int cmp_terms(const void *x, const void *y) {
+    const inv_sorted *a = x, *b = y;
+    size_t min = a->len < b->len ? a->len : b->len;
+    int cmp = memcmp(a->ptr, b->ptr, min);
+    if (cmp == 0) {
+        cmp = (a->len > b->len) - (a->len < b->len);
+    }
+    return cmp;
+}
+
+static size_t put_varint(unsigned char *dst, uint32_t v) {
+    size_t n = 0;
+    while (v >= 0x80) {
+        dst[n++] = (unsigned char)(v | 0x80);
+        v >>= 7;
+    }
+    dst[n++] = (unsigned char)v;
+    return n;
+}
+
+
+/* ============================================================================
+ * FUNZIONI: costruzione
+ * ============================================================================
+ */
+
+/**
+ * @brief Costruisce l'indice
+ *
+ * Algoritmo:
+ *   1. Ogni thread indicizza un intervallo contiguo di documenti
+ *   2. Le tabelle dei thread si fondono in ordine: le liste si concatenano
+ *   3. Termini ordinati, liste codificate come differenze in varint
+ */
+b_inv_index* b_inv_build(b_obj *const *docs, uint32_t n_docs, int n_threads) {
+
+    /* Input validation */
+    if(docs == NULL && n_docs > 0){
+        fprintf(stderr, "Error! NULL pointer parsed in function b_inv_build()! ");
+        exit(-1);
+    }
+
+    long threads = n_threads > 0 ? n_threads : sysconf(_SC_NPROCESSORS_ONLN);
+    if (threads < 1) {
+        threads = 1;
+    }
+    if ((uint32_t)threads > n_docs) {
+        threads = n_docs ? (long)n_docs : 1;
+    }
+
+    inv_job *jobs = malloc(sizeof(inv_job) * (size_t)threads);
+    pthread_t *tids = malloc(sizeof(pthread_t) * (size_t)threads);
+    if (jobs == NULL || tids == NULL) {
+        fprintf(stderr, "Malloc failed in function b_inv_build!\n");
+        exit(-1);
+    }
+    for (long t = 0; t < threads; t++) {
+        jobs[t].docs = docs;
+        jobs[t].from = (uint32_t)((uint64_t)n_docs * (uint64_t)t / (uint64_t)threads);
+        jobs[t].to = (uint32_t)((uint64_t)n_docs * (uint64_t)(t + 1) / (uint64_t)threads);
+    }
+    for (long t = 1; t < threads; t++) {
+        if (pthread_create(&tids[t], NULL, inv_worker, &jobs[t]) != 0) {
+            fprintf(stderr, "Error! pthread_create failed in function b_inv_build!\n");
+            exit(-1);
+        }
+    }
+    inv_worker(&jobs[0]);
+    for (long t = 1; t < threads; t++) {
+        pthread_join(tids[t], NULL);
+    }
+
+    /* Fusione nell'ordine dei thread: gli id restano crescenti */
+    inv_table merged;
+    table_init(&merged);
+    for (long t = 0; t < threads; t++) {
+        inv_table *tab = &jobs[t].tab;
+        for (size_t s = 0; s < tab->cap; s++) {
+            inv_term *src = &tab->slots[s];
+            if (src->docs == NULL) {
+                continue;
+            }
+            inv_term *dst = table_get(&merged, tab->chars + src->off, src->len, src->hash);
+            term_append(dst, src->docs, src->n);
+        }
+        table_free(tab);
+    }
+    free(jobs);
+    free(tids);
+
+    inv_sorted *sorted = malloc((merged.used ? merged.used : 1) * sizeof(inv_sorted));
+    if (sorted == NULL) {
+        fprintf(stderr, "Malloc failed in function b_inv_build!\n");
+        exit(-1);
+    }
+    size_t n_terms = 0;
+    size_t total_docs = 0;
+    for (size_t s = 0; s < merged.cap; s++) {
+        const inv_term *t = &merged.slots[s];
+        if (t->docs != NULL) {
+            sorted[n_terms].ptr = merged.chars + t->off;
+            sorted[n_terms].len = t->len;
+            sorted[n_terms].term = t;
+            n_terms++;
+            total_docs += t->n;
+        }
+    }
+    qsort(sorted, n_terms, sizeof(inv_sorted), cmp_terms);
+
+    b_inv_index *idx = malloc(sizeof(b_inv_index));
+    if (idx == NULL) {
+        fprintf(stderr, "Malloc failed in function b_inv_build!\n");
+        exit(-1);
+    }
+    idx->n_terms = n_terms;
+    idx->n_docs = n_docs;
+    idx->terms = malloc(merged.chars_len ? merged.chars_len : 1);
+    idx->term_off = malloc((n_terms + 1) * sizeof(uint32_t));
+    idx->post_off = malloc((n_terms + 1) * sizeof(uint64_t));
+    idx->doc_freq = malloc((n_terms ? n_terms : 1) * sizeof(uint32_t));
+    /* Al più 5 byte per id: il blocco si restringe alla fine */
+    unsigned char *postings = malloc(total_docs * 5 + 1);
+    if (idx->terms == NULL || idx->term_off == NULL || idx->post_off == NULL ||
+        idx->doc_freq == NULL || postings == NULL) {
+        fprintf(stderr, "Malloc failed in function b_inv_build!\n");
+        exit(-1);
+    }
+
+    size_t chars = 0, bytes = 0;
+    for (size_t i = 0; i < n_terms; i++) {
+        const inv_term *t = sorted[i].term;
+        idx->term_off[i] = (uint32_t)chars;
+        idx->post_off[i] = bytes;
+        idx->doc_freq[i] = t->n;
+        memcpy(idx->terms + chars, sorted[i].ptr, sorted[i].len);
+        chars += sorted[i].len;
+
+        uint32_t prev = 0;
+        for (uint32_t k = 0; k < t->n; k++) {
+            bytes += put_varint(postings + bytes, t->docs[k] - prev);
+            prev = t->docs[k];
+        }
+    }
+    idx->term_off[n_terms] = (uint32_t)chars;
+    idx->post_off[n_terms] = bytes;
+
+    unsigned char *shrunk = realloc(postings, bytes ? bytes : 1);
+    idx->postings = shrunk ? shrunk : postings;
+
+    free(sorted);
+    table_free(&merged);
+    return idx;
+}
+
+void b_inv_free(b_inv_index *idx) {
+    if (idx == NULL) {
+        return;
+    }
+    free(idx->terms);
+    free(idx->term_off);
+    free(idx->post_off);
+    free(idx->doc_freq);
+    free(idx->postings);
+    free(idx);
+}
+
+
+/* ============================================================================
+ * HELPER: liste e intersezione
+ * ============================================================================
+ */
+
+/* Ricerca binaria del termine: indice oppure -1 */
+static ssize_t find_term(const b_inv_index *idx, const char *term, size_t len) {
+    size_t lo = 0, hi = idx->n_terms;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        size_t mlen = idx->term_off[mid + 1] - idx->term_off[mid];
+        size_t min = mlen < len ? mlen : len;
+        int cmp = memcmp(idx->terms + idx->term_off[mid], term, min);
+        if (cmp == 0) {
+            cmp = (mlen > len) - (mlen < len);
+        }
+        if (cmp == 0) {
+            return (ssize_t)mid;
+        }
+        if (cmp < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return -1;
+}
+
+static uint32_t* decode_postings(const b_inv_index *idx, size_t term) {
+    uint32_t n = idx->doc_freq[term];
+    uint32_t *docs = malloc((n ? n : 1) * sizeof(uint32_t));
+    if (docs == NULL) {
+        fprintf(stderr, "Malloc failed in function decode_postings!\n");
+        exit(-1);
+    }
+
+    const unsigned char *p = idx->postings + idx->post_off[term];
+    uint32_t prev = 0;
+    for (uint32_t k = 0; k < n; k++) {
+        uint32_t v = 0;
+        unsigned shift = 0;
+        while (*p & 0x80) {
+            v |= (uint32_t)(*p++ & 0x7f) << shift;
+            shift += 7;
+        }
+        v |= (uint32_t)*p++ << shift;
+        prev += v;
+        docs[k] = prev;
+    }
+    return docs;
+}
+
+/**
+ * @brief Intersezione di due liste crescenti senza duplicati
+ *
+ * out può coincidere con a: si scrive sempre in una posizione già letta.
+ * Con SSE2 si confrontano 4 id di a con 4 id di b (b ruotato tre volte) e
+ * si avanza il blocco con il massimo minore, o entrambi.
+ */
+static size_t intersect(const uint32_t *a, size_t na, const uint32_t *b, size_t nb, uint32_t *out) {
+    size_t i = 0, j = 0, k = 0;
+
+#ifdef B_INV_SSE2
+    while (i + 4 <= na && j + 4 <= nb) {
+        __m128i va = _mm_loadu_si128((const __m128i *)(a + i));
+        __m128i vb = _mm_loadu_si128((const __m128i *)(b + j));
+        __m128i eq = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi32(va, vb),
+                         _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, 0x39))),
+            _mm_or_si128(_mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, 0x4e)),
+                         _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, 0x93))));
+        int mask = _mm_movemask_ps(_mm_castsi128_ps(eq));
+
+        uint32_t amax = a[i + 3];
+        uint32_t bmax = b[j + 3];
+        for (int bit = 0; bit < 4; bit++) {
+            if (mask & (1 << bit)) {
+                out[k++] = a[i + bit];
+            }
+        }
+        if (amax <= bmax) {
+            i += 4;
+        }
+        if (bmax <= amax) {
+            j += 4;
+        }
+    }
+#endif
+
+    while (i < na && j < nb) {
+        if (a[i] < b[j]) {
+            i++;
+        } else if (a[i] > b[j]) {
+            j++;
+        } else {
+            out[k++] = a[i];
+            i++;
+            j++;
+        }
+    }
+    return k;
+}
+
+
+/* ============================================================================
+ * FUNZIONI: ricerca
+ * ============================================================================
+ */
+
+size_t b_inv_postings(const b_inv_index *idx, const char *term, size_t len, uint32_t **docs) {
+
+    /* Input validation */
+    if(idx == NULL || docs == NULL || (term == NULL && len > 0)){
+        fprintf(stderr, "Error! NULL pointer parsed in function b_inv_postings()! ");
+        exit(-1);
+    }
+
+    ssize_t t = find_term(idx, term, len);
+    if (t < 0) {
+        *docs = NULL;
+        return 0;
+    }
+    *docs = decode_postings(idx, (size_t)t);
+    return idx->doc_freq[t];
+}
+
+typedef struct {
+    const b_inv_index *idx;
+    size_t *terms;
+    size_t n;
+    size_t cap;
+    int missing;
+} inv_query;
+
+static void emit_query_term(void *arg, const char *term, size_t len) {
+    inv_query *q = arg;
+    ssize_t t = find_term(q->idx, term, len);
+    if (t < 0) {
+        q->missing = 1;
+        return;
+    }
+    if (q->n == q->cap) {
+        q->cap = q->cap ? q->cap * 2 : 8;
+        size_t *grown = realloc(q->terms, q->cap * sizeof(size_t));
+        if (grown == NULL) {
+            fprintf(stderr, "Malloc failed in function b_inv_search!\n");
+            exit(-1);
+        }
+        q->terms = grown;
+    }
+    q->terms[q->n++] = (size_t)t;
+}
+
+/**
+ * @brief AND dei termini, dalla lista più corta: il risultato non cresce mai
+ */
+size_t b_inv_search(const b_inv_index *idx, const char *query, uint32_t **docs) {
+
+    /* Input validation */
+    if(idx == NULL || query == NULL || docs == NULL){
+        fprintf(stderr, "Error! NULL pointer parsed in function b_inv_search()! ");
+        exit(-1);
+    }
+
+    *docs = NULL;
+    inv_query q = { idx, NULL, 0, 0, 0 };
+    tokenize(query, strlen(query), emit_query_term, &q);
+    if (q.missing || q.n == 0) {
+        free(q.terms);
+        return 0;
+    }
+
+    /* Ordinamento per frequenza crescente (pochi termini: inserzione) */
+    for (size_t i = 1; i < q.n; i++) {
+        size_t t = q.terms[i], j = i;
+        while (j > 0 && idx->doc_freq[q.terms[j - 1]] > idx->doc_freq[t]) {
+            q.terms[j] = q.terms[j - 1];
+            j--;
+        }
+        q.terms[j] = t;
+    }
+
+    uint32_t *result = decode_postings(idx, q.terms[0]);
+    size_t n = idx->doc_freq[q.terms[0]];
+    for (size_t i = 1; i < q.n && n > 0; i++) {
+        if (q.terms[i] == q.terms[i - 1]) {
+            continue;
+        }
+        uint32_t *other = decode_postings(idx, q.terms[i]);
+        n = intersect(result, n, other, idx->doc_freq[q.terms[i]], result);
+        free(other);
+    }
+    free(q.terms);
+
+    if (n == 0) {
+        free(result);
+        return 0;
+    }
+    *docs = result;
+    return n;
+}
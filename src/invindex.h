@@ -0,0 +1,114 @@
+#ifndef INVINDEX_H
+#define INVINDEX_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "structs.h"
+
+/* ============================================================================
+ * PANORAMICA: Indice invertito su nomi e percorsi dei torrent
+ * ============================================================================
+ *
+ * Per le installazioni medie la ricerca per nome non richiede un motore
+ * esterno: da ogni albero decodificato (decode_dict(), pdecode) si estraggono
+ * info.name e info.files[*].path, si dividono in termini e si costruisce
+ * termine → lista ordinata degli id dei documenti.
+ *
+ * Termini: sequenze di lettere e cifre ASCII (in minuscolo) e di byte
+ * >= 0x80, così le parole UTF-8 restano intere. Tutto il resto separa.
+ *
+ * Memoria:
+ *   - Termini ordinati e concatenati in un unico blocco, con offset a 32 bit
+ *   - Liste come differenze tra id consecutivi in varint (LEB128): un id
+ *     costa in media 1-2 byte invece di 4
+ *
+ * Costruzione parallela: ogni thread indicizza un intervallo contiguo di
+ * documenti in una propria tabella, poi le tabelle si fondono nell'ordine
+ * dei thread (le liste restano ordinate senza riordinarle).
+ *
+ * Ricerca: i termini della query in AND, dalla lista più corta;
+ * l'intersezione confronta blocchi di 4 id contro 4 con SSE2 dove
+ * disponibile.
+ *
+ * ============================================================================
+ */
+
+#define B_INV_MAX_TERM   64   /* Termini più lunghi sono ignorati */
+
+
+/* ============================================================================
+ * STRUCT: indice
+ * ============================================================================
+ */
+
+/**
+ * @struct b_inv_index
+ * @brief Indice invertito compresso e immutabile
+ *
+ * Campi:
+ * - terms:     termini ordinati, concatenati (senza terminatori)
+ * - term_off:  il termine i è terms[term_off[i] .. term_off[i + 1])
+ * - post_off:  la sua lista è postings[post_off[i] .. post_off[i + 1])
+ * - doc_freq:  numero di documenti che contengono il termine i
+ * - postings:  differenze tra id in varint
+ */
+typedef struct {
+    char *terms;
+    uint32_t *term_off;
+    uint64_t *post_off;
+    uint32_t *doc_freq;
+    unsigned char *postings;
+    size_t n_terms;
+    uint32_t n_docs;
+} b_inv_index;
+
+
+/* ============================================================================
+ * FUNZIONI: costruzione
+ * ============================================================================
+ */
+
+/**
+ * @brief Indicizza n_docs metafile decodificati (l'id è la posizione in docs)
+ *
+ * I documenti senza dizionario info o senza nome contribuiscono solo con
+ * ciò che hanno; gli elementi NULL sono saltati.
+ *
+ * @param n_threads Thread da usare (0 = core disponibili)
+ */
+b_inv_index* b_inv_build(b_obj *const *docs, uint32_t n_docs, int n_threads);
+
+/**
+ * @brief Libera l'indice
+ */
+void b_inv_free(b_inv_index *idx);
+
+
+/* ============================================================================
+ * FUNZIONI: ricerca
+ * ============================================================================
+ */
+
+/**
+ * @brief Documenti che contengono il termine (già in minuscolo)
+ *
+ * @param docs Riempito con l'array degli id (da liberare con free()), NULL se assente
+ *
+ * @return Numero di documenti
+ */
+size_t b_inv_postings(const b_inv_index *idx, const char *term, size_t len, uint32_t **docs);
+
+/**
+ * @brief Documenti che contengono tutti i termini della query
+ *
+ * La query è divisa in termini come i nomi indicizzati.
+ *
+ * @param docs Riempito con gli id ordinati (da liberare con free()), NULL se nessuno
+ *
+ * @return Numero di documenti
+ */
+size_t b_inv_search(const b_inv_index *idx, const char *query, uint32_t **docs);
+
+
+#endif  /* INVINDEX_H */
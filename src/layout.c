@@ -0,0 +1,246 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "layout.h"
+#include "structs.h"
+#include "number.h"
+
+/* ============================================================================
+ * HELPER: lettura dei campi del metainfo
+ * ============================================================================
+ */
+
+/**
+ * @brief Legge il valore di una chiave intera non negativa
+ *
+ * @return 0 se la chiave esiste ed è un B_INT >= 0, -1 altrimenti
+ */
+static int get_length_field(b_dict *dict, const char *key, int64_t *out) {
+    b_obj *val = dict_get(dict, key);
+    if (val == NULL || get_object_type(val) != B_INT) {
+        return -1;
+    }
+
+    const char *digits = val->object->int_str->decoded_element;
+    int64_t v;
+    if (b_parse_i64(digits, strlen(digits), &v) != B_NUM_OK || v < 0) {
+        return -1;
+    }
+
+    *out = v;
+    return 0;
+}
+
+
+/* ============================================================================
+ * FUNZIONI: costruzione e deallocazione
+ * ============================================================================
+ */
+
+/**
+ * @brief Costruisce l'indice di layout dal dizionario info decodificato
+ *
+ * Algoritmo:
+ *   1. Legge "piece length"
+ *   2. Se esiste "files": conta i file, poi scorre la lista una sola volta
+ *      accumulando le lunghezze in offsets[] (somme prefisse)
+ *   3. Altrimenti usa "length" e "name" come unico file
+ *   4. n_pieces = ceil(totale / piece_length)
+ *
+ * Complessità: O(n) dove n è il numero di file
+ */
+b_layout* layout_build(b_dict *info) {
+
+    /* Input validation */
+    if(info == NULL){
+        fprintf(stderr, "Error! NULL pointer parsed in function layout_build()! ");
+        exit(-1);
+    }
+
+    int64_t piece_length;
+    if (get_length_field(info, "piece length", &piece_length) < 0 || piece_length == 0) {
+        fprintf(stderr, "Errore! 'piece length' mancante o non valido in layout_build!\n");
+        return NULL;
+    }
+
+    b_obj *files = dict_get(info, "files");
+    size_t n_files = 1;
+
+    if (files != NULL) {
+        if (get_object_type(files) != B_LIS) {
+            fprintf(stderr, "Errore! 'files' non è una lista in layout_build!\n");
+            return NULL;
+        }
+        n_files = 0;
+        for (list_node *n = files->object->list->list; n != NULL; n = n->next) {
+            n_files++;
+        }
+    }
+
+    b_layout *layout = malloc(sizeof(b_layout));
+    int64_t *offsets = malloc(sizeof(int64_t) * (n_files + 1));
+    b_obj **paths = malloc(sizeof(b_obj*) * (n_files > 0 ? n_files : 1));
+    if (layout == NULL || offsets == NULL || paths == NULL) {
+        fprintf(stderr, "Malloc failed in function layout_build!\n");
+        exit(-1);
+    }
+
+    layout->n_files = n_files;
+    layout->offsets = offsets;
+    layout->paths = paths;
+    layout->piece_length = piece_length;
+    offsets[0] = 0;
+
+    if (files != NULL) {
+        /* ===== MULTI-FILE: somme prefisse sulle lunghezze di info.files ===== */
+        size_t f = 0;
+        for (list_node *n = files->object->list->list; n != NULL; n = n->next, f++) {
+            int64_t len;
+            if (get_list_node_type(n) != B_DICT ||
+                get_length_field(n->object->object->dict, "length", &len) < 0 ||
+                offsets[f] > INT64_MAX - len) {
+                fprintf(stderr, "Errore! Voce %zu di 'files' malformata in layout_build!\n", f);
+                layout_free(layout);
+                return NULL;
+            }
+            offsets[f + 1] = offsets[f] + len;
+            paths[f] = dict_get(n->object->object->dict, "path");
+        }
+    } else {
+        /* ===== SINGLE-FILE: un solo file lungo info.length ===== */
+        int64_t len;
+        if (get_length_field(info, "length", &len) < 0) {
+            fprintf(stderr, "Errore! Né 'files' né 'length' presenti in layout_build!\n");
+            layout_free(layout);
+            return NULL;
+        }
+        offsets[1] = len;
+        paths[0] = dict_get(info, "name");
+    }
+
+    int64_t total = offsets[n_files];
+    layout->n_pieces = (size_t)(total / piece_length + (total % piece_length != 0));
+
+    return layout;
+}
+
+void layout_free(b_layout *layout) {
+
+    /* Input validation */
+    if(layout == NULL){
+        fprintf(stderr, "Error! NULL pointer parsed in function layout_free()! ");
+        exit(-1);
+    }
+
+    free(layout->offsets);
+    free(layout->paths);
+    free(layout);
+}
+
+
+/* ============================================================================
+ * FUNZIONI: query
+ * ============================================================================
+ */
+
+int64_t layout_total_length(const b_layout *layout) {
+    return layout->offsets[layout->n_files];
+}
+
+int64_t layout_file_length(const b_layout *layout, size_t file) {
+    return layout->offsets[file + 1] - layout->offsets[file];
+}
+
+/**
+ * @brief File che contiene il byte globale offset
+ *
+ * Cerca l'ultimo f con offsets[f] <= offset (upper bound - 1): tra più file
+ * che iniziano allo stesso offset (file vuoti) viene scelto l'ultimo, cioè
+ * l'unico che contiene davvero il byte.
+ *
+ * Complessità: O(log n)
+ */
+size_t layout_file_at(const b_layout *layout, int64_t offset) {
+    if (offset < 0 || offset >= layout_total_length(layout)) {
+        return layout->n_files;
+    }
+
+    size_t lo = 0, hi = layout->n_files;  /* Invariante: offsets[lo] <= offset < offsets[hi] */
+    while (hi - lo > 1) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (layout->offsets[mid] <= offset) {
+            lo = mid;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+size_t layout_piece_of(const b_layout *layout, size_t file, int64_t file_offset) {
+    if (file >= layout->n_files || file_offset < 0 ||
+        file_offset >= layout_file_length(layout, file)) {
+        return layout->n_pieces;
+    }
+    return (size_t)((layout->offsets[file] + file_offset) / layout->piece_length);
+}
+
+void layout_file_pieces(const b_layout *layout, size_t file, size_t *first, size_t *last) {
+    int64_t start = layout->offsets[file];
+    int64_t end = layout->offsets[file + 1];
+
+    if (start == end) {
+        *first = *last = (size_t)(start / layout->piece_length);
+        return;
+    }
+    *first = (size_t)(start / layout->piece_length);
+    *last = (size_t)((end - 1) / layout->piece_length) + 1;
+}
+
+void layout_piece_iter(const b_layout *layout, size_t piece, b_layout_iter *it) {
+    int64_t total = layout_total_length(layout);
+
+    it->layout = layout;
+    if (piece >= layout->n_pieces) {
+        /* Prima della moltiplicazione: piece * piece_length andrebbe in overflow */
+        it->pos = it->end = total;
+    } else {
+        it->pos = (int64_t)piece * layout->piece_length;
+        it->end = it->pos + layout->piece_length;
+        if (it->end > total) {
+            it->end = total;  /* Ultimo pezzo più corto */
+        }
+    }
+    it->file = layout_file_at(layout, it->pos);
+}
+
+/**
+ * @brief Restituisce la prossima porzione di file del pezzo
+ *
+ * Dopo la ricerca binaria iniziale (in layout_piece_iter) l'avanzamento è
+ * lineare: i file successivi sono contigui, quelli vuoti vengono saltati.
+ */
+int layout_iter_next(b_layout_iter *it, b_file_slice *slice) {
+    const b_layout *l = it->layout;
+
+    if (it->pos >= it->end) {
+        return 0;
+    }
+
+    /* Salta i file di lunghezza zero */
+    while (l->offsets[it->file + 1] <= it->pos) {
+        it->file++;
+    }
+
+    int64_t file_end = l->offsets[it->file + 1];
+    int64_t stop = file_end < it->end ? file_end : it->end;
+
+    slice->file = it->file;
+    slice->file_offset = it->pos - l->offsets[it->file];
+    slice->length = stop - it->pos;
+
+    it->pos = stop;
+    return 1;
+}
@@ -0,0 +1,162 @@
+#ifndef LAYOUT_H
+#define LAYOUT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "structs.h"
+
+/* ============================================================================
+ * PANORAMICA: Indice di layout file ↔ pezzi
+ * ============================================================================
+ *
+ * In un torrent il contenuto è la concatenazione di tutti i file di
+ * info.files (o dell'unico file di info.length), diviso in pezzi da
+ * "piece length" byte. Questo modulo costruisce una volta sola, dal
+ * dizionario info decodificato, un array di offset cumulativi:
+ *
+ *   offsets[f]   = byte globale da cui inizia il file f
+ *   offsets[n]   = lunghezza totale del contenuto
+ *
+ * Le domande "quali file copre il pezzo i?" e "in quale pezzo sta il byte X
+ * del file f?" diventano ricerche binarie O(log n) invece di scansioni delle
+ * liste concatenate di b_list/b_dict.
+ *
+ * ============================================================================
+ */
+
+
+/* ============================================================================
+ * STRUCT: indice di layout
+ * ============================================================================
+ */
+
+/**
+ * @struct b_layout
+ * @brief Layout precalcolato del contenuto di un torrent
+ *
+ * Campi:
+ * - n_files:      numero di file (1 per torrent single-file)
+ * - offsets:      n_files + 1 offset cumulativi (somme prefisse delle lunghezze)
+ * - paths:        per ogni file la lista "path" (B_LIS) del metainfo, oppure
+ *                 il B_STR "name" per torrent single-file. Puntano dentro
+ *                 il dizionario info: non sono copie.
+ * - piece_length: valore di "piece length"
+ * - n_pieces:     numero di pezzi (l'ultimo può essere più corto)
+ */
+typedef struct {
+    size_t n_files;
+    int64_t *offsets;
+    b_obj **paths;
+    int64_t piece_length;
+    size_t n_pieces;
+} b_layout;
+
+/**
+ * @struct b_file_slice
+ * @brief Porzione di un file coperta da un pezzo
+ *
+ * - file:        indice del file
+ * - file_offset: offset del primo byte all'interno del file
+ * - length:      numero di byte della porzione
+ */
+typedef struct {
+    size_t file;
+    int64_t file_offset;
+    int64_t length;
+} b_file_slice;
+
+/**
+ * @struct b_layout_iter
+ * @brief Iteratore sulle porzioni di file coperte da un pezzo
+ *
+ * Da inizializzare con layout_piece_iter() e consumare con layout_iter_next().
+ */
+typedef struct {
+    const b_layout *layout;
+    int64_t pos;     /* Prossimo byte globale da restituire */
+    int64_t end;     /* Fine (esclusa) del pezzo */
+    size_t file;     /* File che contiene pos */
+} b_layout_iter;
+
+
+/* ============================================================================
+ * FUNZIONI: costruzione e deallocazione
+ * ============================================================================
+ */
+
+/**
+ * @brief Costruisce l'indice di layout dal dizionario info decodificato
+ *
+ * Supporta torrent multi-file (info.files) e single-file (info.length).
+ *
+ * @param info Dizionario "info" (es. da get_info_dict(root, "info"))
+ *
+ * @return Layout allocato con malloc, da liberare con layout_free();
+ *         NULL se il metainfo è malformato (messaggio su stderr)
+ */
+b_layout* layout_build(b_dict *info);
+
+/**
+ * @brief Libera un layout costruito con layout_build()
+ */
+void layout_free(b_layout *layout);
+
+
+/* ============================================================================
+ * FUNZIONI: query
+ * ============================================================================
+ */
+
+/**
+ * @brief Lunghezza totale del contenuto
+ */
+int64_t layout_total_length(const b_layout *layout);
+
+/**
+ * @brief Lunghezza del file f
+ */
+int64_t layout_file_length(const b_layout *layout, size_t file);
+
+/**
+ * @brief File che contiene il byte globale offset (ricerca binaria)
+ *
+ * I file di lunghezza zero non contengono byte e non vengono mai restituiti.
+ *
+ * @return Indice del file, oppure n_files se offset è fuori dal contenuto
+ */
+size_t layout_file_at(const b_layout *layout, int64_t offset);
+
+/**
+ * @brief Pezzo che contiene il byte file_offset del file f
+ *
+ * @return Indice del pezzo, oppure n_pieces se il byte non esiste
+ */
+size_t layout_piece_of(const b_layout *layout, size_t file, int64_t file_offset);
+
+/**
+ * @brief Intervallo di pezzi [first, last) toccati dal file f
+ *
+ * Per un file di lunghezza zero l'intervallo è vuoto (first == last).
+ */
+void layout_file_pieces(const b_layout *layout, size_t file, size_t *first, size_t *last);
+
+/**
+ * @brief Prepara l'iteratore sulle porzioni di file coperte dal pezzo piece
+ */
+void layout_piece_iter(const b_layout *layout, size_t piece, b_layout_iter *it);
+
+/**
+ * @brief Restituisce la prossima porzione di file del pezzo
+ *
+ * Esempio:
+ *   b_layout_iter it; b_file_slice s;
+ *   layout_piece_iter(layout, 7, &it);
+ *   while (layout_iter_next(&it, &s)) { leggi s.length byte da s.file, s.file_offset }
+ *
+ * @return 1 se slice è stata riempita, 0 a iterazione conclusa
+ */
+int layout_iter_next(b_layout_iter *it, b_file_slice *slice);
+
+
+#endif  /* LAYOUT_H */
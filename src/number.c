@@ -0,0 +1,222 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "number.h"
+
+/* ============================================================================
+ * HELPER: kernel SWAR a 8 cifre
+ * ============================================================================
+ */
+
+/**
+ * @brief Carica 8 byte come parola little-endian
+ */
+static inline uint64_t load8(const char *s) {
+    uint64_t w;
+    memcpy(&w, s, sizeof(w));
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    w = __builtin_bswap64(w);
+#endif
+    return w;
+}
+
+/**
+ * @brief 1 se tutti gli 8 byte della parola sono cifre '0'..'9'
+ *
+ * Un byte b è una cifra se b - 0x30 non va sotto zero e b + 0x46 non
+ * supera 0x7F: in entrambi i casi il bit alto del byte resta a 0.
+ */
+static inline int is_8digits(uint64_t w) {
+    return ((((w + 0x4646464646464646ULL) | (w - 0x3030303030303030ULL)) &
+             0x8080808080808080ULL) == 0);
+}
+
+/**
+ * @brief Valore delle 8 cifre della parola (la prima cifra è il byte basso)
+ *
+ * Tre passi di riduzione: coppie di cifre (×10), coppie di coppie (×100),
+ * coppie di quartine (×10000), gli ultimi due fusi in due moltiplicazioni.
+ */
+static inline uint32_t parse_8digits(uint64_t w) {
+    const uint64_t mask = 0x000000FF000000FFULL;
+    const uint64_t mul1 = 0x000F424000000064ULL;  /* 100 + (1000000 << 32) */
+    const uint64_t mul2 = 0x0000271000000001ULL;  /* 1 + (10000 << 32) */
+
+    w -= 0x3030303030303030ULL;
+    w = (w * 10) + (w >> 8);
+    w = (((w & mask) * mul1) + (((w >> 16) & mask) * mul2)) >> 32;
+    return (uint32_t)w;
+}
+
+
+/* ============================================================================
+ * FUNZIONI: parsing
+ * ============================================================================
+ */
+
+size_t b_scan_digits(const char *s, size_t max) {
+    size_t i = 0;
+
+    while (max - i >= 8 && is_8digits(load8(s + i))) {
+        i += 8;
+    }
+    while (i < max && s[i] >= '0' && s[i] <= '9') {
+        i++;
+    }
+    return i;
+}
+
+/**
+ * @brief Converte len cifre decimali in un uint64_t
+ *
+ * Algoritmo:
+ *   1. Blocchi da 8 cifre: v = v * 10^8 + parse_8digits()
+ *   2. Cifre rimanenti una per volta
+ * Ogni moltiplicazione/somma controlla l'overflow: un uint64_t ha al più
+ * 20 cifre, quindi i controlli scattano al massimo sull'ultimo blocco.
+ */
+int b_parse_u64(const char *s, size_t len, uint64_t *out) {
+
+    /* Input validation */
+    if(s == NULL || out == NULL){
+        fprintf(stderr, "Error! NULL pointer parsed in function b_parse_u64()! ");
+        exit(-1);
+    }
+
+    if (len == 0) {
+        return B_NUM_INVALID;
+    }
+
+    uint64_t v = 0;
+    size_t i = 0;
+    int overflow = 0;
+
+    while (len - i >= 8) {
+        uint64_t w = load8(s + i);
+        if (!is_8digits(w)) {
+            return B_NUM_INVALID;
+        }
+        overflow |= __builtin_mul_overflow(v, 100000000ULL, &v);
+        overflow |= __builtin_add_overflow(v, parse_8digits(w), &v);
+        i += 8;
+    }
+    for (; i < len; i++) {
+        unsigned int d = (unsigned char)s[i] - '0';
+        if (d > 9) {
+            return B_NUM_INVALID;
+        }
+        overflow |= __builtin_mul_overflow(v, 10ULL, &v);
+        overflow |= __builtin_add_overflow(v, d, &v);
+    }
+
+    if (overflow) {
+        return B_NUM_OVERFLOW;
+    }
+    *out = v;
+    return B_NUM_OK;
+}
+
+int b_parse_i64(const char *s, size_t len, int64_t *out) {
+
+    /* Input validation */
+    if(s == NULL || out == NULL){
+        fprintf(stderr, "Error! NULL pointer parsed in function b_parse_i64()! ");
+        exit(-1);
+    }
+
+    int negative = (len > 0 && s[0] == '-');
+    const char *digits = s + negative;
+    size_t n = len - negative;
+
+    /* Zeri iniziali e "-0" non sono bencode valido */
+    if (n == 0 || (digits[0] == '0' && (n > 1 || negative))) {
+        return B_NUM_INVALID;
+    }
+
+    uint64_t mag;
+    int rc = b_parse_u64(digits, n, &mag);
+    if (rc != B_NUM_OK) {
+        return rc;
+    }
+
+    if (negative) {
+        if (mag > (uint64_t)INT64_MAX + 1) {
+            return B_NUM_OVERFLOW;
+        }
+        *out = (int64_t)(0 - mag);
+    } else {
+        if (mag > (uint64_t)INT64_MAX) {
+            return B_NUM_OVERFLOW;
+        }
+        *out = (int64_t)mag;
+    }
+    return B_NUM_OK;
+}
+
+
+/* ============================================================================
+ * FUNZIONI: formattazione
+ * ============================================================================
+ */
+
+/**
+ * @brief Numero di cifre decimali di v (senza salti condizionali)
+ *
+ * bits = bit significativi di v (almeno 1): le cifre sono
+ * floor(bits * log10(2)) oppure uno in più. t = (bits * 1233) >> 12 è la
+ * stima per difetto; v >= powers[t] aggiunge la cifra mancante.
+ * powers[0] = 0 così v = 0 ha una cifra.
+ */
+unsigned int b_digits_u64(uint64_t v) {
+    static const uint64_t powers[20] = {
+        0ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL,
+        10000000ULL, 100000000ULL, 1000000000ULL, 10000000000ULL,
+        100000000000ULL, 1000000000000ULL, 10000000000000ULL,
+        100000000000000ULL, 1000000000000000ULL, 10000000000000000ULL,
+        100000000000000000ULL, 1000000000000000000ULL, 10000000000000000000ULL
+    };
+    unsigned int bits = 64 - (unsigned int)__builtin_clzll(v | 1);
+    unsigned int t = (bits * 1233) >> 12;
+    return t + (v >= powers[t]);
+}
+
+/**
+ * @brief Scrive v in decimale in dst (senza '\0')
+ *
+ * Con il numero di cifre noto si scrive da destra: ogni divisione per 100
+ * produce due cifre copiate dalla tabella, l'eventuale cifra dispari
+ * iniziale è scritta a parte.
+ */
+size_t b_format_u64(char *dst, uint64_t v) {
+    static const char pairs[201] =
+        "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+        "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+        "8081828384858687888990919293949596979899";
+
+    unsigned int digits = b_digits_u64(v);
+    char *p = dst + digits;
+
+    while (v >= 100) {
+        unsigned int r = (unsigned int)(v % 100);
+        v /= 100;
+        p -= 2;
+        memcpy(p, &pairs[r * 2], 2);
+    }
+    if (v >= 10) {
+        p -= 2;
+        memcpy(p, &pairs[v * 2], 2);
+    } else {
+        *--p = (char)('0' + v);
+    }
+    return digits;
+}
+
+size_t b_format_i64(char *dst, int64_t v) {
+    if (v < 0) {
+        dst[0] = '-';
+        return 1 + b_format_u64(dst + 1, 0 - (uint64_t)v);
+    }
+    return b_format_u64(dst, (uint64_t)v);
+}
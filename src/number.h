@@ -0,0 +1,99 @@
+#ifndef NUMBER_H
+#define NUMBER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* ============================================================================
+ * PANORAMICA: Parsing e formattazione veloce degli interi
+ * ============================================================================
+ *
+ * Gli interi compaiono ovunque nel bencode: valori "i<n>e" e lunghezze
+ * "<n>:" di ogni bytestring. Questo modulo sostituisce atoi()/strtoll()/
+ * snprintf() con kernel dedicati, condivisi da decoder, encoder e calcolo
+ * delle dimensioni:
+ *
+ *   - PARSING SWAR: 8 byte vengono caricati in una parola a 64 bit,
+ *     verificati come cifre con due somme e una maschera, e convertiti con
+ *     tre moltiplicazioni invece di 8 iterazioni. Overflow rilevato con
+ *     __builtin_*_overflow
+ *   - FORMATTAZIONE: due cifre per volta da una tabella "00".."99",
+ *     scritte da destra conoscendo già il numero di cifre
+ *   - CONTEGGIO CIFRE: senza salti condizionali (b_digits_u64)
+ *
+ * Le funzioni non richiedono stringhe null-terminated: lavorano su
+ * (puntatore, lunghezza). Il caricamento a 8 byte avviene solo se ci sono
+ * almeno 8 byte disponibili.
+ *
+ * ============================================================================
+ */
+
+#define B_NUM_OK          0    /* Numero valido */
+#define B_NUM_INVALID    -1    /* Carattere non ammesso, vuoto, zeri iniziali */
+#define B_NUM_OVERFLOW   -2    /* Fuori dall'intervallo del tipo */
+
+#define B_NUM_MAX_CHARS   20   /* Caratteri massimi di un int64 ("-9223372036854775808") */
+
+
+/* ============================================================================
+ * FUNZIONI: parsing
+ * ============================================================================
+ */
+
+/**
+ * @brief Numero di cifre decimali consecutive all'inizio di s (al più max)
+ */
+size_t b_scan_digits(const char *s, size_t max);
+
+/**
+ * @brief Converte len cifre decimali in un uint64_t
+ *
+ * @return B_NUM_OK, B_NUM_INVALID (len = 0 o carattere non cifra),
+ *         B_NUM_OVERFLOW (valore > UINT64_MAX)
+ */
+int b_parse_u64(const char *s, size_t len, uint64_t *out);
+
+/**
+ * @brief Converte il contenuto di un intero bencode (tra 'i' ed 'e')
+ *
+ * Regole bencode: segno '-' opzionale, nessuno zero iniziale, "-0" non
+ * ammesso.
+ *
+ * @return B_NUM_OK, B_NUM_INVALID, B_NUM_OVERFLOW (fuori da int64_t)
+ */
+int b_parse_i64(const char *s, size_t len, int64_t *out);
+
+
+/* ============================================================================
+ * FUNZIONI: formattazione
+ * ============================================================================
+ */
+
+/**
+ * @brief Numero di cifre decimali di v (senza salti condizionali)
+ *
+ * Stima le cifre dal numero di bit significativi (log10(2) ≈ 1233/4096) e
+ * corregge di uno con un confronto su una tabella di potenze di 10.
+ */
+unsigned int b_digits_u64(uint64_t v);
+
+/**
+ * @brief Scrive v in decimale in dst (senza '\0')
+ *
+ * @param dst Almeno b_digits_u64(v) byte
+ *
+ * @return Numero di caratteri scritti
+ */
+size_t b_format_u64(char *dst, uint64_t v);
+
+/**
+ * @brief Scrive v in decimale con segno in dst (senza '\0')
+ *
+ * @param dst Almeno B_NUM_MAX_CHARS byte
+ *
+ * @return Numero di caratteri scritti
+ */
+size_t b_format_i64(char *dst, int64_t v);
+
+
+#endif  /* NUMBER_H */
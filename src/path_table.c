@@ -0,0 +1,376 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "path_table.h"
+#include "structs.h"
+
+/* ============================================================================
+ * HELPER: pool di byte e tabella hash delle directory
+ * ============================================================================
+ */
+
+#define NO_DIR UINT32_MAX
+
+/**
+ * @brief Hash FNV-1a della coppia (parent, nome)
+ */
+static uint32_t dir_hash(uint32_t parent, const char *name, size_t len) {
+    uint32_t h = 2166136261u ^ parent;
+    h *= 16777619u;
+    for (size_t i = 0; i < len; i++) {
+        h ^= (unsigned char)name[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+/**
+ * @brief Copia un nome in coda al pool e ne ritorna l'offset
+ */
+static uint32_t pool_append(b_path_table *t, const char *name, size_t len) {
+    if (t->pool_len + len > t->pool_cap) {
+        size_t cap = t->pool_cap ? t->pool_cap : 4096;
+        while (cap < t->pool_len + len) {
+            cap *= 2;
+        }
+        char *pool = realloc(t->pool, cap);
+        if (pool == NULL) {
+            fprintf(stderr, "Realloc failed in function pool_append!\n");
+            exit(-1);
+        }
+        t->pool = pool;
+        t->pool_cap = cap;
+    }
+    if (t->pool_len + len > UINT32_MAX) {
+        fprintf(stderr, "Errore! Pool dei percorsi oltre 4 GiB!\n");
+        exit(-1);
+    }
+
+    uint32_t off = (uint32_t)t->pool_len;
+    memcpy(t->pool + off, name, len);
+    t->pool_len += len;
+    return off;
+}
+
+/**
+ * @brief Raddoppia la tabella hash e reinserisce tutte le directory
+ */
+static void rehash(b_path_table *t) {
+    size_t n = t->n_buckets ? t->n_buckets * 2 : 1024;
+    uint32_t *buckets = malloc(sizeof(uint32_t) * n);
+    if (buckets == NULL) {
+        fprintf(stderr, "Malloc failed in function rehash!\n");
+        exit(-1);
+    }
+    memset(buckets, 0xFF, sizeof(uint32_t) * n);  /* Tutti i bucket a NO_DIR */
+
+    for (uint32_t d = 0; d < t->n_dirs; d++) {
+        const b_path_entry *e = &t->dirs[d];
+        uint32_t h = dir_hash(e->parent, t->pool + e->name_off, e->name_len) & (n - 1);
+        t->chain[d] = buckets[h];
+        buckets[h] = d;
+    }
+
+    free(t->buckets);
+    t->buckets = buckets;
+    t->n_buckets = n;
+}
+
+uint32_t path_table_find_dir(const b_path_table *table, uint32_t parent, b_span name) {
+    uint32_t h = dir_hash(parent, name.ptr, name.len) & (table->n_buckets - 1);
+
+    for (uint32_t d = table->buckets[h]; d != NO_DIR; d = table->chain[d]) {
+        const b_path_entry *e = &table->dirs[d];
+        if (d != B_PATH_ROOT && e->parent == parent && e->name_len == name.len &&
+            memcmp(table->pool + e->name_off, name.ptr, name.len) == 0) {
+            return d;
+        }
+    }
+    return NO_DIR;
+}
+
+/**
+ * @brief Ritorna la sottodirectory name di parent, creandola se necessario
+ */
+static uint32_t intern_dir(b_path_table *t, uint32_t parent, const char *name, size_t len) {
+    b_span s = { name, len };
+    uint32_t d = path_table_find_dir(t, parent, s);
+    if (d != NO_DIR) {
+        return d;
+    }
+
+    if (t->n_dirs == t->dirs_cap) {
+        size_t cap = t->dirs_cap * 2;
+        b_path_entry *dirs = realloc(t->dirs, sizeof(b_path_entry) * cap);
+        uint32_t *chain = realloc(t->chain, sizeof(uint32_t) * cap);
+        if (dirs == NULL || chain == NULL) {
+            fprintf(stderr, "Realloc failed in function intern_dir!\n");
+            exit(-1);
+        }
+        t->dirs = dirs;
+        t->chain = chain;
+        t->dirs_cap = cap;
+    }
+
+    d = (uint32_t)t->n_dirs++;
+    t->dirs[d].parent = parent;
+    t->dirs[d].name_off = pool_append(t, name, len);
+    t->dirs[d].name_len = (uint32_t)len;
+
+    /* Carico massimo 1: oltre si raddoppia la tabella */
+    if (t->n_dirs > t->n_buckets) {
+        rehash(t);
+    } else {
+        uint32_t h = dir_hash(parent, name, len) & (t->n_buckets - 1);
+        t->chain[d] = t->buckets[h];
+        t->buckets[h] = d;
+    }
+    return d;
+}
+
+/**
+ * @brief Estrae nome e lunghezza da un B_STR, NULL se il tipo è diverso
+ */
+static const char* str_value(b_obj *obj, size_t *len) {
+    if (obj == NULL || get_object_type(obj) != B_STR) {
+        return NULL;
+    }
+    *len = strlen(obj->object->int_str->decoded_element);
+    return obj->object->int_str->decoded_element;
+}
+
+
+/* ============================================================================
+ * FUNZIONI: costruzione e deallocazione
+ * ============================================================================
+ */
+
+/**
+ * @brief Costruisce la tabella dei percorsi dal dizionario info decodificato
+ *
+ * Algoritmo (per ogni voce di info.files):
+ *   1. Parte dalla radice
+ *   2. Per ogni componente di "path" tranne l'ultimo: cerca (dir, nome)
+ *      nella tabella hash, crea la directory solo se non esiste
+ *   3. L'ultimo componente è il nome del file: copiato nel pool
+ *
+ * Complessità: O(c) dove c è il numero totale di componenti
+ */
+b_path_table* path_table_build(b_dict *info) {
+
+    /* Input validation */
+    if(info == NULL){
+        fprintf(stderr, "Error! NULL pointer parsed in function path_table_build()! ");
+        exit(-1);
+    }
+
+    size_t name_len;
+    const char *name = str_value(dict_get(info, "name"), &name_len);
+    if (name == NULL) {
+        fprintf(stderr, "Errore! 'name' mancante o non valido in path_table_build!\n");
+        return NULL;
+    }
+
+    b_obj *files = dict_get(info, "files");
+    if (files != NULL && get_object_type(files) != B_LIS) {
+        fprintf(stderr, "Errore! 'files' non è una lista in path_table_build!\n");
+        return NULL;
+    }
+
+    size_t n_files = 1;
+    if (files != NULL) {
+        n_files = 0;
+        for (list_node *n = files->object->list->list; n != NULL; n = n->next) {
+            n_files++;
+        }
+    }
+
+    b_path_table *t = malloc(sizeof(b_path_table));
+    if (t == NULL) {
+        fprintf(stderr, "Malloc failed in function path_table_build!\n");
+        exit(-1);
+    }
+    memset(t, 0, sizeof(b_path_table));
+
+    t->dirs_cap = 64;
+    t->dirs = malloc(sizeof(b_path_entry) * t->dirs_cap);
+    t->chain = malloc(sizeof(uint32_t) * t->dirs_cap);
+    t->files = malloc(sizeof(b_path_entry) * (n_files > 0 ? n_files : 1));
+    if (t->dirs == NULL || t->chain == NULL || t->files == NULL) {
+        fprintf(stderr, "Malloc failed in function path_table_build!\n");
+        exit(-1);
+    }
+    rehash(t);
+
+    /* Radice: per i torrent single-file il nome appartiene al file, non alla directory */
+    t->n_dirs = 1;
+    t->dirs[B_PATH_ROOT].parent = B_PATH_ROOT;
+    t->dirs[B_PATH_ROOT].name_off = pool_append(t, name, files != NULL ? name_len : 0);
+    t->dirs[B_PATH_ROOT].name_len = files != NULL ? (uint32_t)name_len : 0;
+
+    if (files == NULL) {
+        /* ===== SINGLE-FILE: un solo file chiamato info.name nella radice ===== */
+        t->files[0].parent = B_PATH_ROOT;
+        t->files[0].name_off = pool_append(t, name, name_len);
+        t->files[0].name_len = (uint32_t)name_len;
+        t->n_files = 1;
+        return t;
+    }
+
+    /* ===== MULTI-FILE: deduplica dei prefissi di directory ===== */
+    for (list_node *n = files->object->list->list; n != NULL; n = n->next) {
+        b_obj *path = NULL;
+        if (get_list_node_type(n) == B_DICT) {
+            path = dict_get(n->object->object->dict, "path");
+        }
+        if (path == NULL || get_object_type(path) != B_LIS || path->object->list->list == NULL) {
+            fprintf(stderr, "Errore! Voce %zu di 'files' senza 'path' valido in path_table_build!\n",
+                    t->n_files);
+            path_table_free(t);
+            return NULL;
+        }
+
+        uint32_t dir = B_PATH_ROOT;
+        for (list_node *c = path->object->list->list; c != NULL; c = c->next) {
+            size_t len;
+            const char *comp = str_value(c->object, &len);
+            if (comp == NULL) {
+                fprintf(stderr, "Errore! Componente di 'path' non stringa in path_table_build!\n");
+                path_table_free(t);
+                return NULL;
+            }
+
+            if (c->next != NULL) {
+                dir = intern_dir(t, dir, comp, len);
+            } else {
+                b_path_entry *f = &t->files[t->n_files++];
+                f->parent = dir;
+                f->name_off = pool_append(t, comp, len);
+                f->name_len = (uint32_t)len;
+            }
+        }
+    }
+
+    return t;
+}
+
+void path_table_free(b_path_table *table) {
+
+    /* Input validation */
+    if(table == NULL){
+        fprintf(stderr, "Error! NULL pointer parsed in function path_table_free()! ");
+        exit(-1);
+    }
+
+    free(table->pool);
+    free(table->dirs);
+    free(table->files);
+    free(table->buckets);
+    free(table->chain);
+    free(table);
+}
+
+
+/* ============================================================================
+ * FUNZIONI: query
+ * ============================================================================
+ */
+
+b_span path_table_file_name(const b_path_table *table, size_t file) {
+    b_span s = { table->pool + table->files[file].name_off, table->files[file].name_len };
+    return s;
+}
+
+uint32_t path_table_file_dir(const b_path_table *table, size_t file) {
+    return table->files[file].parent;
+}
+
+b_span path_table_dir_name(const b_path_table *table, uint32_t dir) {
+    b_span s = { table->pool + table->dirs[dir].name_off, table->dirs[dir].name_len };
+    return s;
+}
+
+uint32_t path_table_dir_parent(const b_path_table *table, uint32_t dir) {
+    return table->dirs[dir].parent;
+}
+
+/**
+ * @brief Ricostruisce il percorso completo del file f
+ *
+ * Calcola prima la lunghezza risalendo le directory fino alla radice, poi
+ * scrive i componenti da destra verso sinistra: nessuna allocazione.
+ */
+size_t path_table_format(const b_path_table *table, size_t file, char sep,
+                         char *buf, size_t cap) {
+    const b_path_entry *f = &table->files[file];
+    size_t total = f->name_len;
+
+    for (uint32_t d = f->parent; ; d = table->dirs[d].parent) {
+        if (table->dirs[d].name_len > 0) {
+            total += table->dirs[d].name_len + 1;
+        }
+        if (d == B_PATH_ROOT) {
+            break;
+        }
+    }
+
+    if (cap == 0) {
+        return total;
+    }
+
+    /* Scrittura da destra: ogni byte finisce nel buffer solo se sta in cap - 1 */
+    size_t limit = cap - 1;
+    size_t end = total - f->name_len;
+
+    for (size_t i = 0; i < f->name_len; i++) {
+        if (end + i < limit) {
+            buf[end + i] = table->pool[f->name_off + i];
+        }
+    }
+
+    for (uint32_t d = f->parent; ; d = table->dirs[d].parent) {
+        const b_path_entry *e = &table->dirs[d];
+        if (e->name_len > 0) {
+            end--;
+            if (end < limit) {
+                buf[end] = sep;
+            }
+            end -= e->name_len;
+            for (size_t i = 0; i < e->name_len; i++) {
+                if (end + i < limit) {
+                    buf[end + i] = table->pool[e->name_off + i];
+                }
+            }
+        }
+        if (d == B_PATH_ROOT) {
+            break;
+        }
+    }
+
+    buf[total < limit ? total : limit] = '\0';
+    return total;
+}
+
+size_t path_table_bytes(const b_path_table *table) {
+    return sizeof(b_path_table) + table->pool_cap +
+           (sizeof(b_path_entry) + sizeof(uint32_t)) * table->dirs_cap +
+           sizeof(b_path_entry) * table->n_files +
+           sizeof(uint32_t) * table->n_buckets;
+}
+
+void path_iter_init(b_path_iter *it, const b_path_table *table) {
+    it->table = table;
+    it->next = 0;
+}
+
+int path_iter_next(b_path_iter *it, uint32_t *dir_id, b_span *name) {
+    if (it->next >= it->table->n_files) {
+        return 0;
+    }
+    *dir_id = path_table_file_dir(it->table, it->next);
+    *name = path_table_file_name(it->table, it->next);
+    it->next++;
+    return 1;
+}
@@ -0,0 +1,171 @@
+#ifndef PATH_TABLE_H
+#define PATH_TABLE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "structs.h"
+
+/* ============================================================================
+ * PANORAMICA: Tabella compatta dei percorsi dei file
+ * ============================================================================
+ *
+ * In un torrent multi-file ogni voce di info.files ha un "path" che è una
+ * lista di stringhe: 100k file producono centinaia di migliaia di nodi B_STR,
+ * ognuno con copia codificata e decodificata. La tabella dei percorsi
+ * memorizza invece:
+ *
+ *   - un unico pool contiguo di byte con i nomi (non null-terminated)
+ *   - un albero di directory deduplicate: ogni directory compare una sola
+ *     volta, identificata da (directory padre, nome)
+ *   - per ogni file solo (directory, offset e lunghezza del nome nel pool)
+ *
+ * Esempio: "a/b/x.txt" e "a/b/y.txt" condividono le directory "a" e "a/b".
+ *
+ * La directory 0 (B_PATH_ROOT) è la radice: per i torrent multi-file il suo
+ * nome è info.name, per i single-file è vuoto.
+ *
+ * ============================================================================
+ */
+
+#define B_PATH_ROOT  0u   /* Id della directory radice */
+
+
+/* ============================================================================
+ * STRUCT: tabella dei percorsi
+ * ============================================================================
+ */
+
+/**
+ * @struct b_path_entry
+ * @brief Voce della tabella: una directory o un file
+ *
+ * - parent:   directory che contiene la voce (per la radice: B_PATH_ROOT)
+ * - name_off: offset del nome nel pool
+ * - name_len: lunghezza del nome
+ */
+typedef struct {
+    uint32_t parent;
+    uint32_t name_off;
+    uint32_t name_len;
+} b_path_entry;
+
+/**
+ * @struct b_path_table
+ * @brief Tabella dei percorsi con pool di nomi e directory deduplicate
+ *
+ * Campi:
+ * - pool:     byte dei nomi, concatenati
+ * - dirs:     directory (dirs[0] è la radice)
+ * - files:    file, nello stesso ordine di info.files
+ * - buckets:  tabella hash (parent, nome) → directory, usata in costruzione
+ *             e da path_table_find_dir()
+ * - chain:    catena delle collisioni, parallela a dirs
+ */
+typedef struct {
+    char *pool;
+    size_t pool_len, pool_cap;
+    b_path_entry *dirs;
+    size_t n_dirs, dirs_cap;
+    b_path_entry *files;
+    size_t n_files;
+    uint32_t *buckets;
+    size_t n_buckets;
+    uint32_t *chain;
+} b_path_table;
+
+/**
+ * @struct b_path_iter
+ * @brief Iteratore sui file della tabella: produce (dir_id, nome)
+ */
+typedef struct {
+    const b_path_table *table;
+    size_t next;
+} b_path_iter;
+
+
+/* ============================================================================
+ * FUNZIONI: costruzione e deallocazione
+ * ============================================================================
+ */
+
+/**
+ * @brief Costruisce la tabella dei percorsi dal dizionario info decodificato
+ *
+ * Dopo la costruzione la tabella non dipende più dall'albero b_obj, che può
+ * essere liberato con free_obj().
+ *
+ * @return Tabella allocata con malloc, da liberare con path_table_free();
+ *         NULL se info.files / info.name sono malformati (messaggio su stderr)
+ */
+b_path_table* path_table_build(b_dict *info);
+
+/**
+ * @brief Libera una tabella costruita con path_table_build()
+ */
+void path_table_free(b_path_table *table);
+
+
+/* ============================================================================
+ * FUNZIONI: query
+ * ============================================================================
+ */
+
+/**
+ * @brief Nome (ultimo componente) del file f
+ */
+b_span path_table_file_name(const b_path_table *table, size_t file);
+
+/**
+ * @brief Directory che contiene il file f
+ */
+uint32_t path_table_file_dir(const b_path_table *table, size_t file);
+
+/**
+ * @brief Nome della directory dir
+ */
+b_span path_table_dir_name(const b_path_table *table, uint32_t dir);
+
+/**
+ * @brief Directory padre di dir (la radice è padre di se stessa)
+ */
+uint32_t path_table_dir_parent(const b_path_table *table, uint32_t dir);
+
+/**
+ * @brief Cerca la sottodirectory name di parent
+ *
+ * @return Id della directory, oppure UINT32_MAX se non esiste
+ */
+uint32_t path_table_find_dir(const b_path_table *table, uint32_t parent, b_span name);
+
+/**
+ * @brief Ricostruisce il percorso completo del file f
+ *
+ * Scrive al più cap byte (null-terminated se cap > 0) unendo i componenti
+ * con sep. La radice è inclusa solo se ha un nome.
+ *
+ * @return Lunghezza del percorso completo (senza '\0'); se >= cap il
+ *         risultato è stato troncato, come snprintf()
+ */
+size_t path_table_format(const b_path_table *table, size_t file, char sep,
+                         char *buf, size_t cap);
+
+/**
+ * @brief Byte totali occupati dalla tabella (pool, voci, tabella hash)
+ */
+size_t path_table_bytes(const b_path_table *table);
+
+/**
+ * @brief Inizializza l'iteratore sui file
+ */
+void path_iter_init(b_path_iter *it, const b_path_table *table);
+
+/**
+ * @brief Prossimo file: directory contenitore e nome
+ *
+ * @return 1 se dir_id e name sono stati riempiti, 0 a iterazione conclusa
+ */
+int path_iter_next(b_path_iter *it, uint32_t *dir_id, b_span *name);
+
+
+#endif  /* PATH_TABLE_H */
@@ -0,0 +1,772 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include "pdecode.h"
+#include "schema.h"
+#include "probes.h"
+#include "stats.h"
+
+B_PROBE_SEMAPHORE(decode_start);
+B_PROBE_SEMAPHORE(decode_done);
+B_PROBE_SEMAPHORE(decode_error);
+B_PROBE_SEMAPHORE(arena_grow);
+
+/* ============================================================================
+ * HELPER: arena per thread
+ * ============================================================================
+ */
+
+#define ALIGN8(n)        (((n) + 7) & ~(size_t)7)
+#define PD_CHUNK_SIZE    (1u << 20)
+
+/**
+ * @struct pd_chunk
+ * @brief Blocco di un'arena (i blocchi non vengono mai spostati)
+ */
+typedef struct pd_chunk {
+    struct pd_chunk *next;
+    size_t used, cap;
+    char data[];
+} pd_chunk;
+
+typedef struct {
+    pd_chunk *chunks;
+    uint64_t stamp;     /* verified delle forme codificate (b_obj_encoded()) */
+} pd_arena;
+
+/**
+ * @brief Prende n byte dall'arena (allineati a 8)
+ *
+ * Le richieste grandi (forme codificate lunghe, "pieces") hanno un blocco
+ * dedicato inserito dopo quello corrente, che resta in uso.
+ */
+static void* arena_take(pd_arena *a, size_t n) {
+    n = ALIGN8(n);
+    pd_chunk *c = a->chunks;
+    if (c != NULL && c->cap - c->used >= n) {
+        void *p = c->data + c->used;
+        c->used += n;
+        return p;
+    }
+
+    size_t cap = n > PD_CHUNK_SIZE / 4 ? n : PD_CHUNK_SIZE;
+    pd_chunk *fresh = malloc(sizeof(pd_chunk) + cap);
+    if (fresh == NULL) {
+        fprintf(stderr, "Malloc failed in function bencode_decode_parallel!\n");
+        exit(-1);
+    }
+    fresh->used = n;
+    fresh->cap = cap;
+    B_PROBE2(arena_grow, B_PROBE_PARALLEL, cap);
+    if (c != NULL && cap != PD_CHUNK_SIZE) {
+        fresh->next = c->next;
+        c->next = fresh;
+    } else {
+        fresh->next = c;
+        a->chunks = fresh;
+    }
+    return fresh->data;
+}
+
+static void arena_free(pd_arena *a) {
+    pd_chunk *c = a->chunks;
+    while (c != NULL) {
+        pd_chunk *next = c->next;
+        free(c);
+        c = next;
+    }
+    a->chunks = NULL;
+}
+
+/**
+ * @brief Copia n byte nell'arena aggiungendo '\0'
+ */
+static char* arena_strndup(pd_arena *a, const char *src, size_t n) {
+    char *dst = arena_take(a, n + 1);
+    memcpy(dst, src, n);
+    dst[n] = '\0';
+    return dst;
+}
+
+
+/* ============================================================================
+ * HELPER: decodifica di un valore (input già validato dalla fase 1)
+ * ============================================================================
+ */
+
+static b_obj* new_node(pd_arena *a, B_TYPE type) {
+    b_obj *obj = arena_take(a, sizeof(b_obj));
+    obj->type = type;
+    obj->refs = B_OBJ_REFS_ARENA;
+    obj->object = arena_take(a, sizeof(b_box));
+    return obj;
+}
+
+/**
+ * @brief Decodifica il valore in buf[*pos] e avanza *pos
+ *
+ * @param hex 1 se il valore è una bytestring da memorizzare come B_HEX
+ *            (segue la chiave "pieces", come in decode_dict())
+ */
+static b_obj* decode_value(pd_arena *a, const char *buf, size_t len, size_t *pos, int hex) {
+    size_t start = *pos;
+    char c = buf[start];
+
+    if (c == 'i') {
+        size_t end = (size_t)bencode_read_int(buf, len, start, NULL);
+        b_obj *obj = new_node(a, B_INT);
+        b_element *e = arena_take(a, sizeof(b_element));
+        e->encoded_element = arena_strndup(a, buf + start, end - start);
+        e->decoded_element = arena_strndup(a, buf + start + 1, end - start - 2);
+        e->length = (ssize_t)(end - start);
+        obj->object->int_str = e;
+        *pos = end;
+        return obj;
+    }
+
+    if (c >= '0' && c <= '9') {
+        b_span data;
+        size_t end = (size_t)bencode_read_bytes(buf, len, start, &data);
+        if (hex) {
+            b_obj *obj = new_node(a, B_HEX);
+            b_pieces *p = arena_take(a, sizeof(b_pieces));
+            /* Come decode_string(): length è la forma codificata e il buffer
+             * ha length byte (chi copia il nodo ne legge tanti), il payload
+             * in testa */
+            p->decoded_pieces = arena_take(a, end - start);
+            memcpy(p->decoded_pieces, data.ptr, data.len);
+            memset(p->decoded_pieces + data.len, 0, end - start - data.len);
+            p->length = (ssize_t)(end - start);
+            obj->object->pieces = p;
+            *pos = end;
+            return obj;
+        }
+        b_obj *obj = new_node(a, B_STR);
+        b_element *e = arena_take(a, sizeof(b_element));
+        e->encoded_element = arena_strndup(a, buf + start, end - start);
+        e->decoded_element = arena_strndup(a, data.ptr, data.len);
+        e->length = (ssize_t)(end - start);
+        obj->object->int_str = e;
+        *pos = end;
+        return obj;
+    }
+
+    size_t p = start + 1;
+    if (c == 'l') {
+        b_obj *obj = new_node(a, B_LIS);
+        b_list *l = arena_take(a, sizeof(b_list));
+        list_node **tail = &l->list;
+        while (buf[p] != 'e') {
+            list_node *node = arena_take(a, sizeof(list_node));
+            node->object = decode_value(a, buf, len, &p, 0);
+            *tail = node;
+            tail = &node->next;
+        }
+        *tail = NULL;
+        p++;
+        l->length = (ssize_t)(p - start);
+        l->encoded_list = arena_take(a, p - start);
+        memcpy(l->encoded_list, buf + start, p - start);
+        l->arena = 1;
+        l->mutated = 0;
+        l->verified = a->stamp;
+        obj->object->list = l;
+        *pos = p;
+        return obj;
+    }
+
+    b_obj *obj = new_node(a, B_DICT);
+    b_dict *d = arena_take(a, sizeof(b_dict));
+    dict_node **tail = &d->dict;
+    while (buf[p] != 'e') {
+        dict_node *node = arena_take(a, sizeof(dict_node));
+        size_t key_start = p;
+        node->key = decode_value(a, buf, len, &p, 0);
+        int pieces = (p - key_start == 8 && memcmp(buf + key_start, "6:pieces", 8) == 0);
+        node->value = decode_value(a, buf, len, &p, pieces);
+        *tail = node;
+        tail = &node->next;
+    }
+    *tail = NULL;
+    p++;
+    d->length = (ssize_t)(p - start);
+    d->encoded_dict = arena_take(a, p - start);
+    memcpy(d->encoded_dict, buf + start, p - start);
+    d->arena = 1;
+    d->mutated = 0;
+    d->verified = a->stamp;
+    obj->object->dict = d;
+    *pos = p;
+    return obj;
+}
+
+
+/* ============================================================================
+ * HELPER: fasi 1 e 2
+ * ============================================================================
+ */
+
+/**
+ * @struct pd_root
+ * @brief Blocco della radice: tiene traccia di tutte le arene
+ */
+typedef struct {
+    pd_arena arenas[B_PDECODE_MAX_THREADS];
+    int n_arenas;
+    b_obj root;
+} pd_root;
+
+/**
+ * @struct pd_worker
+ * @brief Lavoro di un thread: elementi [first, last) della radice
+ *
+ * head/tail sono il primo e l'ultimo nodo (list_node o dict_node) del
+ * blocco, per la cucitura finale. Ogni thread copia anche il proprio
+ * tratto della forma codificata della radice. Allineato per evitare false
+ * sharing.
+ */
+typedef struct {
+    const char *buf;
+    size_t len;
+    const size_t *starts;
+    size_t first, last;
+    int is_dict;
+    pd_arena arena;
+    void *head, *tail;
+    char *copy_dst;              /* Forma codificata della radice */
+    size_t copy_from, copy_to;   /* Byte della radice copiati da questo thread */
+    pthread_t thread;
+} __attribute__((aligned(64))) pd_worker;
+
+static void* worker_run(void *arg) {
+    pd_worker *w = arg;
+    w->head = NULL;
+    w->tail = NULL;
+
+    for (size_t i = w->first; i < w->last; i++) {
+        size_t p = w->starts[i];
+        void *node;
+        if (w->is_dict) {
+            dict_node *dn = arena_take(&w->arena, sizeof(dict_node));
+            size_t key_start = p;
+            dn->key = decode_value(&w->arena, w->buf, w->len, &p, 0);
+            int pieces = (p - key_start == 8 && memcmp(w->buf + key_start, "6:pieces", 8) == 0);
+            dn->value = decode_value(&w->arena, w->buf, w->len, &p, pieces);
+            dn->next = NULL;
+            if (w->tail != NULL) {
+                ((dict_node *)w->tail)->next = dn;
+            }
+            node = dn;
+        } else {
+            list_node *ln = arena_take(&w->arena, sizeof(list_node));
+            ln->object = decode_value(&w->arena, w->buf, w->len, &p, 0);
+            ln->next = NULL;
+            if (w->tail != NULL) {
+                ((list_node *)w->tail)->next = ln;
+            }
+            node = ln;
+        }
+        if (w->head == NULL) {
+            w->head = node;
+        }
+        w->tail = node;
+    }
+
+    memcpy(w->copy_dst + w->copy_from, w->buf + w->copy_from, w->copy_to - w->copy_from);
+    return NULL;
+}
+
+/**
+ * @struct pd_starts
+ * @brief Offset di inizio degli elementi (o chiavi) della radice, crescenti
+ */
+typedef struct {
+    size_t *v;
+    size_t n, cap;
+} pd_starts;
+
+static void starts_push(pd_starts *s, size_t pos) {
+    if (s->n == s->cap) {
+        s->cap = s->cap ? s->cap * 2 : 1024;
+        size_t *grown = realloc(s->v, s->cap * sizeof(size_t));
+        if (grown == NULL) {
+            fprintf(stderr, "Malloc failed in function bencode_decode_parallel!\n");
+            exit(-1);
+        }
+        s->v = grown;
+    }
+    s->v[s->n++] = pos;
+}
+
+/**
+ * @brief Salta un elemento della radice (chiave e valore se dizionario)
+ *
+ * @return Offset successivo, oppure un codice B_SCHEMA_* negativo
+ */
+static ssize_t skip_root_elem(const char *buf, size_t len, size_t pos, int is_dict) {
+    if (is_dict) {
+        ssize_t r = bencode_read_bytes(buf, len, pos, NULL);
+        if (r < 0) {
+            return r;
+        }
+        pos = (size_t)r;
+    }
+    return bencode_skip(buf, len, pos);
+}
+
+/**
+ * @struct pd_scan
+ * @brief Fase 1 su un intervallo di byte [from, limit)
+ *
+ * Lo scanner 0 parte dal primo elemento vero. Gli altri non sanno se from
+ * cade dentro una stringa o un elemento annidato: provano una catena di
+ * elementi da from, from + 1, ... e tengono la prima che arriva a limit
+ * senza errori (una 'e' che non è l'ultimo byte conta come errore: chiude
+ * un elemento annidato). Saltare un elemento è deterministico, quindi una
+ * catena che raggiunge una posizione di una catena fallita fallisce a sua
+ * volta: le posizioni fallite sono segnate in una bitmap e ogni byte
+ * dell'intervallo viene visitato al più una volta.
+ *
+ * Ripartire dal byte dopo l'inizio della catena fallita, e non dal punto
+ * dell'errore, evita di perdere tratti interi: cifre seguite da ':' dentro
+ * una stringa (es. "...2014" seguito da "4:name") sembrano una stringa
+ * lunga e fanno saltare molto avanti. Per lo stesso motivo una catena di
+ * meno di PD_SCAN_MIN_CHAIN elementi è tenuta solo se non se ne trova una
+ * più lunga.
+ */
+typedef struct {
+    const char *buf;
+    size_t len, from, limit;
+    int is_dict, exact;
+    pd_starts starts;
+    size_t stop;
+    pthread_t thread;
+} __attribute__((aligned(64))) pd_scan;
+
+#define PD_SCAN_MIN_CHAIN 8
+
+#define PD_FAILED(f, p)   ((f)[(p) >> 3] & (1u << ((p) & 7)))
+#define PD_MARK(f, p)     ((f)[(p) >> 3] |= (unsigned char)(1u << ((p) & 7)))
+
+/**
+ * @brief Catena di elementi da pos fino a limit (failed == NULL: nessun controllo)
+ *
+ * @return 1 se arriva a limit (o alla 'e' finale), 0 se fallisce
+ */
+static int scan_chain(pd_scan *sc, size_t pos, const unsigned char *failed) {
+    sc->starts.n = 0;
+    while (pos < sc->limit && pos < sc->len) {
+        if (sc->buf[pos] == 'e') {
+            sc->stop = pos;
+            return pos == sc->len - 1;  /* Fine della radice solo se ultimo byte */
+        }
+        if (failed != NULL && PD_FAILED(failed, pos - sc->from)) {
+            return 0;
+        }
+        ssize_t r = skip_root_elem(sc->buf, sc->len, pos, sc->is_dict);
+        if (r < 0) {
+            return 0;
+        }
+        starts_push(&sc->starts, pos);
+        pos = (size_t)r;
+    }
+    sc->stop = pos;
+    return 1;
+}
+
+static void* scan_run(void *arg) {
+    pd_scan *sc = arg;
+
+    if (sc->exact) {
+        size_t pos = sc->from;
+        while (pos < sc->limit && pos < sc->len && sc->buf[pos] != 'e') {
+            ssize_t r = skip_root_elem(sc->buf, sc->len, pos, sc->is_dict);
+            if (r < 0) {
+                break;
+            }
+            starts_push(&sc->starts, pos);
+            pos = (size_t)r;
+        }
+        sc->stop = pos;
+        return NULL;
+    }
+
+    unsigned char *failed = calloc((sc->limit - sc->from) / 8 + 1, 1);
+    if (failed == NULL) {
+        fprintf(stderr, "Malloc failed in function bencode_decode_parallel!\n");
+        exit(-1);
+    }
+
+    size_t short_try = SIZE_MAX;    /* Prima catena corta arrivata a limit */
+    int found = 0;
+    for (size_t try = sc->from; try < sc->limit; try++) {
+        int ok = scan_chain(sc, try, failed);
+        if (ok && (sc->starts.n >= PD_SCAN_MIN_CHAIN || sc->stop < sc->limit)) {
+            found = 1;
+            break;
+        }
+        if (ok && short_try == SIZE_MAX) {
+            short_try = try;
+        }
+        for (size_t i = 0; i < sc->starts.n; i++) {
+            PD_MARK(failed, sc->starts.v[i] - sc->from);
+        }
+    }
+    if (!found) {
+        sc->starts.n = 0;
+        sc->stop = sc->from;
+        if (short_try != SIZE_MAX) {
+            scan_chain(sc, short_try, NULL);
+        }
+    }
+
+    free(failed);
+    return NULL;
+}
+
+/**
+ * @brief Fase 1: offset di inizio di ogni elemento (o chiave) della radice
+ *
+ * Il buffer è diviso tra scan_threads scanner (scan_run()). La cucitura
+ * rifà in sequenza solo i tratti dove la catena di uno scanner non è
+ * quella vera: si salta un elemento alla volta dalla posizione corretta
+ * finché non si cade su un inizio trovato dallo scanner del blocco, e da
+ * lì (due catene che condividono un inizio coincidono da quel punto in
+ * poi) si adottano i suoi inizi fino a stop. Il risultato è identico a una
+ * scansione sequenziale anche quando l'euristica sbaglia.
+ *
+ * @return Numero di elementi, -1 se l'input non è valido; *end riceve
+ *         l'offset dopo la 'e' finale
+ */
+static ssize_t find_boundaries(const char *buf, size_t len, long scan_threads,
+                               size_t **starts, size_t *end) {
+    int is_dict = buf[0] == 'd';
+    pd_scan *scans = aligned_alloc(64, sizeof(pd_scan) * (size_t)scan_threads);
+    if (scans == NULL) {
+        fprintf(stderr, "Malloc failed in function bencode_decode_parallel!\n");
+        exit(-1);
+    }
+    for (long t = 0; t < scan_threads; t++) {
+        pd_scan *sc = &scans[t];
+        memset(sc, 0, sizeof(*sc));
+        sc->buf = buf;
+        sc->len = len;
+        sc->from = t == 0 ? 1 : (size_t)(t * (double)len / (double)scan_threads);
+        sc->limit = t == scan_threads - 1 ? len : (size_t)((t + 1) * (double)len / (double)scan_threads);
+        sc->is_dict = is_dict;
+        sc->exact = t == 0;
+    }
+
+    for (long t = 1; t < scan_threads; t++) {
+        if (pthread_create(&scans[t].thread, NULL, scan_run, &scans[t]) != 0) {
+            fprintf(stderr, "Error! pthread_create failed in function bencode_decode_parallel!\n");
+            exit(-1);
+        }
+    }
+    scan_run(&scans[0]);
+    for (long t = 1; t < scan_threads; t++) {
+        pthread_join(scans[t].thread, NULL);
+    }
+
+    /* Cucitura */
+    pd_starts out = { NULL, 0, 0 };
+    size_t pos = 1;
+    int ok = 1;
+    for (long t = 0; t <= scan_threads && ok; t++) {
+        const pd_starts *mine = t < scan_threads ? &scans[t].starts : NULL;
+        size_t limit = t < scan_threads ? scans[t].limit : len;
+        size_t k = 0;
+
+        while (1) {
+            if (pos >= len) {
+                ok = 0;
+                break;
+            }
+            if (buf[pos] == 'e' || pos >= limit) {
+                break;
+            }
+            if (mine != NULL) {
+                while (k < mine->n && mine->v[k] < pos) {
+                    k++;
+                }
+                if (k < mine->n && mine->v[k] == pos) {
+                    for (; k < mine->n; k++) {
+                        starts_push(&out, mine->v[k]);
+                    }
+                    pos = scans[t].stop;
+                    continue;
+                }
+            }
+            ssize_t r = skip_root_elem(buf, len, pos, is_dict);
+            if (r < 0) {
+                ok = 0;
+                break;
+            }
+            starts_push(&out, pos);
+            pos = (size_t)r;
+        }
+        if (ok && pos < len && buf[pos] == 'e') {
+            break;
+        }
+    }
+
+    for (long t = 0; t < scan_threads; t++) {
+        free(scans[t].starts.v);
+    }
+    free(scans);
+
+    if (!ok || pos >= len || buf[pos] != 'e') {
+        free(out.v);
+        return -1;
+    }
+    *starts = out.v;
+    *end = pos + 1;
+    return (ssize_t)out.n;
+}
+
+
+/* ============================================================================
+ * FUNZIONI: decodifica
+ * ============================================================================
+ */
+
+/**
+ * @brief Decodifica buf[0..len) usando fino a n_threads thread
+ *
+ * Divisione del lavoro: il thread t riceve gli elementi che iniziano nei
+ * byte [t * len / T, (t + 1) * len / T), così ogni blocco ha circa lo
+ * stesso numero di byte anche con elementi di dimensioni molto diverse.
+ */
+b_obj* bencode_decode_parallel(const char *buf, size_t len, int n_threads) {
+
+    /* Input validation */
+    if(buf == NULL && len > 0){
+        fprintf(stderr, "Error! NULL pointer parsed in function bencode_decode_parallel()! ");
+        exit(-1);
+    }
+
+    if (len == 0) {
+        return NULL;
+    }
+
+    B_PROBE2(decode_start, B_PROBE_PARALLEL, buf);
+    uint64_t probe_t0 = B_PROBE_CLOCK(decode_done);
+    uint64_t stats_t0 = b_stats_clock();
+
+    pd_root *pr = calloc(1, sizeof(pd_root));
+    if (pr == NULL) {
+        fprintf(stderr, "Malloc failed in function bencode_decode_parallel!\n");
+        exit(-1);
+    }
+    pr->n_arenas = 1;
+    b_obj *root = &pr->root;
+
+    /* Radice scalare: nessun parallelismo possibile */
+    if (buf[0] != 'l' && buf[0] != 'd') {
+        ssize_t skipped = bencode_skip(buf, len, 0);
+        if (skipped < 0) {
+            B_PROBE3(decode_error, B_PROBE_PARALLEL, 0, skipped);
+            b_stats_record(B_STATS_DECODE, stats_t0);
+            free(pr);
+            return NULL;
+        }
+        size_t p = 0;
+        b_obj *val = decode_value(&pr->arenas[0], buf, len, &p, 0);
+        *root = *val;
+        B_PROBE3(decode_done, B_PROBE_PARALLEL, skipped, B_PROBE_ELAPSED(probe_t0));
+        b_stats_record(B_STATS_DECODE, stats_t0);
+        return root;
+    }
+
+    long requested = n_threads > 0 ? n_threads : sysconf(_SC_NPROCESSORS_ONLN);
+    long scan_threads = requested;
+    if ((size_t)scan_threads > len / B_PDECODE_MIN_CHUNK) {
+        scan_threads = (long)(len / B_PDECODE_MIN_CHUNK);
+    }
+    if (scan_threads > B_PDECODE_MAX_THREADS) {
+        scan_threads = B_PDECODE_MAX_THREADS;
+    }
+    if (scan_threads < 1) {
+        scan_threads = 1;
+    }
+
+    size_t *starts = NULL;
+    size_t end = 0;
+    ssize_t count = find_boundaries(buf, len, scan_threads, &starts, &end);
+    if (count < 0) {
+        B_PROBE3(decode_error, B_PROBE_PARALLEL, 0, count);
+        b_stats_record(B_STATS_DECODE, stats_t0);
+        free(pr);
+        return NULL;
+    }
+
+    /* Numero di thread effettivo */
+    long threads = requested;
+    if (threads < 1) {
+        threads = 1;
+    }
+    if ((size_t)threads > end / B_PDECODE_MIN_CHUNK) {
+        threads = (long)(end / B_PDECODE_MIN_CHUNK);
+    }
+    if (threads > count) {
+        threads = (long)count;
+    }
+    if (threads > B_PDECODE_MAX_THREADS) {
+        threads = B_PDECODE_MAX_THREADS;
+    }
+    if (threads < 1) {
+        threads = 1;
+    }
+
+    pd_worker *workers = aligned_alloc(64, sizeof(pd_worker) * (size_t)threads);
+    if (workers == NULL) {
+        fprintf(stderr, "Malloc failed in function bencode_decode_parallel!\n");
+        exit(-1);
+    }
+
+    /* Confini dei blocchi per byte: ricerca del primo elemento oltre la soglia */
+    uint64_t stamp = b_encoded_stamp();
+    size_t first = 0;
+    for (long t = 0; t < threads; t++) {
+        size_t limit = (size_t)((t + 1) * (double)end / (double)threads);
+        size_t last = first;
+        if (t == threads - 1) {
+            last = (size_t)count;
+        } else {
+            while (last < (size_t)count && starts[last] < limit) {
+                last++;
+            }
+        }
+        pd_worker *w = &workers[t];
+        memset(w, 0, sizeof(*w));
+        w->buf = buf;
+        w->len = end;
+        w->starts = starts;
+        w->first = first;
+        w->last = last;
+        w->is_dict = buf[0] == 'd';
+        w->arena.stamp = stamp;
+        w->copy_from = t == 0 ? 0 : (first < (size_t)count ? starts[first] : end - 1);
+        w->copy_to = t == threads - 1 ? end : (last < (size_t)count ? starts[last] : end - 1);
+        first = last;
+    }
+
+    /* Forma codificata della radice, copiata a tratti dai worker: presa
+     * prima di avviarli, quando l'arena 0 è usata solo da questo thread */
+    char *root_encoded = arena_take(&workers[0].arena, end);
+    for (long t = 0; t < threads; t++) {
+        workers[t].copy_dst = root_encoded;
+    }
+
+    /* Il thread principale lavora come worker 0 */
+    for (long t = 1; t < threads; t++) {
+        if (pthread_create(&workers[t].thread, NULL, worker_run, &workers[t]) != 0) {
+            fprintf(stderr, "Error! pthread_create failed in function bencode_decode_parallel!\n");
+            exit(-1);
+        }
+    }
+    worker_run(&workers[0]);
+    for (long t = 1; t < threads; t++) {
+        pthread_join(workers[t].thread, NULL);
+    }
+
+    /* Cucitura dei blocchi, nell'ordine */
+    void *head = NULL, *tail = NULL;
+    for (long t = 0; t < threads; t++) {
+        pd_worker *w = &workers[t];
+        pr->arenas[t] = w->arena;
+        if (w->head == NULL) {
+            continue;
+        }
+        if (head == NULL) {
+            head = w->head;
+        } else if (w->is_dict) {
+            ((dict_node *)tail)->next = w->head;
+        } else {
+            ((list_node *)tail)->next = w->head;
+        }
+        tail = w->tail;
+    }
+    pr->n_arenas = (int)threads;
+
+    /* Wrapper della radice nell'arena 0 */
+    pd_arena *a = &pr->arenas[0];
+    root->refs = B_OBJ_REFS_ARENA;
+    root->object = arena_take(a, sizeof(b_box));
+    if (buf[0] == 'd') {
+        b_dict *d = arena_take(a, sizeof(b_dict));
+        d->dict = head;
+        d->length = (ssize_t)end;
+        d->encoded_dict = root_encoded;
+        d->arena = 1;
+        d->mutated = 0;
+        d->verified = stamp;
+        root->type = B_DICT;
+        root->object->dict = d;
+    } else {
+        b_list *l = arena_take(a, sizeof(b_list));
+        l->list = head;
+        l->length = (ssize_t)end;
+        l->encoded_list = root_encoded;
+        l->arena = 1;
+        l->mutated = 0;
+        l->verified = stamp;
+        root->type = B_LIS;
+        root->object->list = l;
+    }
+
+    free(workers);
+    free(starts);
+    B_PROBE3(decode_done, B_PROBE_PARALLEL, end, B_PROBE_ELAPSED(probe_t0));
+    b_stats_record(B_STATS_DECODE, stats_t0);
+    return root;
+}
+
+void bencode_decode_parallel_free(b_obj *root) {
+
+    /* Input validation */
+    if(root == NULL){
+        fprintf(stderr, "Error! NULL pointer parsed in function bencode_decode_parallel_free()! ");
+        exit(-1);
+    }
+
+    /* Margine di metà contatore, come b_obj_clone_free() */
+    if (b_obj_refcount(root) < B_OBJ_REFS_ARENA / 2) {
+        fprintf(stderr, "Error! Object not allocated by bencode_decode_parallel in bencode_decode_parallel_free!\n");
+        exit(-1);
+    }
+
+    pd_root *pr = (pd_root *)((char *)root - offsetof(pd_root, root));
+    for (int i = 0; i < pr->n_arenas; i++) {
+        arena_free(&pr->arenas[i]);
+    }
+    free(pr);
+}
+
+size_t bencode_decode_parallel_bytes(b_obj *root) {
+
+    /* Input validation */
+    if(root == NULL){
+        fprintf(stderr, "Error! NULL pointer parsed in function bencode_decode_parallel_bytes()! ");
+        exit(-1);
+    }
+
+    if (b_obj_refcount(root) < B_OBJ_REFS_ARENA / 2) {
+        fprintf(stderr, "Error! Object not allocated by bencode_decode_parallel in bencode_decode_parallel_bytes!\n");
+        exit(-1);
+    }
+
+    pd_root *pr = (pd_root *)((char *)root - offsetof(pd_root, root));
+    size_t total = sizeof(pd_root);
+    for (int i = 0; i < pr->n_arenas; i++) {
+        for (pd_chunk *c = pr->arenas[i].chunks; c != NULL; c = c->next) {
+            total += sizeof(pd_chunk) + c->cap;
+        }
+    }
+    return total;
+}
@@ -0,0 +1,71 @@
+#ifndef PDECODE_H
+#define PDECODE_H
+
+#include <stddef.h>
+
+#include "structs.h"
+
+/* ============================================================================
+ * PANORAMICA: Decodifica parallela di documenti grandi
+ * ============================================================================
+ *
+ * Dump di routing DHT, liste di 500k file, risposte scrape aggregate: con
+ * decode_list()/decode_dict() un solo core lavora. Qui la decodifica
+ * avviene in due fasi:
+ *
+ *   1. Passata strutturale (solo scansione con bencode_skip()): trova i
+ *      confini degli elementi della lista o del dizionario radice. Ogni
+ *      thread scandisce un intervallo di byte partendo da un confine
+ *      ipotizzato; il thread principale ricuce gli intervalli e rifà in
+ *      sequenza solo i tratti dove l'ipotesi era sbagliata
+ *   2. Gli elementi vengono divisi in blocchi contigui di byte circa uguali,
+ *      uno per thread; ogni thread li decodifica nella propria arena
+ *      (nessuna malloc condivisa, nessun lock) e copia il proprio tratto
+ *      della forma codificata della radice
+ *
+ * Infine il thread principale cuce i blocchi: l'ultimo nodo di ogni blocco
+ * punta al primo del successivo, O(thread).
+ *
+ * L'albero ottenuto ha la stessa forma di decode_list()/decode_dict()
+ * (forme codificate, B_HEX per "pieces") ma non stampa nulla, rifiuta
+ * l'input non valido invece di terminare il programma e vive nelle arene:
+ * i nodi hanno refs = B_OBJ_REFS_ARENA come quelli di b_obj_clone() e si
+ * liberano tutti insieme con bencode_decode_parallel_free(). Come il clone,
+ * l'albero è in sola lettura: prima di list_add()/dict_add() serve
+ * b_obj_make_unique() sul cammino da modificare.
+ *
+ * ============================================================================
+ */
+
+#define B_PDECODE_MIN_CHUNK   (1u << 20)  /* Byte minimi per thread: sotto conviene un thread solo */
+#define B_PDECODE_MAX_THREADS 64
+
+
+/* ============================================================================
+ * FUNZIONI: decodifica
+ * ============================================================================
+ */
+
+/**
+ * @brief Decodifica buf[0..len) usando fino a n_threads thread
+ *
+ * @param n_threads Thread da usare (0 = core disponibili). Il numero
+ *                  effettivo è limitato a len / B_PDECODE_MIN_CHUNK e al
+ *                  numero di elementi della radice.
+ *
+ * @return Radice dell'albero, NULL se l'input non è bencode valido
+ */
+b_obj* bencode_decode_parallel(const char *buf, size_t len, int n_threads);
+
+/**
+ * @brief Libera un albero prodotto da bencode_decode_parallel()
+ */
+void bencode_decode_parallel_free(b_obj *root);
+
+/**
+ * @brief Byte allocati per un albero di bencode_decode_parallel() (tutte le arene)
+ */
+size_t bencode_decode_parallel_bytes(b_obj *root);
+
+
+#endif  /* PDECODE_H */
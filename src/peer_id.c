@@ -0,0 +1,287 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <sys/random.h>
+
+#include "peer_id.h"
+#include "hash.h"
+
+/* ============================================================================
+ * CHACHA20: funzione di blocco (4 blocchi in parallelo)
+ * ============================================================================
+ *
+ * I quattro blocchi consecutivi (contatori c, c+1, c+2, c+3) sono calcolati
+ * insieme: ogni parola di stato è un vettore da 4 lane, una per blocco.
+ * GCC abbassa i tipi vettoriali a SSE2, quindi non serve codice specifico
+ * per architettura.
+ */
+
+typedef uint32_t v4u32 __attribute__((vector_size(16)));
+
+#define ROTL32(x, n) (((x) << (n)) | ((x) >> (32 - (n))))
+
+#define QUARTER_ROUND(a, b, c, d)                        \
+    do {                                                 \
+        a += b; d ^= a; d = ROTL32(d, 16);               \
+        c += d; b ^= c; b = ROTL32(b, 12);               \
+        a += b; d ^= a; d = ROTL32(d, 8);                \
+        c += d; b ^= c; b = ROTL32(b, 7);                \
+    } while (0)
+
+/**
+ * @brief Ricalcola il buffer di keystream (B_PEER_RNG_BLOCKS blocchi) e
+ *        avanza il contatore
+ */
+static void chacha20_refill(b_peer_rng *rng) {
+    v4u32 in[16], x[16];
+
+    /* Costanti "expand 32-byte k", chiave, contatore a 64 bit, nonce nullo */
+    static const uint32_t sigma[4] = { 0x61707865, 0x3320646e, 0x79622d32, 0x6b206574 };
+    for (int i = 0; i < 4; i++) {
+        in[i] = (v4u32){ sigma[i], sigma[i], sigma[i], sigma[i] };
+    }
+    for (int i = 0; i < 8; i++) {
+        uint32_t k = rng->key[i];
+        in[4 + i] = (v4u32){ k, k, k, k };
+    }
+    for (int l = 0; l < B_PEER_RNG_BLOCKS; l++) {
+        uint64_t ctr = rng->counter + (uint64_t)l;
+        in[12][l] = (uint32_t)ctr;
+        in[13][l] = (uint32_t)(ctr >> 32);
+    }
+    in[14] = (v4u32){ 0, 0, 0, 0 };
+    in[15] = (v4u32){ 0, 0, 0, 0 };
+    memcpy(x, in, sizeof(in));
+
+    for (int i = 0; i < 10; i++) {
+        QUARTER_ROUND(x[0], x[4], x[8],  x[12]);
+        QUARTER_ROUND(x[1], x[5], x[9],  x[13]);
+        QUARTER_ROUND(x[2], x[6], x[10], x[14]);
+        QUARTER_ROUND(x[3], x[7], x[11], x[15]);
+        QUARTER_ROUND(x[0], x[5], x[10], x[15]);
+        QUARTER_ROUND(x[1], x[6], x[11], x[12]);
+        QUARTER_ROUND(x[2], x[7], x[8],  x[13]);
+        QUARTER_ROUND(x[3], x[4], x[9],  x[14]);
+    }
+
+    /* Serializzazione little-endian, blocco per blocco */
+    for (int i = 0; i < 16; i++) {
+        v4u32 v = x[i] + in[i];
+        for (int l = 0; l < B_PEER_RNG_BLOCKS; l++) {
+            unsigned char *p = rng->block + 64 * l + 4 * i;
+            p[0] = (unsigned char)v[l];
+            p[1] = (unsigned char)(v[l] >> 8);
+            p[2] = (unsigned char)(v[l] >> 16);
+            p[3] = (unsigned char)(v[l] >> 24);
+        }
+    }
+
+    rng->counter += B_PEER_RNG_BLOCKS;
+    rng->pos = 0;
+}
+
+
+/* ============================================================================
+ * FUNZIONI: generatore
+ * ============================================================================
+ */
+
+void b_peer_rng_init(b_peer_rng *rng) {
+
+    /* Input validation */
+    if(rng == NULL){
+        fprintf(stderr, "Error! NULL pointer parsed in function b_peer_rng_init()! ");
+        exit(-1);
+    }
+
+    unsigned char *key = (unsigned char*)rng->key;
+    size_t got = 0;
+
+    /* getrandom() può restituire meno byte o essere interrotto da un segnale */
+    while (got < sizeof(rng->key)) {
+        ssize_t r = getrandom(key + got, sizeof(rng->key) - got, 0);
+        if (r < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            fprintf(stderr, "getrandom failed in function b_peer_rng_init!\n");
+            exit(-1);
+        }
+        got += (size_t)r;
+    }
+
+    rng->counter = 0;
+    rng->pos = sizeof(rng->block);  /* Forza il calcolo del primo blocco */
+}
+
+void b_peer_rng_seed(b_peer_rng *rng, uint64_t seed) {
+
+    /* Input validation */
+    if(rng == NULL){
+        fprintf(stderr, "Error! NULL pointer parsed in function b_peer_rng_seed()! ");
+        exit(-1);
+    }
+
+    /* Espande il seme a 256 bit di chiave con SHA-256 */
+    unsigned char s[8], digest[B_SHA256_DIGEST_LENGTH];
+    for (int i = 0; i < 8; i++) {
+        s[i] = (unsigned char)(seed >> (8 * i));
+    }
+    b_sha256(s, sizeof(s), digest);
+    memcpy(rng->key, digest, sizeof(rng->key));
+
+    rng->counter = 0;
+    rng->pos = sizeof(rng->block);
+}
+
+void b_peer_rng_bytes(b_peer_rng *rng, unsigned char *out, size_t len) {
+
+    /* Input validation */
+    if(rng == NULL || (out == NULL && len > 0)){
+        fprintf(stderr, "Error! NULL pointer parsed in function b_peer_rng_bytes()! ");
+        exit(-1);
+    }
+
+    while (len > 0) {
+        if (rng->pos == sizeof(rng->block)) {
+            chacha20_refill(rng);
+        }
+        size_t take = sizeof(rng->block) - rng->pos;
+        if (take > len) {
+            take = len;
+        }
+        memcpy(out, rng->block + rng->pos, take);
+        rng->pos += take;
+        out += take;
+        len -= take;
+    }
+}
+
+
+/* ============================================================================
+ * FUNZIONI: generazione Peer ID
+ * ============================================================================
+ */
+
+/* Generatore per-thread: nessuna contesa tra thread, seminato al primo uso */
+static _Thread_local b_peer_rng tls_rng;
+static _Thread_local int tls_rng_ready = 0;
+
+/**
+ * @brief Valida il prefisso e ne ritorna la lunghezza
+ */
+static size_t prefix_length(const char **prefix) {
+    if (*prefix == NULL) {
+        *prefix = B_PEER_ID_DEFAULT;
+    }
+    size_t len = strlen(*prefix);
+    if (len >= B_PEER_ID_LENGTH) {
+        fprintf(stderr, "Errore! Prefisso Peer ID troppo lungo (%zu byte, max %d)!\n",
+                len, B_PEER_ID_LENGTH - 1);
+        exit(-1);
+    }
+    return len;
+}
+
+void generate_random_peer_ids(const char *prefix, b_peer_rng *rng, size_t n,
+                              unsigned char *out) {
+
+    /* Input validation */
+    if(out == NULL && n > 0){
+        fprintf(stderr, "Error! NULL pointer parsed in function generate_random_peer_ids()! ");
+        exit(-1);
+    }
+
+    size_t plen = prefix_length(&prefix);
+    size_t slen = B_PEER_ID_LENGTH - plen;
+
+    if (rng == NULL) {
+        if (!tls_rng_ready) {
+            b_peer_rng_init(&tls_rng);
+            tls_rng_ready = 1;
+        }
+        rng = &tls_rng;
+    }
+
+    /*
+     * Il keystream viene copiato direttamente al posto del suffisso, senza
+     * passare da b_peer_rng_bytes(): un blocco ChaCha20 copre più di 5 ID.
+     */
+    for (size_t i = 0; i < n; i++) {
+        unsigned char *id = out + i * B_PEER_ID_LENGTH;
+        memcpy(id, prefix, plen);
+
+        size_t avail = sizeof(rng->block) - rng->pos;
+        if (avail >= slen) {
+            memcpy(id + plen, rng->block + rng->pos, slen);
+            rng->pos += slen;
+        } else {
+            memcpy(id + plen, rng->block + rng->pos, avail);
+            chacha20_refill(rng);
+            memcpy(id + plen + avail, rng->block, slen - avail);
+            rng->pos = slen - avail;
+        }
+    }
+}
+
+/* Chiavi elaborate per ogni chiamata a b_sha1_multi() */
+#define KEYS_BATCH 64
+
+void generate_peer_ids(const char *prefix, const char *const *keys, size_t n,
+                       unsigned char *out) {
+
+    /* Input validation */
+    if((keys == NULL || out == NULL) && n > 0){
+        fprintf(stderr, "Error! NULL pointer parsed in function generate_peer_ids()! ");
+        exit(-1);
+    }
+
+    size_t plen = prefix_length(&prefix);
+    const unsigned char *bufs[KEYS_BATCH];
+    size_t lens[KEYS_BATCH];
+    unsigned char digests[KEYS_BATCH * B_SHA1_DIGEST_LENGTH];
+
+    for (size_t first = 0; first < n; first += KEYS_BATCH) {
+        size_t count = n - first < KEYS_BATCH ? n - first : KEYS_BATCH;
+        for (size_t i = 0; i < count; i++) {
+            bufs[i] = (const unsigned char*)keys[first + i];
+            lens[i] = strlen(keys[first + i]);
+        }
+        b_sha1_multi(bufs, lens, count, digests);
+
+        for (size_t i = 0; i < count; i++) {
+            unsigned char *id = out + (first + i) * B_PEER_ID_LENGTH;
+            memcpy(id, prefix, plen);
+            memcpy(id + plen, digests + i * B_SHA1_DIGEST_LENGTH, B_PEER_ID_LENGTH - plen);
+        }
+    }
+}
+
+void rotate_peer_id(const char *prefix, const unsigned char *secret, size_t secret_len,
+                    const unsigned char *info_hash, uint64_t epoch, unsigned char *out) {
+
+    /* Input validation */
+    if((secret == NULL && secret_len > 0) || info_hash == NULL || out == NULL){
+        fprintf(stderr, "Error! NULL pointer parsed in function rotate_peer_id()! ");
+        exit(-1);
+    }
+
+    size_t plen = prefix_length(&prefix);
+    unsigned char e[8], digest[B_SHA1_DIGEST_LENGTH];
+    b_sha1_ctx ctx;
+
+    for (int i = 0; i < 8; i++) {
+        e[i] = (unsigned char)(epoch >> (8 * (7 - i)));
+    }
+
+    b_sha1_init(&ctx);
+    b_sha1_update(&ctx, secret, secret_len);
+    b_sha1_update(&ctx, info_hash, B_SHA1_DIGEST_LENGTH);
+    b_sha1_update(&ctx, e, sizeof(e));
+    b_sha1_final(&ctx, digest);
+
+    memcpy(out, prefix, plen);
+    memcpy(out + plen, digest, B_PEER_ID_LENGTH - plen);
+}
@@ -0,0 +1,126 @@
+#ifndef PEER_ID_H
+#define PEER_ID_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* ============================================================================
+ * PANORAMICA: Generazione massiva di Peer ID
+ * ============================================================================
+ *
+ * generate_peer_id() (bencode.h) produce un Peer ID alla volta con prefisso
+ * fisso "-GS0001-". Questo modulo aggiunge:
+ *
+ *   - prefisso del client configurabile (es. "-TR2940-", 0..19 byte)
+ *   - generazione batch da chiavi (SHA1 multi-buffer del modulo hash)
+ *   - generazione batch casuale con un CSPRNG veloce (ChaCha20), con stato
+ *     per-thread seminato dal kernel oppure con seme esplicito per i test
+ *   - rotazione per-torrent: ID derivato da (segreto, info-hash, epoca)
+ *
+ * Tutti i Peer ID sono buffer binari di B_PEER_ID_LENGTH byte, NON
+ * null-terminated.
+ *
+ * ============================================================================
+ */
+
+#define B_PEER_ID_LENGTH   20   /* Lunghezza di un Peer ID BitTorrent */
+#define B_PEER_ID_DEFAULT  "-GS0001-"
+#define B_PEER_RNG_BLOCKS  4    /* Blocchi ChaCha20 calcolati per ogni ricarica */
+
+
+/* ============================================================================
+ * STRUCT: generatore ChaCha20
+ * ============================================================================
+ */
+
+/**
+ * @struct b_peer_rng
+ * @brief Stato di un generatore ChaCha20 usato come CSPRNG
+ *
+ * Campi:
+ * - key:     chiave a 256 bit
+ * - counter: contatore di blocco (64 bit, nonce implicito a zero)
+ * - block:   keystream degli ultimi B_PEER_RNG_BLOCKS blocchi
+ * - pos:     byte già consumati di block
+ */
+typedef struct {
+    uint32_t key[8];
+    uint64_t counter;
+    unsigned char block[64 * B_PEER_RNG_BLOCKS];
+    size_t pos;
+} b_peer_rng;
+
+
+/* ============================================================================
+ * FUNZIONI: generatore
+ * ============================================================================
+ */
+
+/**
+ * @brief Inizializza un generatore con entropia del kernel (getrandom)
+ *
+ * @note Termina con exit(-1) se getrandom() fallisce
+ */
+void b_peer_rng_init(b_peer_rng *rng);
+
+/**
+ * @brief Inizializza un generatore deterministico a partire da un seme
+ *
+ * Lo stesso seme produce sempre la stessa sequenza: utile per test e
+ * simulazioni riproducibili. NON usare in produzione.
+ */
+void b_peer_rng_seed(b_peer_rng *rng, uint64_t seed);
+
+/**
+ * @brief Riempie out con len byte del keystream
+ */
+void b_peer_rng_bytes(b_peer_rng *rng, unsigned char *out, size_t len);
+
+
+/* ============================================================================
+ * FUNZIONI: generazione Peer ID
+ * ============================================================================
+ */
+
+/**
+ * @brief Genera n Peer ID con suffisso casuale
+ *
+ * @param prefix Prefisso del client (NULL = B_PEER_ID_DEFAULT), max 19 byte
+ * @param rng    Generatore da usare; NULL = generatore per-thread seminato
+ *               automaticamente alla prima chiamata sul thread
+ * @param n      Numero di Peer ID da generare
+ * @param out    Buffer di almeno n * B_PEER_ID_LENGTH byte
+ */
+void generate_random_peer_ids(const char *prefix, b_peer_rng *rng, size_t n,
+                              unsigned char *out);
+
+/**
+ * @brief Genera n Peer ID come prefix + SHA1(keys[i]) troncato
+ *
+ * Estensione batch di generate_peer_id(): con prefix = "-GS0001-" il
+ * risultato per ogni chiave coincide con quello di generate_peer_id().
+ *
+ * @param keys Array di n stringhe null-terminated
+ * @param out  Buffer di almeno n * B_PEER_ID_LENGTH byte
+ */
+void generate_peer_ids(const char *prefix, const char *const *keys, size_t n,
+                       unsigned char *out);
+
+/**
+ * @brief Peer ID per-torrent con rotazione
+ *
+ * Deriva l'ID da SHA1(secret || info_hash || epoch): lo stesso client
+ * presenta ID diversi e non correlabili su torrent diversi, e ne cambia
+ * quando cambia epoch (es. ora corrente / periodo di rotazione).
+ *
+ * @param secret      Segreto locale del client
+ * @param secret_len  Lunghezza del segreto
+ * @param info_hash   Info-hash del torrent (20 byte)
+ * @param epoch       Periodo di rotazione corrente
+ * @param out         Buffer di almeno B_PEER_ID_LENGTH byte
+ */
+void rotate_peer_id(const char *prefix, const unsigned char *secret, size_t secret_len,
+                    const unsigned char *info_hash, uint64_t epoch, unsigned char *out);
+
+
+#endif  /* PEER_ID_H */
@@ -0,0 +1,231 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#if defined(__linux__)
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#define B_PERF_LINUX 1
+#endif
+
+#include "perfctr.h"
+
+/* ============================================================================
+ * HELPER: eventi
+ * ============================================================================
+ */
+
+static const char *const event_name[B_PERF_EVENTS] = {
+    "cycles", "instructions", "branch-misses", "L1D-misses", "LLC-misses", "dTLB-misses"
+};
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+#ifdef B_PERF_LINUX
+
+#define CACHE_READ_MISS(cache) \
+    ((cache) | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16))
+
+static void event_attr(int event, struct perf_event_attr *attr) {
+    memset(attr, 0, sizeof(*attr));
+    attr->size = sizeof(*attr);
+    attr->type = PERF_TYPE_HARDWARE;
+
+    switch (event) {
+        case B_PERF_CYCLES:
+            attr->config = PERF_COUNT_HW_CPU_CYCLES;
+            break;
+        case B_PERF_INSTRUCTIONS:
+            attr->config = PERF_COUNT_HW_INSTRUCTIONS;
+            break;
+        case B_PERF_BRANCH_MISSES:
+            attr->config = PERF_COUNT_HW_BRANCH_MISSES;
+            break;
+        case B_PERF_L1D_MISSES:
+            attr->type = PERF_TYPE_HW_CACHE;
+            attr->config = CACHE_READ_MISS(PERF_COUNT_HW_CACHE_L1D);
+            break;
+        case B_PERF_LLC_MISSES:
+            attr->type = PERF_TYPE_HW_CACHE;
+            attr->config = CACHE_READ_MISS(PERF_COUNT_HW_CACHE_LL);
+            break;
+        case B_PERF_DTLB_MISSES:
+            attr->type = PERF_TYPE_HW_CACHE;
+            attr->config = CACHE_READ_MISS(PERF_COUNT_HW_CACHE_DTLB);
+            break;
+    }
+
+    /* Fermo all'apertura, solo user space, ereditato dai thread creati dopo
+     * (i worker di pdecode, split, dedupe vengono contati) */
+    attr->disabled = 1;
+    attr->exclude_kernel = 1;
+    attr->exclude_hv = 1;
+    attr->inherit = 1;
+    attr->read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+}
+
+#endif
+
+
+/* ============================================================================
+ * FUNZIONI: misura
+ * ============================================================================
+ */
+
+int b_perf_open(b_perf *perf) {
+
+    /* Input validation */
+    if(perf == NULL){
+        fprintf(stderr, "Error! NULL pointer parsed in function b_perf_open()! ");
+        exit(-1);
+    }
+
+    perf->n_available = 0;
+    for (int i = 0; i < B_PERF_EVENTS; i++) {
+        perf->fd[i] = -1;
+#ifdef B_PERF_LINUX
+        struct perf_event_attr attr;
+        event_attr(i, &attr);
+        perf->fd[i] = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+        if (perf->fd[i] >= 0) {
+            perf->n_available++;
+        }
+#endif
+    }
+    return perf->n_available;
+}
+
+void b_perf_close(b_perf *perf) {
+    if (perf == NULL) {
+        return;
+    }
+    for (int i = 0; i < B_PERF_EVENTS; i++) {
+        if (perf->fd[i] >= 0) {
+            close(perf->fd[i]);
+            perf->fd[i] = -1;
+        }
+    }
+    perf->n_available = 0;
+}
+
+void b_perf_start(b_perf *perf, b_perf_sample *sample) {
+
+    /* Input validation */
+    if(perf == NULL || sample == NULL){
+        fprintf(stderr, "Error! NULL pointer parsed in function b_perf_start()! ");
+        exit(-1);
+    }
+
+    memset(sample, 0, sizeof(*sample));
+#ifdef B_PERF_LINUX
+    for (int i = 0; i < B_PERF_EVENTS; i++) {
+        if (perf->fd[i] >= 0) {
+            ioctl(perf->fd[i], PERF_EVENT_IOC_RESET, 0);
+            ioctl(perf->fd[i], PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+#endif
+    sample->ns = now_ns();
+}
+
+/**
+ * @brief Legge i contatori scalando per il multiplexing
+ *
+ * Un contatore mai andato in esecuzione (time_running = 0) non è valido.
+ */
+void b_perf_stop(b_perf *perf, b_perf_sample *sample) {
+
+    /* Input validation */
+    if(perf == NULL || sample == NULL){
+        fprintf(stderr, "Error! NULL pointer parsed in function b_perf_stop()! ");
+        exit(-1);
+    }
+
+    uint64_t end = now_ns();
+#ifdef B_PERF_LINUX
+    for (int i = 0; i < B_PERF_EVENTS; i++) {
+        if (perf->fd[i] >= 0) {
+            ioctl(perf->fd[i], PERF_EVENT_IOC_DISABLE, 0);
+        }
+    }
+    for (int i = 0; i < B_PERF_EVENTS; i++) {
+        uint64_t data[3];
+        if (perf->fd[i] < 0 || read(perf->fd[i], data, sizeof(data)) != (ssize_t)sizeof(data) ||
+            data[2] == 0) {
+            continue;
+        }
+        double scale = data[2] < data[1] ? (double)data[1] / (double)data[2] : 1.0;
+        sample->value[i] = (uint64_t)((double)data[0] * scale);
+        sample->valid[i] = 1;
+    }
+#else
+    (void)perf;
+#endif
+    sample->ns = end - sample->ns;
+}
+
+void b_perf_measure(b_perf *perf, b_perf_fn fn, void *ctx, unsigned repeat, b_perf_sample *sample) {
+
+    /* Input validation */
+    if(perf == NULL || fn == NULL || sample == NULL){
+        fprintf(stderr, "Error! NULL pointer parsed in function b_perf_measure()! ");
+        exit(-1);
+    }
+
+    b_perf_start(perf, sample);
+    for (unsigned r = 0; r < repeat; r++) {
+        fn(ctx);
+    }
+    b_perf_stop(perf, sample);
+}
+
+
+/* ============================================================================
+ * FUNZIONI: report
+ * ============================================================================
+ */
+
+static void print_ratio(FILE *out, const char *label, const b_perf_sample *s, int event, double div) {
+    if (s->valid[event] && div > 0) {
+        fprintf(out, "  %s %.3f", label, (double)s->value[event] / div);
+    } else {
+        fprintf(out, "  %s n/d", label);
+    }
+}
+
+void b_perf_report(FILE *out, const char *phase, const b_perf_sample *sample, size_t bytes, size_t nodes) {
+
+    /* Input validation */
+    if(out == NULL || phase == NULL || sample == NULL){
+        fprintf(stderr, "Error! NULL pointer parsed in function b_perf_report()! ");
+        exit(-1);
+    }
+
+    double secs = (double)sample->ns / 1e9;
+    fprintf(out, "%-24s %10.1f MB/s", phase, secs > 0 ? (double)bytes / secs / 1e6 : 0.0);
+    print_ratio(out, "cyc/B", sample, B_PERF_CYCLES, (double)bytes);
+
+    if (sample->valid[B_PERF_CYCLES] && sample->valid[B_PERF_INSTRUCTIONS] && sample->value[B_PERF_CYCLES] > 0) {
+        fprintf(out, "  IPC %.2f", (double)sample->value[B_PERF_INSTRUCTIONS] /
+                                   (double)sample->value[B_PERF_CYCLES]);
+    } else {
+        fprintf(out, "  IPC n/d");
+    }
+
+    if (nodes > 0) {
+        print_ratio(out, "cyc/nodo", sample, B_PERF_CYCLES, (double)nodes);
+        for (int i = B_PERF_BRANCH_MISSES; i < B_PERF_EVENTS; i++) {
+            char label[32];
+            snprintf(label, sizeof(label), "%s/nodo", event_name[i]);
+            print_ratio(out, label, sample, i, (double)nodes);
+        }
+    }
+    fprintf(out, "\n");
+}
@@ -0,0 +1,117 @@
+#ifndef PERFCTR_H
+#define PERFCTR_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/* ============================================================================
+ * PANORAMICA: Contatori hardware per le fasi dei benchmark
+ * ============================================================================
+ *
+ * I MB/s non spiegano una regressione del decoder: servono cicli,
+ * istruzioni e miss. Questo modulo apre i contatori con perf_event_open()
+ * (solo il processo corrente, solo user space) e li legge attorno a una
+ * fase (decodifica, codifica, ricerca):
+ *
+ *   cicli, istruzioni, branch-miss, miss L1D in lettura, miss LLC in
+ *   lettura, miss dTLB in lettura
+ *
+ * Ogni contatore è aperto separatamente: se la CPU, la virtualizzazione o
+ * perf_event_paranoid ne negano qualcuno gli altri restano disponibili, e
+ * quelli mancanti sono riportati come "n/d". Fuori da Linux nessun
+ * contatore è disponibile e resta solo il tempo. Con più eventi che
+ * contatori fisici il kernel li multiplexa: i valori sono scalati con
+ * time_enabled / time_running.
+ *
+ * Il report normalizza per byte elaborati (cicli/byte) e per nodo
+ * (miss/nodo), così percorsi diversi (decode_dict(), pdecode, cursori,
+ * indice strutturale) si confrontano sullo stesso input.
+ *
+ * ============================================================================
+ */
+
+#define B_PERF_CYCLES        0
+#define B_PERF_INSTRUCTIONS  1
+#define B_PERF_BRANCH_MISSES 2
+#define B_PERF_L1D_MISSES    3
+#define B_PERF_LLC_MISSES    4
+#define B_PERF_DTLB_MISSES   5
+#define B_PERF_EVENTS        6
+
+
+/* ============================================================================
+ * STRUCT: contatori
+ * ============================================================================
+ */
+
+/**
+ * @struct b_perf
+ * @brief Contatori aperti (fd -1 = non disponibile)
+ */
+typedef struct {
+    int fd[B_PERF_EVENTS];
+    int n_available;
+} b_perf;
+
+/**
+ * @struct b_perf_sample
+ * @brief Valori di una fase (valid[i] = 0 se il contatore i non c'è)
+ */
+typedef struct {
+    uint64_t value[B_PERF_EVENTS];
+    int valid[B_PERF_EVENTS];
+    uint64_t ns;
+} b_perf_sample;
+
+/**
+ * @brief Fase misurata da b_perf_measure()
+ */
+typedef void (*b_perf_fn)(void *ctx);
+
+
+/* ============================================================================
+ * FUNZIONI: misura
+ * ============================================================================
+ */
+
+/**
+ * @brief Apre i contatori disponibili (fermi)
+ *
+ * @return Numero di contatori disponibili (0 = solo tempo)
+ */
+int b_perf_open(b_perf *perf);
+
+/**
+ * @brief Chiude i contatori
+ */
+void b_perf_close(b_perf *perf);
+
+/**
+ * @brief Azzera e avvia i contatori; sample->ns riceve l'istante di partenza
+ */
+void b_perf_start(b_perf *perf, b_perf_sample *sample);
+
+/**
+ * @brief Ferma i contatori e completa sample con i valori e la durata
+ */
+void b_perf_stop(b_perf *perf, b_perf_sample *sample);
+
+/**
+ * @brief Esegue fn(ctx) repeat volte tra start e stop
+ *
+ * I valori restano cumulativi: b_perf_report() riceve bytes e nodes già
+ * moltiplicati per repeat.
+ */
+void b_perf_measure(b_perf *perf, b_perf_fn fn, void *ctx, unsigned repeat, b_perf_sample *sample);
+
+/**
+ * @brief Stampa una riga con MB/s, cicli/byte, IPC, miss per nodo
+ *
+ * @param bytes Byte elaborati nella fase
+ * @param nodes Nodi (valori bencode) elaborati; 0 = colonne per nodo omesse
+ */
+void b_perf_report(FILE *out, const char *phase, const b_perf_sample *sample, size_t bytes, size_t nodes);
+
+
+#endif  /* PERFCTR_H */
@@ -0,0 +1,98 @@
+#ifndef PROBES_H
+#define PROBES_H
+
+#include <stdint.h>
+#include <time.h>
+
+/* ============================================================================
+ * PANORAMICA: Probe USDT per bpftrace/perf/systemtap
+ * ============================================================================
+ *
+ * Punti di traccia statici (sys/sdt.h, solo header) sui percorsi caldi,
+ * agganciabili in produzione senza ricompilare:
+ *
+ *   bpftrace -e 'usdt:./prog:bencode:decode_done { @ns = hist(arg2); }'
+ *
+ * Provider "bencode", probe e argomenti:
+ *
+ *   decode_start   (kind, buf)              ingresso di decode_dict(),
+ *                                            decode_list() (solo radice,
+ *                                            start = 0) e pdecode
+ *   decode_done    (kind, len, ns)          uscita con successo
+ *   decode_error   (kind, offset, code)     errore (code B_SCHEMA_*; offset
+ *                                            nel valore che fallisce, 0 se
+ *                                            ignoto)
+ *   encode_done    (len, ns)                bencode_encode_alloc(),
+ *                                            b_iovec_enc_write()
+ *   arena_grow     (kind, bytes)            nuovo blocco di un'arena
+ *   piece_hashed   (index, len, digest)     b_sha1_pieces()
+ *   piece_verified (index, len, ok)         b_sha1_verify_pieces()
+ *
+ * Una probe non agganciata è una singola nop. Le durate (ns) richiedono
+ * però clock_gettime(): vengono misurate solo se il semaforo della probe
+ * è attivo (il tracer lo incrementa quando si aggancia), altrimenti ns = 0.
+ * Per questo ogni file che usa le probe dichiara i semafori di quelle che
+ * emette con B_PROBE_SEMAPHORE().
+ *
+ * Senza <sys/sdt.h> (o con B_PROBES_DISABLE) le macro si riducono a nulla.
+ *
+ * ============================================================================
+ */
+
+/* Valori di "kind" */
+#define B_PROBE_TREE      0   /* decode_dict() / decode_list() */
+#define B_PROBE_PARALLEL  1   /* bencode_decode_parallel() */
+
+#if !defined(B_PROBES_DISABLE) && defined(__has_include)
+#if __has_include(<sys/sdt.h>)
+#define _SDT_HAS_SEMAPHORES 1
+#include <sys/sdt.h>
+#define B_PROBES 1
+#endif
+#endif
+
+
+/* ============================================================================
+ * MACRO: probe
+ * ============================================================================
+ */
+
+#ifdef B_PROBES
+
+#define B_PROBE_SEMAPHORE(name) \
+    __extension__ static volatile unsigned short bencode_##name##_semaphore \
+    __attribute__((used, section(".probes")))
+
+#define B_PROBE_ENABLED(name) __builtin_expect(bencode_##name##_semaphore != 0, 0)
+
+#define B_PROBE2(name, a, b)    DTRACE_PROBE2(bencode, name, a, b)
+#define B_PROBE3(name, a, b, c) DTRACE_PROBE3(bencode, name, a, b, c)
+
+#else
+
+#define B_PROBE_SEMAPHORE(name) struct b_probe_unused_##name
+#define B_PROBE_ENABLED(name)   0
+
+#define B_PROBE2(name, a, b)    do { (void)(a); (void)(b); } while (0)
+#define B_PROBE3(name, a, b, c) do { (void)(a); (void)(b); (void)(c); } while (0)
+
+#endif
+
+/**
+ * @brief Istante in ns se la probe name è agganciata, altrimenti 0
+ */
+#define B_PROBE_CLOCK(name) (B_PROBE_ENABLED(name) ? b_probe_ns() : 0)
+
+/**
+ * @brief ns trascorsi da start (0 se start è 0)
+ */
+#define B_PROBE_ELAPSED(start) ((start) != 0 ? b_probe_ns() - (start) : 0)
+
+static inline uint64_t b_probe_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+
+#endif  /* PROBES_H */
@@ -0,0 +1,699 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "schema.h"
+#include "number.h"
+#include "stats.h"
+
+static inline int is_digit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+
+/* ============================================================================
+ * FUNZIONI: lettura scalari
+ * ============================================================================
+ */
+
+ssize_t bencode_read_int(const char *buf, size_t len, size_t pos, int64_t *out) {
+    if (pos >= len) {
+        return B_SCHEMA_INCOMPLETE;
+    }
+    if (buf[pos] != 'i') {
+        return B_SCHEMA_TYPE;
+    }
+
+    size_t start = pos + 1;
+    size_t avail = len - start;
+    size_t limit = avail < B_NUM_MAX_CHARS + 1 ? avail : B_NUM_MAX_CHARS + 1;
+
+    const char *end = memchr(buf + start, 'e', limit);
+    if (end == NULL) {
+        return limit == avail ? B_SCHEMA_INCOMPLETE : B_SCHEMA_INVALID;
+    }
+
+    int64_t v;
+    if (b_parse_i64(buf + start, (size_t)(end - (buf + start)), &v) != B_NUM_OK) {
+        return B_SCHEMA_INVALID;
+    }
+    if (out != NULL) {
+        *out = v;
+    }
+    return (ssize_t)(end - buf) + 1;
+}
+
+ssize_t bencode_read_bytes(const char *buf, size_t len, size_t pos, b_span *out) {
+    if (pos >= len) {
+        return B_SCHEMA_INCOMPLETE;
+    }
+    if (!is_digit(buf[pos])) {
+        return B_SCHEMA_TYPE;
+    }
+
+    size_t avail = len - pos;
+    size_t limit = avail < B_NUM_MAX_CHARS + 1 ? avail : B_NUM_MAX_CHARS + 1;
+    size_t n = b_scan_digits(buf + pos, limit);
+
+    if (n == avail) {
+        return B_SCHEMA_INCOMPLETE;
+    }
+    if (n == 0 || n > B_NUM_MAX_CHARS || buf[pos + n] != ':' ||
+        (buf[pos] == '0' && n > 1)) {
+        return B_SCHEMA_INVALID;
+    }
+
+    uint64_t size;
+    if (b_parse_u64(buf + pos, n, &size) != B_NUM_OK) {
+        return B_SCHEMA_INVALID;
+    }
+
+    size_t start = pos + n + 1;
+    if (len - start < size) {
+        return B_SCHEMA_INCOMPLETE;
+    }
+    if (out != NULL) {
+        out->ptr = buf + start;
+        out->len = (size_t)size;
+    }
+    return (ssize_t)(start + size);
+}
+
+
+/* ============================================================================
+ * FUNZIONI: validazione
+ * ============================================================================
+ */
+
+/**
+ * @brief Salta un valore con profondità di annidamento depth
+ *
+ * Ricorsione limitata a B_SCHEMA_MAX_DEPTH livelli: input ostili con
+ * migliaia di 'l' annidate vengono rifiutati invece di esaurire lo stack.
+ */
+static ssize_t skip_value(const char *buf, size_t len, size_t pos, int depth) {
+    if (pos >= len) {
+        return B_SCHEMA_INCOMPLETE;
+    }
+    if (depth > B_SCHEMA_MAX_DEPTH) {
+        return B_SCHEMA_INVALID;
+    }
+
+    char c = buf[pos];
+    if (c == 'i') {
+        return bencode_read_int(buf, len, pos, NULL);
+    }
+    if (is_digit(c)) {
+        return bencode_read_bytes(buf, len, pos, NULL);
+    }
+    if (c != 'l' && c != 'd') {
+        return B_SCHEMA_INVALID;
+    }
+
+    pos++;
+    while (1) {
+        if (pos >= len) {
+            return B_SCHEMA_INCOMPLETE;
+        }
+        if (buf[pos] == 'e') {
+            return (ssize_t)pos + 1;
+        }
+
+        ssize_t r;
+        if (c == 'd') {
+            /* Le chiavi sono sempre bytestring */
+            if (!is_digit(buf[pos])) {
+                return B_SCHEMA_INVALID;
+            }
+            r = bencode_read_bytes(buf, len, pos, NULL);
+            if (r < 0) {
+                return r;
+            }
+            pos = (size_t)r;
+        }
+        r = skip_value(buf, len, pos, depth + 1);
+        if (r < 0) {
+            return r;
+        }
+        pos = (size_t)r;
+    }
+}
+
+ssize_t bencode_skip(const char *buf, size_t len, size_t pos) {
+
+    /* Input validation */
+    if(buf == NULL && len > 0){
+        fprintf(stderr, "Error! NULL pointer parsed in function bencode_skip()! ");
+        exit(-1);
+    }
+
+    return skip_value(buf, len, pos, 0);
+}
+
+
+/* ============================================================================
+ * HELPER: decodifica nei campi
+ * ============================================================================
+ */
+
+static ssize_t decode_dict_into(const b_schema *schema, const char *buf, size_t len,
+                                size_t pos, char *out, int depth);
+
+static size_t elem_size(const b_field *field) {
+    switch (field->elem_type) {
+        case B_FIELD_INT:   return sizeof(int64_t);
+        case B_FIELD_BYTES:
+        case B_FIELD_RAW:   return sizeof(b_span);
+        case B_FIELD_DICT:  return field->sub->struct_size;
+        default:
+            fprintf(stderr, "Error! Nested list fields are not supported!\n");
+            exit(-1);
+    }
+}
+
+static ssize_t decode_field(const b_field *field, const char *buf, size_t len,
+                            size_t pos, char *base, int depth);
+
+/**
+ * @brief Decodifica una lista in un b_schema_array
+ *
+ * Prima passata: conta gli elementi saltandoli. Seconda passata: decodifica
+ * in un array allocato una sola volta con la dimensione esatta.
+ */
+static ssize_t decode_list_into(const b_field *field, const char *buf, size_t len,
+                                size_t pos, b_schema_array *arr, int depth) {
+    if (depth > B_SCHEMA_MAX_DEPTH) {
+        return B_SCHEMA_INVALID;
+    }
+
+    size_t count = 0;
+    size_t p = pos + 1;
+    while (1) {
+        if (p >= len) {
+            return B_SCHEMA_INCOMPLETE;
+        }
+        if (buf[p] == 'e') {
+            break;
+        }
+        ssize_t r = skip_value(buf, len, p, depth + 1);
+        if (r < 0) {
+            return r;
+        }
+        p = (size_t)r;
+        count++;
+    }
+
+    size_t size = elem_size(field);
+    if (count > 0) {
+        arr->items = calloc(count, size);
+        if (arr->items == NULL) {
+            fprintf(stderr, "Malloc failed in function b_schema_decode!\n");
+            exit(-1);
+        }
+    }
+    arr->count = count;
+
+    /* Descrittore dell'elemento: stesso tipo di elem_type, offset 0 */
+    b_field elem = { .key = field->key, .key_len = field->key_len, .type = field->elem_type,
+                     .elem_type = field->elem_type, .offset = 0, .sub = field->sub };
+    p = pos + 1;
+    for (size_t i = 0; i < count; i++) {
+        ssize_t r = decode_field(&elem, buf, len, p, (char *)arr->items + i * size, depth + 1);
+        if (r < 0) {
+            return r;
+        }
+        p = (size_t)r;
+    }
+    return (ssize_t)p + 1;
+}
+
+/**
+ * @brief Decodifica il valore in buf[pos] nel campo descritto da field
+ */
+static ssize_t decode_field(const b_field *field, const char *buf, size_t len,
+                            size_t pos, char *base, int depth) {
+    char *dst = base + field->offset;
+    char c = buf[pos];
+
+    switch (field->type) {
+        case B_FIELD_INT:
+            if (c != 'i') {
+                return is_digit(c) || c == 'l' || c == 'd' ? B_SCHEMA_TYPE : B_SCHEMA_INVALID;
+            }
+            return bencode_read_int(buf, len, pos, (int64_t *)dst);
+
+        case B_FIELD_BYTES:
+            if (!is_digit(c)) {
+                return c == 'i' || c == 'l' || c == 'd' ? B_SCHEMA_TYPE : B_SCHEMA_INVALID;
+            }
+            return bencode_read_bytes(buf, len, pos, (b_span *)dst);
+
+        case B_FIELD_RAW: {
+            ssize_t r = skip_value(buf, len, pos, depth);
+            if (r >= 0) {
+                ((b_span *)dst)->ptr = buf + pos;
+                ((b_span *)dst)->len = (size_t)r - pos;
+            }
+            return r;
+        }
+
+        case B_FIELD_DICT:
+            if (c != 'd') {
+                return c == 'i' || c == 'l' || is_digit(c) ? B_SCHEMA_TYPE : B_SCHEMA_INVALID;
+            }
+            return decode_dict_into(field->sub, buf, len, pos, dst, depth + 1);
+
+        case B_FIELD_LIST:
+            if (c != 'l') {
+                return c == 'i' || c == 'd' || is_digit(c) ? B_SCHEMA_TYPE : B_SCHEMA_INVALID;
+            }
+            return decode_list_into(field, buf, len, pos, (b_schema_array *)dst, depth);
+    }
+    return B_SCHEMA_INVALID;
+}
+
+/**
+ * @brief Indice del primo descrittore con la chiave indicata, -1 se assente
+ *
+ * Prova prima hint (il descrittore successivo all'ultimo trovato): con
+ * descrittori ordinati e dizionari bencode ordinati è quasi sempre quello.
+ */
+static ssize_t find_field(const b_schema *schema, const b_span *key, size_t hint) {
+    for (size_t k = 0; k < schema->n_fields; k++) {
+        size_t i = (hint + k) % schema->n_fields;
+        const b_field *f = &schema->fields[i];
+        if (f->key_len == key->len && memcmp(f->key, key->ptr, key->len) == 0) {
+            /* Torna al primo di una serie di descrittori con la stessa chiave */
+            while (i > 0 && schema->fields[i - 1].key_len == key->len &&
+                   memcmp(schema->fields[i - 1].key, key->ptr, key->len) == 0) {
+                i--;
+            }
+            return (ssize_t)i;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Decodifica il dizionario in buf[pos] nella struct out
+ */
+static ssize_t decode_dict_into(const b_schema *schema, const char *buf, size_t len,
+                                size_t pos, char *out, int depth) {
+    if (depth > B_SCHEMA_MAX_DEPTH) {
+        return B_SCHEMA_INVALID;
+    }
+    if (schema->n_fields > B_SCHEMA_MAX_FIELDS) {
+        fprintf(stderr, "Error! Schema with more than %d fields!\n", B_SCHEMA_MAX_FIELDS);
+        exit(-1);
+    }
+
+    uint64_t seen = 0;
+    size_t hint = 0;
+
+    pos++;
+    while (1) {
+        if (pos >= len) {
+            return B_SCHEMA_INCOMPLETE;
+        }
+        if (buf[pos] == 'e') {
+            break;
+        }
+        if (!is_digit(buf[pos])) {
+            return B_SCHEMA_INVALID;
+        }
+
+        b_span key;
+        ssize_t r = bencode_read_bytes(buf, len, pos, &key);
+        if (r < 0) {
+            return r;
+        }
+        pos = (size_t)r;
+        if (pos >= len) {
+            return B_SCHEMA_INCOMPLETE;
+        }
+
+        ssize_t idx = find_field(schema, &key, hint);
+        if (idx < 0) {
+            /* Chiave sconosciuta: salta il valore senza decodificarlo */
+            r = skip_value(buf, len, pos, depth + 1);
+            if (r < 0) {
+                return r;
+            }
+            pos = (size_t)r;
+            continue;
+        }
+
+        /* Chiave ripetuta: bencode non valido, e la seconda decodifica
+         * sovrascriverebbe gli array (di liste e sotto-dizionari) della prima */
+        if (seen & (1ULL << idx)) {
+            return B_SCHEMA_INVALID;
+        }
+
+        /* Decodifica in tutti i descrittori consecutivi con la stessa chiave */
+        size_t i = (size_t)idx;
+        ssize_t end = 0;
+        do {
+            end = decode_field(&schema->fields[i], buf, len, pos, out, depth);
+            if (end < 0) {
+                return end;
+            }
+            seen |= 1ULL << i;
+            i++;
+        } while (i < schema->n_fields && schema->fields[i].key_len == key.len &&
+                 memcmp(schema->fields[i].key, key.ptr, key.len) == 0);
+
+        hint = i;
+        pos = (size_t)end;
+    }
+
+    for (size_t i = 0; i < schema->n_fields; i++) {
+        if ((schema->fields[i].flags & B_FIELD_REQUIRED) && !(seen & (1ULL << i))) {
+            return B_SCHEMA_MISSING;
+        }
+    }
+    return (ssize_t)pos + 1;
+}
+
+
+/* ============================================================================
+ * FUNZIONI: decodifica
+ * ============================================================================
+ */
+
+ssize_t b_schema_decode(const b_schema *schema, const char *buf, size_t len, void *out) {
+
+    /* Input validation */
+    if(schema == NULL || out == NULL || (buf == NULL && len > 0)){
+        fprintf(stderr, "Error! NULL pointer parsed in function b_schema_decode()! ");
+        exit(-1);
+    }
+
+    memset(out, 0, schema->struct_size);
+    if (len == 0) {
+        return B_SCHEMA_INCOMPLETE;
+    }
+    if (buf[0] != 'd') {
+        return B_SCHEMA_TYPE;
+    }
+
+    uint64_t stats_t0 = b_stats_clock();
+    ssize_t r = decode_dict_into(schema, buf, len, 0, out, 0);
+    if (r < 0) {
+        b_schema_free(schema, out);
+        memset(out, 0, schema->struct_size);
+    }
+    b_stats_record(B_STATS_DECODE, stats_t0);
+    return r;
+}
+
+/**
+ * @brief Libera gli array di un singolo valore del tipo di field
+ */
+static void free_field(const b_field *field, char *dst) {
+    if (field->type == B_FIELD_DICT) {
+        b_schema_free(field->sub, dst);
+        return;
+    }
+    if (field->type != B_FIELD_LIST) {
+        return;
+    }
+
+    b_schema_array *arr = (b_schema_array *)dst;
+    if (field->elem_type == B_FIELD_DICT && arr->items != NULL) {
+        for (size_t i = 0; i < arr->count; i++) {
+            b_schema_free(field->sub, (char *)arr->items + i * field->sub->struct_size);
+        }
+    }
+    free(arr->items);
+    arr->items = NULL;
+    arr->count = 0;
+}
+
+void b_schema_free(const b_schema *schema, void *out) {
+    if (schema == NULL || out == NULL) {
+        return;
+    }
+    for (size_t i = 0; i < schema->n_fields; i++) {
+        free_field(&schema->fields[i], (char *)out + schema->fields[i].offset);
+    }
+}
+
+
+/* ============================================================================
+ * HELPER: codifica dei campi
+ * ============================================================================
+ */
+
+/**
+ * @brief 1 se il campo va scritto (vedi "Campi omessi" in schema.h)
+ */
+static int field_present(const b_field *field, const char *base) {
+    const char *src = base + field->offset;
+
+    /* Un valore grezzo assente non ha codifica, neanche se obbligatorio */
+    if (field->type == B_FIELD_RAW) {
+        return ((const b_span *)src)->ptr != NULL;
+    }
+    if (field->flags & B_FIELD_REQUIRED) {
+        return 1;
+    }
+    switch (field->type) {
+        case B_FIELD_INT:   return *(const int64_t *)src != 0;
+        case B_FIELD_BYTES:
+        case B_FIELD_RAW:   return ((const b_span *)src)->ptr != NULL;
+        case B_FIELD_LIST:  return ((const b_schema_array *)src)->count > 0;
+        case B_FIELD_DICT:  return 1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Lunghezza della codifica del valore del campo
+ */
+static size_t value_size(const b_field *field, const char *base) {
+    const char *src = base + field->offset;
+
+    switch (field->type) {
+        case B_FIELD_INT: {
+            int64_t v = *(const int64_t *)src;
+            uint64_t mag = v < 0 ? 0 - (uint64_t)v : (uint64_t)v;
+            return 2 + (v < 0) + b_digits_u64(mag);
+        }
+        case B_FIELD_BYTES: {
+            size_t n = ((const b_span *)src)->len;
+            return b_digits_u64(n) + 1 + n;
+        }
+        case B_FIELD_RAW:
+            return ((const b_span *)src)->len;
+        case B_FIELD_DICT:
+            return bencode_struct_size(field->sub, src);
+        case B_FIELD_LIST: {
+            const b_schema_array *arr = (const b_schema_array *)src;
+            b_field elem = { .type = field->elem_type, .elem_type = field->elem_type,
+                             .offset = 0, .sub = field->sub };
+            size_t size = elem_size(field);
+            size_t total = 2;
+            for (size_t i = 0; i < arr->count; i++) {
+                total += value_size(&elem, (const char *)arr->items + i * size);
+            }
+            return total;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Scrive la codifica del valore del campo in buf
+ */
+static size_t encode_value(const b_field *field, const char *base, char *buf) {
+    const char *src = base + field->offset;
+
+    switch (field->type) {
+        case B_FIELD_INT: {
+            buf[0] = 'i';
+            size_t n = b_format_i64(buf + 1, *(const int64_t *)src);
+            buf[n + 1] = 'e';
+            return n + 2;
+        }
+        case B_FIELD_BYTES: {
+            const b_span *span = (const b_span *)src;
+            size_t n = b_format_u64(buf, span->len);
+            buf[n++] = ':';
+            if (span->len > 0) {
+                memcpy(buf + n, span->ptr, span->len);
+            }
+            return n + span->len;
+        }
+        case B_FIELD_RAW: {
+            const b_span *span = (const b_span *)src;
+            if (span->len > 0) {
+                memcpy(buf, span->ptr, span->len);
+            }
+            return span->len;
+        }
+        case B_FIELD_DICT:
+            return bencode_encode_struct(field->sub, src, buf);
+        case B_FIELD_LIST: {
+            const b_schema_array *arr = (const b_schema_array *)src;
+            b_field elem = { .type = field->elem_type, .elem_type = field->elem_type,
+                             .offset = 0, .sub = field->sub };
+            size_t size = elem_size(field);
+            size_t n = 0;
+            buf[n++] = 'l';
+            for (size_t i = 0; i < arr->count; i++) {
+                n += encode_value(&elem, (const char *)arr->items + i * size, buf + n);
+            }
+            buf[n++] = 'e';
+            return n;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief 1 se il descrittore i ha la stessa chiave del precedente
+ */
+static int same_key_as_prev(const b_schema *schema, size_t i) {
+    if (i == 0) {
+        return 0;
+    }
+    const b_field *a = &schema->fields[i - 1];
+    const b_field *b = &schema->fields[i];
+    return a->key_len == b->key_len && memcmp(a->key, b->key, a->key_len) == 0;
+}
+
+
+/* ============================================================================
+ * FUNZIONI: codifica
+ * ============================================================================
+ */
+
+int b_schema_is_sorted(const b_schema *schema) {
+
+    /* Input validation */
+    if(schema == NULL){
+        fprintf(stderr, "Error! NULL pointer parsed in function b_schema_is_sorted()! ");
+        exit(-1);
+    }
+
+    for (size_t i = 0; i < schema->n_fields; i++) {
+        const b_field *f = &schema->fields[i];
+        if (f->key_len > 99) {
+            return 0;
+        }
+        if (i > 0) {
+            const b_field *prev = &schema->fields[i - 1];
+            size_t min = prev->key_len < f->key_len ? prev->key_len : f->key_len;
+            int cmp = memcmp(prev->key, f->key, min);
+            if (cmp > 0 || (cmp == 0 && prev->key_len > f->key_len)) {
+                return 0;
+            }
+        }
+        if (f->sub != NULL && !b_schema_is_sorted(f->sub)) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/**
+ * @brief Lunghezza esatta della codifica di obj
+ *
+ * Per ogni campo presente: key_hdr_len + key_len + lunghezza del valore.
+ * Di più descrittori con la stessa chiave conta solo il primo presente.
+ */
+size_t bencode_struct_size(const b_schema *schema, const void *obj) {
+
+    /* Input validation */
+    if(schema == NULL || obj == NULL){
+        fprintf(stderr, "Error! NULL pointer parsed in function bencode_struct_size()! ");
+        exit(-1);
+    }
+
+    size_t total = 2;
+    int written = 0;
+    for (size_t i = 0; i < schema->n_fields; i++) {
+        const b_field *f = &schema->fields[i];
+        if (same_key_as_prev(schema, i) && written) {
+            continue;
+        }
+        written = field_present(f, obj);
+        if (written) {
+            total += f->key_hdr_len + f->key_len + value_size(f, obj);
+        }
+    }
+    return total;
+}
+
+size_t bencode_encode_struct(const b_schema *schema, const void *obj, char *buf) {
+
+    /* Input validation */
+    if(schema == NULL || obj == NULL || buf == NULL){
+        fprintf(stderr, "Error! NULL pointer parsed in function bencode_encode_struct()! ");
+        exit(-1);
+    }
+
+    size_t n = 0;
+    int written = 0;
+    buf[n++] = 'd';
+    for (size_t i = 0; i < schema->n_fields; i++) {
+        const b_field *f = &schema->fields[i];
+        if (same_key_as_prev(schema, i) && written) {
+            continue;
+        }
+        written = field_present(f, obj);
+        if (!written) {
+            continue;
+        }
+        /* Intestazione e chiave sono costanti: due copie brevi */
+        memcpy(buf + n, f->key_hdr, f->key_hdr_len);
+        n += f->key_hdr_len;
+        memcpy(buf + n, f->key, f->key_len);
+        n += f->key_len;
+        n += encode_value(f, obj, buf + n);
+    }
+    buf[n++] = 'e';
+    return n;
+}
+
+char* bencode_encode_struct_alloc(const b_schema *schema, const void *obj, size_t *len) {
+
+    /* Input validation */
+    if(schema == NULL || obj == NULL || len == NULL){
+        fprintf(stderr, "Error! NULL pointer parsed in function bencode_encode_struct_alloc()! ");
+        exit(-1);
+    }
+
+    uint64_t stats_t0 = b_stats_clock();
+    size_t size = bencode_struct_size(schema, obj);
+    char *buf = malloc(size);
+    if (buf == NULL) {
+        fprintf(stderr, "Malloc failed in function bencode_encode_struct_alloc!\n");
+        exit(-1);
+    }
+    *len = bencode_encode_struct(schema, obj, buf);
+    b_stats_record(B_STATS_ENCODE, stats_t0);
+    return buf;
+}
+
+
+/* ============================================================================
+ * SCHEMA: metainfo .torrent
+ * ============================================================================
+ */
+
+static const b_field torrent_file_fields[] = {
+    B_TORRENT_FILE_FIELDS(B_SCHEMA_FIELD, b_torrent_file)
+};
+const b_schema b_torrent_file_schema = B_SCHEMA(b_torrent_file, torrent_file_fields);
+
+static const b_field torrent_info_fields[] = {
+    B_TORRENT_INFO_FIELDS(B_SCHEMA_FIELD, b_torrent_info)
+};
+const b_schema b_torrent_info_schema = B_SCHEMA(b_torrent_info, torrent_info_fields);
+
+static const b_field torrent_meta_fields[] = {
+    B_TORRENT_META_FIELDS(B_SCHEMA_FIELD, b_torrent_meta)
+};
+const b_schema b_torrent_meta_schema = B_SCHEMA(b_torrent_meta, torrent_meta_fields);
@@ -0,0 +1,317 @@
+#ifndef SCHEMA_H
+#define SCHEMA_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+#include "structs.h"
+
+/* ============================================================================
+ * PANORAMICA: Decodifica guidata da schema in struct C
+ * ============================================================================
+ *
+ * La maggior parte degli utilizzatori vuole una struct fissa (nome, piece
+ * length, pieces, ...), non l'albero generico di b_obj. Uno schema è una
+ * tabella di descrittori:
+ *
+ *   chiave del dizionario → (tipo, offset del campo nella struct)
+ *
+ * b_schema_decode() riempie la struct in una sola passata sul buffer
+ * bencode, salta le chiavi sconosciute e non crea alcun b_obj. Stringhe e
+ * valori grezzi diventano b_span che puntano dentro il buffer originale
+ * (nessuna copia): il buffer deve restare valido finché la struct è usata.
+ *
+ * Le tabelle si scrivono con X-macro: un'unica lista di campi genera sia la
+ * struct (B_SCHEMA_MEMBER) sia i descrittori (B_SCHEMA_FIELD), vedi lo
+ * schema del metainfo .torrent in fondo a questo file.
+ *
+ * bencode_skip() è il validatore usato per saltare i valori: rispetta le
+ * regole bencode (niente zeri iniziali, niente "-0") e distingue un input
+ * non valido da uno troncato.
+ *
+ * ============================================================================
+ */
+
+#define B_SCHEMA_INVALID     -1   /* Bencode non valido */
+#define B_SCHEMA_INCOMPLETE  -2   /* Buffer terminato prima della fine del valore */
+#define B_SCHEMA_TYPE        -3   /* Valore di tipo diverso da quello dello schema */
+#define B_SCHEMA_MISSING     -4   /* Chiave obbligatoria assente */
+
+#define B_SCHEMA_MAX_DEPTH   256  /* Annidamento massimo di liste/dizionari */
+#define B_SCHEMA_MAX_FIELDS  64   /* Descrittori massimi per schema */
+
+#define B_FIELD_REQUIRED     0x1  /* La chiave deve essere presente */
+
+
+/* ============================================================================
+ * STRUCT: descrittori
+ * ============================================================================
+ */
+
+/**
+ * @enum b_field_type
+ * @brief Tipo del campo C corrispondente al valore bencode
+ *
+ * - B_FIELD_INT:   int64_t, valore "i...e"
+ * - B_FIELD_BYTES: b_span sul contenuto di una bytestring (senza "<n>:")
+ * - B_FIELD_RAW:   b_span sull'intera codifica di un valore qualsiasi
+ *                  (es. il dizionario info per calcolare l'info-hash)
+ * - B_FIELD_DICT:  struct annidata descritta da un sotto-schema
+ * - B_FIELD_LIST:  b_schema_array di elementi di tipo elem_type
+ */
+typedef enum {
+    B_FIELD_INT,
+    B_FIELD_BYTES,
+    B_FIELD_RAW,
+    B_FIELD_DICT,
+    B_FIELD_LIST
+} b_field_type;
+
+/**
+ * @struct b_schema_array
+ * @brief Array decodificato da una lista (allocato, liberato da b_schema_free)
+ *
+ * items contiene count elementi: int64_t, b_span o struct del sotto-schema.
+ */
+typedef struct {
+    void *items;
+    size_t count;
+} b_schema_array;
+
+struct b_schema;
+
+/**
+ * @struct b_field
+ * @brief Descrittore di una chiave
+ *
+ * Campi:
+ * - key, key_len: chiave del dizionario (byte, non null-terminated)
+ * - type:         tipo del campo
+ * - elem_type:    per B_FIELD_LIST, tipo degli elementi (non B_FIELD_LIST)
+ * - offset:       offset del campo nella struct
+ * - sub:          sotto-schema per B_FIELD_DICT (o liste di dizionari)
+ * - flags:        0 oppure B_FIELD_REQUIRED
+ * - key_hdr:      intestazione "<key_len>:" precalcolata a compile time
+ *                 (chiavi fino a 99 byte), usata dall'encoder
+ *
+ * Più descrittori consecutivi possono avere la stessa chiave: il valore
+ * viene decodificato in ognuno (es. info come B_FIELD_RAW e B_FIELD_DICT).
+ * In codifica viene scritto solo il primo presente.
+ */
+typedef struct b_field {
+    const char *key;
+    size_t key_len;
+    b_field_type type;
+    b_field_type elem_type;
+    size_t offset;
+    const struct b_schema *sub;
+    unsigned int flags;
+    char key_hdr[3];
+    unsigned char key_hdr_len;
+} b_field;
+
+/**
+ * @struct b_schema
+ * @brief Tabella dei descrittori di una struct
+ *
+ * Descrittori ordinati per chiave (come i dizionari bencode) rendono la
+ * ricerca O(1) per chiave: ogni chiave è cercata prima dopo l'ultima trovata.
+ */
+typedef struct b_schema {
+    const b_field *fields;
+    size_t n_fields;
+    size_t struct_size;
+} b_schema;
+
+
+/* ============================================================================
+ * MACRO: tabelle con X-macro
+ * ============================================================================
+ *
+ * Una lista di campi ha la forma:
+ *
+ *   #define MY_FIELDS(X, st) \
+ *       X(st, int64_t, piece_len, "piece length", B_FIELD_INT, B_FIELD_INT, NULL, B_FIELD_REQUIRED) \
+ *       X(st, b_span,  name,      "name",         B_FIELD_BYTES, B_FIELD_INT, NULL, 0)
+ *
+ *   typedef struct { MY_FIELDS(B_SCHEMA_MEMBER, my_struct) } my_struct;
+ *   static const b_field my_fields[] = { MY_FIELDS(B_SCHEMA_FIELD, my_struct) };
+ *   const b_schema my_schema = B_SCHEMA(my_struct, my_fields);
+ */
+
+#define B_SCHEMA_MEMBER(st, ctype, member, key, type, elem, sub, flags) \
+    ctype member;
+
+#define B_SCHEMA_FIELD(st, ctype, member, key, type, elem, sub, flags) \
+    { key, sizeof(key) - 1, type, elem, offsetof(st, member), sub, flags, \
+      B_SCHEMA_KEY_HDR(key) },
+
+/* "<len>:" come costanti carattere: "6:" per "length", "12:" per "piece length".
+ * Una chiave di 100 byte o più non compila (array di dimensione negativa) */
+#define B_SCHEMA_KEY_HDR(key) \
+    { (sizeof(key) - 1) >= 10 ? '0' + (sizeof(key) - 1) / 10 : '0' + (sizeof(key) - 1), \
+      (sizeof(key) - 1) >= 10 ? '0' + (sizeof(key) - 1) % 10 : ':', \
+      ':' }, \
+    ((sizeof(key) - 1) >= 10 ? 3 : 2) + 0 * sizeof(char[(sizeof(key) - 1) < 100 ? 1 : -1])
+
+#define B_SCHEMA(st, fields) \
+    { fields, sizeof(fields) / sizeof((fields)[0]), sizeof(st) }
+
+
+/* ============================================================================
+ * FUNZIONI: lettura scalari
+ * ============================================================================
+ */
+
+/**
+ * @brief Legge l'intero "i<n>e" che inizia in buf[pos]
+ *
+ * @param out Riempito con il valore (può essere NULL)
+ *
+ * @return Offset dopo 'e', oppure B_SCHEMA_INVALID / B_SCHEMA_INCOMPLETE /
+ *         B_SCHEMA_TYPE (buf[pos] non è 'i')
+ */
+ssize_t bencode_read_int(const char *buf, size_t len, size_t pos, int64_t *out);
+
+/**
+ * @brief Legge la bytestring "<n>:<dati>" che inizia in buf[pos]
+ *
+ * @param out Riempito con il contenuto, dentro buf (può essere NULL)
+ *
+ * @return Offset dopo i dati, oppure B_SCHEMA_INVALID / B_SCHEMA_INCOMPLETE /
+ *         B_SCHEMA_TYPE (buf[pos] non è una cifra)
+ */
+ssize_t bencode_read_bytes(const char *buf, size_t len, size_t pos, b_span *out);
+
+
+/* ============================================================================
+ * FUNZIONI: validazione e decodifica
+ * ============================================================================
+ */
+
+/**
+ * @brief Salta il valore bencode che inizia in buf[pos], validandolo
+ *
+ * @return Offset del primo byte dopo il valore, oppure B_SCHEMA_INVALID /
+ *         B_SCHEMA_INCOMPLETE
+ */
+ssize_t bencode_skip(const char *buf, size_t len, size_t pos);
+
+/**
+ * @brief Decodifica il dizionario in buf[0..len) nella struct out
+ *
+ * out viene azzerata (schema->struct_size byte) e riempita. Le chiavi
+ * sconosciute sono saltate; una chiave dello schema ripetuta nello stesso
+ * dizionario dà B_SCHEMA_INVALID. In caso di errore gli array già allocati
+ * sono liberati e out resta azzerata.
+ *
+ * @return Byte consumati (> 0), oppure un codice B_SCHEMA_* negativo
+ */
+ssize_t b_schema_decode(const b_schema *schema, const char *buf, size_t len, void *out);
+
+/**
+ * @brief Libera gli array allocati da b_schema_decode() (non la struct)
+ */
+void b_schema_free(const b_schema *schema, void *out);
+
+
+/* ============================================================================
+ * FUNZIONI: codifica
+ * ============================================================================
+ *
+ * Codifica canonica di una struct senza passare da b_obj/dict_add(): le
+ * chiavi sono scritte nell'ordine dei descrittori, che devono quindi essere
+ * ordinati per chiave (b_schema_is_sorted() lo verifica una volta sola).
+ *
+ * Campi omessi: un campo senza B_FIELD_REQUIRED non viene scritto se vuoto
+ * (intero 0, b_span con ptr NULL, lista con count 0). I dizionari annidati
+ * sono sempre scritti, i B_FIELD_RAW con ptr NULL mai. Di più descrittori
+ * con la stessa chiave viene scritto il primo presente.
+ */
+
+/**
+ * @brief 1 se i descrittori (e i sotto-schemi) sono in ordine di chiave
+ */
+int b_schema_is_sorted(const b_schema *schema);
+
+/**
+ * @brief Lunghezza esatta della codifica di obj
+ */
+size_t bencode_struct_size(const b_schema *schema, const void *obj);
+
+/**
+ * @brief Codifica obj in buf, che deve avere almeno bencode_struct_size() byte
+ *
+ * @return Byte scritti
+ */
+size_t bencode_encode_struct(const b_schema *schema, const void *obj, char *buf);
+
+/**
+ * @brief Codifica obj in un buffer allocato esattamente una volta
+ *
+ * @param len Riempito con la lunghezza della codifica
+ *
+ * @return Buffer di *len byte (non null-terminated), da liberare con free()
+ */
+char* bencode_encode_struct_alloc(const b_schema *schema, const void *obj, size_t *len);
+
+
+/* ============================================================================
+ * SCHEMA: metainfo .torrent
+ * ============================================================================
+ */
+
+#define B_TORRENT_FILE_FIELDS(X, st) \
+    X(st, int64_t,        length, "length", B_FIELD_INT,  B_FIELD_INT,   NULL, B_FIELD_REQUIRED) \
+    X(st, b_schema_array, path,   "path",   B_FIELD_LIST, B_FIELD_BYTES, NULL, B_FIELD_REQUIRED)
+
+/**
+ * @struct b_torrent_file
+ * @brief Elemento di info.files (path: array di b_span)
+ */
+typedef struct {
+    B_TORRENT_FILE_FIELDS(B_SCHEMA_MEMBER, b_torrent_file)
+} b_torrent_file;
+
+extern const b_schema b_torrent_file_schema;
+
+#define B_TORRENT_INFO_FIELDS(X, st) \
+    X(st, b_schema_array, files,        "files",        B_FIELD_LIST,  B_FIELD_DICT, &b_torrent_file_schema, 0) \
+    X(st, int64_t,        length,       "length",       B_FIELD_INT,   B_FIELD_INT,  NULL, 0) \
+    X(st, b_span,         name,         "name",         B_FIELD_BYTES, B_FIELD_INT,  NULL, B_FIELD_REQUIRED) \
+    X(st, int64_t,        piece_length, "piece length", B_FIELD_INT,   B_FIELD_INT,  NULL, B_FIELD_REQUIRED) \
+    X(st, b_span,         pieces,       "pieces",       B_FIELD_BYTES, B_FIELD_INT,  NULL, B_FIELD_REQUIRED) \
+    X(st, int64_t,        is_private,   "private",      B_FIELD_INT,   B_FIELD_INT,  NULL, 0)
+
+/**
+ * @struct b_torrent_info
+ * @brief Dizionario info (files.count = 0 per torrent single-file)
+ */
+typedef struct {
+    B_TORRENT_INFO_FIELDS(B_SCHEMA_MEMBER, b_torrent_info)
+} b_torrent_info;
+
+extern const b_schema b_torrent_info_schema;
+
+#define B_TORRENT_META_FIELDS(X, st) \
+    X(st, b_span,         announce,      "announce",      B_FIELD_BYTES, B_FIELD_INT, NULL, 0) \
+    X(st, b_span,         announce_list, "announce-list", B_FIELD_RAW,   B_FIELD_INT, NULL, 0) \
+    X(st, b_span,         comment,       "comment",       B_FIELD_BYTES, B_FIELD_INT, NULL, 0) \
+    X(st, b_span,         created_by,    "created by",    B_FIELD_BYTES, B_FIELD_INT, NULL, 0) \
+    X(st, int64_t,        creation_date, "creation date", B_FIELD_INT,   B_FIELD_INT, NULL, 0) \
+    X(st, b_span,         info_raw,      "info",          B_FIELD_RAW,   B_FIELD_INT, NULL, B_FIELD_REQUIRED) \
+    X(st, b_torrent_info, info,          "info",          B_FIELD_DICT,  B_FIELD_INT, &b_torrent_info_schema, B_FIELD_REQUIRED)
+
+/**
+ * @struct b_torrent_meta
+ * @brief Metainfo completo (info_raw: codifica di info per l'info-hash)
+ */
+typedef struct {
+    B_TORRENT_META_FIELDS(B_SCHEMA_MEMBER, b_torrent_meta)
+} b_torrent_meta;
+
+extern const b_schema b_torrent_meta_schema;
+
+
+#endif  /* SCHEMA_H */
@@ -0,0 +1,245 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "split.h"
+
+/* ============================================================================
+ * FUNZIONI: suddivisione
+ * ============================================================================
+ */
+
+void b_split_init(b_splitter *sp, int mode) {
+
+    /* Input validation */
+    if(sp == NULL){
+        fprintf(stderr, "Error! NULL pointer parsed in function b_split_init()! ");
+        exit(-1);
+    }
+
+    sp->mode = mode;
+    sp->pos = 0;
+    sp->count = 0;
+}
+
+int b_split_next(b_splitter *sp, const char *buf, size_t len, b_range *out) {
+
+    /* Input validation */
+    if(sp == NULL || out == NULL || (buf == NULL && len > 0)){
+        fprintf(stderr, "Error! NULL pointer parsed in function b_split_next()! ");
+        exit(-1);
+    }
+
+    if (sp->pos >= len) {
+        return 0;
+    }
+
+    if (sp->mode == B_SPLIT_U32BE) {
+        if (len - sp->pos < 4) {
+            return B_SCHEMA_INCOMPLETE;
+        }
+        const unsigned char *p = (const unsigned char *)buf + sp->pos;
+        size_t doc_len = ((size_t)p[0] << 24) | ((size_t)p[1] << 16) |
+                         ((size_t)p[2] << 8) | (size_t)p[3];
+        if (len - sp->pos - 4 < doc_len) {
+            return B_SCHEMA_INCOMPLETE;
+        }
+        out->offset = sp->pos + 4;
+        out->len = doc_len;
+        sp->pos += 4 + doc_len;
+        sp->count++;
+        return 1;
+    }
+
+    ssize_t end = bencode_skip(buf, len, sp->pos);
+    if (end < 0) {
+        return (int)end;
+    }
+    out->offset = sp->pos;
+    out->len = (size_t)end - sp->pos;
+    sp->pos = (size_t)end;
+    sp->count++;
+    return 1;
+}
+
+void b_split_rebase(b_splitter *sp, size_t shift) {
+
+    /* Input validation */
+    if(sp == NULL){
+        fprintf(stderr, "Error! NULL pointer parsed in function b_split_rebase()! ");
+        exit(-1);
+    }
+
+    sp->pos = shift > sp->pos ? 0 : sp->pos - shift;
+}
+
+ssize_t b_split_all(const char *buf, size_t len, int mode, b_range **ranges) {
+
+    /* Input validation */
+    if(ranges == NULL || (buf == NULL && len > 0)){
+        fprintf(stderr, "Error! NULL pointer parsed in function b_split_all()! ");
+        exit(-1);
+    }
+
+    b_splitter sp;
+    b_split_init(&sp, mode);
+
+    size_t cap = 64, n = 0;
+    b_range *out = malloc(cap * sizeof(b_range));
+    if (out == NULL) {
+        fprintf(stderr, "Malloc failed in function b_split_all!\n");
+        exit(-1);
+    }
+
+    int rc;
+    b_range r;
+    while ((rc = b_split_next(&sp, buf, len, &r)) > 0) {
+        if (n == cap) {
+            cap *= 2;
+            b_range *grown = realloc(out, cap * sizeof(b_range));
+            if (grown == NULL) {
+                fprintf(stderr, "Malloc failed in function b_split_all!\n");
+                exit(-1);
+            }
+            out = grown;
+        }
+        out[n++] = r;
+    }
+    if (rc < 0) {
+        free(out);
+        *ranges = NULL;
+        return rc;
+    }
+
+    *ranges = out;
+    return (ssize_t)n;
+}
+
+
+/* ============================================================================
+ * HELPER: coda limitata splitter → worker
+ * ============================================================================
+ */
+
+typedef struct {
+    b_range range;
+    size_t index;
+} split_item;
+
+typedef struct {
+    pthread_mutex_t lock;
+    pthread_cond_t not_empty;
+    pthread_cond_t not_full;
+    split_item items[B_SPLIT_QUEUE];
+    size_t head, count;
+    int done;
+
+    const char *buf;
+    b_split_cb cb;
+    void *ctx;
+} split_queue;
+
+static void* split_worker(void *arg) {
+    split_queue *q = arg;
+
+    while (1) {
+        pthread_mutex_lock(&q->lock);
+        while (q->count == 0 && !q->done) {
+            pthread_cond_wait(&q->not_empty, &q->lock);
+        }
+        if (q->count == 0) {
+            pthread_mutex_unlock(&q->lock);
+            return NULL;
+        }
+        split_item item = q->items[q->head];
+        q->head = (q->head + 1) % B_SPLIT_QUEUE;
+        q->count--;
+        pthread_cond_signal(&q->not_full);
+        pthread_mutex_unlock(&q->lock);
+
+        q->cb(q->ctx, q->buf + item.range.offset, item.range.len, item.index);
+    }
+}
+
+static void queue_push(split_queue *q, const b_range *range, size_t index) {
+    pthread_mutex_lock(&q->lock);
+    while (q->count == B_SPLIT_QUEUE) {
+        pthread_cond_wait(&q->not_full, &q->lock);
+    }
+    split_item *item = &q->items[(q->head + q->count) % B_SPLIT_QUEUE];
+    item->range = *range;
+    item->index = index;
+    q->count++;
+    pthread_cond_signal(&q->not_empty);
+    pthread_mutex_unlock(&q->lock);
+}
+
+
+/* ============================================================================
+ * FUNZIONI: distribuzione ai worker
+ * ============================================================================
+ */
+
+ssize_t b_split_run(const char *buf, size_t len, int mode, int n_threads,
+                    b_split_cb cb, void *ctx) {
+
+    /* Input validation */
+    if(cb == NULL || (buf == NULL && len > 0)){
+        fprintf(stderr, "Error! NULL pointer parsed in function b_split_run()! ");
+        exit(-1);
+    }
+
+    b_splitter sp;
+    b_split_init(&sp, mode);
+    b_range r;
+    int rc;
+
+    if (n_threads <= 1) {
+        while ((rc = b_split_next(&sp, buf, len, &r)) > 0) {
+            cb(ctx, buf + r.offset, r.len, sp.count - 1);
+        }
+        return rc < 0 ? rc : (ssize_t)sp.count;
+    }
+
+    split_queue *q = calloc(1, sizeof(split_queue));
+    pthread_t *threads = malloc(sizeof(pthread_t) * (size_t)n_threads);
+    if (q == NULL || threads == NULL) {
+        fprintf(stderr, "Malloc failed in function b_split_run!\n");
+        exit(-1);
+    }
+    pthread_mutex_init(&q->lock, NULL);
+    pthread_cond_init(&q->not_empty, NULL);
+    pthread_cond_init(&q->not_full, NULL);
+    q->buf = buf;
+    q->cb = cb;
+    q->ctx = ctx;
+
+    for (int t = 0; t < n_threads; t++) {
+        if (pthread_create(&threads[t], NULL, split_worker, q) != 0) {
+            fprintf(stderr, "Error! pthread_create failed in function b_split_run!\n");
+            exit(-1);
+        }
+    }
+
+    while ((rc = b_split_next(&sp, buf, len, &r)) > 0) {
+        queue_push(q, &r, sp.count - 1);
+    }
+
+    pthread_mutex_lock(&q->lock);
+    q->done = 1;
+    pthread_cond_broadcast(&q->not_empty);
+    pthread_mutex_unlock(&q->lock);
+
+    for (int t = 0; t < n_threads; t++) {
+        pthread_join(threads[t], NULL);
+    }
+
+    pthread_cond_destroy(&q->not_full);
+    pthread_cond_destroy(&q->not_empty);
+    pthread_mutex_destroy(&q->lock);
+    free(threads);
+    free(q);
+
+    return rc < 0 ? rc : (ssize_t)sp.count;
+}
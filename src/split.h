@@ -0,0 +1,125 @@
+#ifndef SPLIT_H
+#define SPLIT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+#include "schema.h"
+
+/* ============================================================================
+ * PANORAMICA: Suddivisione di archivi di documenti concatenati
+ * ============================================================================
+ *
+ * Gli archivi sono file segmento con molti .torrent in fila, in due formati:
+ *
+ *   - B_SPLIT_CONCAT: documenti bencode semplicemente concatenati. Il
+ *     confine si trova con bencode_skip(), che salta il contenuto delle
+ *     bytestring leggendo solo l'intestazione "<n>:": i "pieces" (la quasi
+ *     totalità dei byte) non vengono mai scanditi
+ *   - B_SPLIT_U32BE: ogni documento è preceduto dalla sua lunghezza su 4
+ *     byte big-endian; il confine costa una lettura
+ *
+ * Lo splitter produce intervalli (offset, len) senza decodificare nulla.
+ * b_split_run() li distribuisce a un gruppo di thread che chiamano una
+ * callback per ogni documento, così rielaborare un archivio è limitato
+ * dall'I/O e non da un decode_dict() a thread singolo.
+ *
+ * Per l'uso in streaming b_split_next() distingue un documento troncato in
+ * fondo al buffer (B_SCHEMA_INCOMPLETE: leggere altri byte e riprovare)
+ * da un input non valido.
+ *
+ * ============================================================================
+ */
+
+#define B_SPLIT_CONCAT   0   /* Documenti concatenati */
+#define B_SPLIT_U32BE    1   /* Prefisso di lunghezza a 32 bit big-endian */
+
+#define B_SPLIT_QUEUE    256 /* Intervalli in coda tra splitter e worker */
+
+
+/* ============================================================================
+ * STRUCT: splitter
+ * ============================================================================
+ */
+
+/**
+ * @struct b_range
+ * @brief Documento nel buffer: buf[offset .. offset + len)
+ */
+typedef struct {
+    size_t offset;
+    size_t len;
+} b_range;
+
+/**
+ * @struct b_splitter
+ * @brief Stato dello splitter
+ *
+ * Campi:
+ * - mode:  B_SPLIT_CONCAT o B_SPLIT_U32BE
+ * - pos:   offset del prossimo documento nel buffer corrente
+ * - count: documenti trovati finora
+ */
+typedef struct {
+    int mode;
+    size_t pos;
+    size_t count;
+} b_splitter;
+
+/**
+ * @brief Callback per ogni documento (index: posizione nell'archivio)
+ *
+ * Chiamata in parallelo da più thread: ctx deve essere thread-safe.
+ */
+typedef void (*b_split_cb)(void *ctx, const char *doc, size_t len, size_t index);
+
+
+/* ============================================================================
+ * FUNZIONI: suddivisione
+ * ============================================================================
+ */
+
+/**
+ * @brief Inizializza uno splitter all'offset 0
+ */
+void b_split_init(b_splitter *sp, int mode);
+
+/**
+ * @brief Trova il prossimo documento in buf[sp->pos .. len)
+ *
+ * @return 1 se trovato (out riempito, sp->pos avanzato), 0 se sp->pos == len,
+ *         B_SCHEMA_INCOMPLETE se l'ultimo documento è troncato,
+ *         B_SCHEMA_INVALID se a sp->pos non inizia un documento valido
+ */
+int b_split_next(b_splitter *sp, const char *buf, size_t len, b_range *out);
+
+/**
+ * @brief Adegua sp->pos dopo che i primi shift byte del buffer sono stati scartati
+ */
+void b_split_rebase(b_splitter *sp, size_t shift);
+
+/**
+ * @brief Tutti i documenti di buf in un array allocato
+ *
+ * @param ranges Riempito con l'array (da liberare con free())
+ *
+ * @return Numero di documenti, oppure B_SCHEMA_INVALID / B_SCHEMA_INCOMPLETE
+ */
+ssize_t b_split_all(const char *buf, size_t len, int mode, b_range **ranges);
+
+/**
+ * @brief Suddivide buf e passa ogni documento a cb su n_threads thread
+ *
+ * Il thread chiamante fa da splitter e mette gli intervalli in una coda
+ * limitata (B_SPLIT_QUEUE); i worker li prelevano. Con n_threads <= 1 la
+ * callback è chiamata direttamente, in ordine.
+ *
+ * @return Documenti consegnati, oppure un codice B_SCHEMA_* negativo (i
+ *         documenti prima dell'errore sono stati comunque consegnati)
+ */
+ssize_t b_split_run(const char *buf, size_t len, int mode, int n_threads,
+                    b_split_cb cb, void *ctx);
+
+
+#endif  /* SPLIT_H */
@@ -0,0 +1,328 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "stats.h"
+
+/* ============================================================================
+ * HELPER: bucket
+ * ============================================================================
+ */
+
+static size_t bucket_index(uint64_t v) {
+    if (v < B_HIST_SUB) {
+        return (size_t)v;
+    }
+    if (v >> B_HIST_MAX_BITS) {
+        v = (1ull << B_HIST_MAX_BITS) - 1;
+    }
+    int e = 63 - __builtin_clzll(v);
+    int shift = e - B_HIST_SUB_BITS;
+    return B_HIST_SUB + (size_t)shift * B_HIST_SUB + (size_t)((v >> shift) - B_HIST_SUB);
+}
+
+/**
+ * @brief Valore più alto che cade nel bucket idx
+ */
+static uint64_t bucket_high(size_t idx) {
+    if (idx < B_HIST_SUB) {
+        return idx;
+    }
+    size_t k = idx - B_HIST_SUB;
+    int shift = (int)(k / B_HIST_SUB);
+    uint64_t low = (uint64_t)(B_HIST_SUB + k % B_HIST_SUB) << shift;
+    return low + (1ull << shift) - 1;
+}
+
+
+/* ============================================================================
+ * FUNZIONI: istogramma
+ * ============================================================================
+ */
+
+void b_hist_init(b_hist *h) {
+
+    /* Input validation */
+    if(h == NULL){
+        fprintf(stderr, "Error! NULL pointer parsed in function b_hist_init()! ");
+        exit(-1);
+    }
+
+    memset(h, 0, sizeof(*h));
+    h->min = UINT64_MAX;
+}
+
+void b_hist_record(b_hist *h, uint64_t v) {
+
+    /* Input validation */
+    if(h == NULL){
+        fprintf(stderr, "Error! NULL pointer parsed in function b_hist_record()! ");
+        exit(-1);
+    }
+
+    h->buckets[bucket_index(v)]++;
+    h->count++;
+    h->sum += v;
+    if (v < h->min) {
+        h->min = v;
+    }
+    if (v > h->max) {
+        h->max = v;
+    }
+}
+
+void b_hist_merge(b_hist *dst, const b_hist *src) {
+
+    /* Input validation */
+    if(dst == NULL || src == NULL){
+        fprintf(stderr, "Error! NULL pointer parsed in function b_hist_merge()! ");
+        exit(-1);
+    }
+
+    for (size_t i = 0; i < B_HIST_BUCKETS; i++) {
+        dst->buckets[i] += src->buckets[i];
+    }
+    dst->count += src->count;
+    dst->sum += src->sum;
+    if (src->min < dst->min) {
+        dst->min = src->min;
+    }
+    if (src->max > dst->max) {
+        dst->max = src->max;
+    }
+}
+
+uint64_t b_hist_percentile(const b_hist *h, double p) {
+
+    /* Input validation */
+    if(h == NULL){
+        fprintf(stderr, "Error! NULL pointer parsed in function b_hist_percentile()! ");
+        exit(-1);
+    }
+
+    if (h->count == 0) {
+        return 0;
+    }
+    if (p <= 0) {
+        return h->min;
+    }
+
+    uint64_t target = (uint64_t)((p / 100.0) * (double)h->count + 0.5);
+    if (target < 1) {
+        target = 1;
+    }
+    if (target > h->count) {
+        target = h->count;
+    }
+
+    uint64_t seen = 0;
+    for (size_t i = 0; i < B_HIST_BUCKETS; i++) {
+        seen += h->buckets[i];
+        if (seen >= target) {
+            uint64_t high = bucket_high(i);
+            return high < h->max ? high : h->max;
+        }
+    }
+    return h->max;
+}
+
+void b_hist_report(FILE *out, const char *label, const b_hist *h) {
+
+    /* Input validation */
+    if(out == NULL || label == NULL || h == NULL){
+        fprintf(stderr, "Error! NULL pointer parsed in function b_hist_report()! ");
+        exit(-1);
+    }
+
+    if (h->count == 0) {
+        fprintf(out, "%-24s nessun campione\n", label);
+        return;
+    }
+    fprintf(out, "%-24s n %llu  media %.0f ns  p50 %llu  p90 %llu  p99 %llu  p99.9 %llu  max %llu ns\n",
+            label, (unsigned long long)h->count, (double)h->sum / (double)h->count,
+            (unsigned long long)b_hist_percentile(h, 50.0),
+            (unsigned long long)b_hist_percentile(h, 90.0),
+            (unsigned long long)b_hist_percentile(h, 99.0),
+            (unsigned long long)b_hist_percentile(h, 99.9),
+            (unsigned long long)h->max);
+}
+
+
+/* ============================================================================
+ * HELPER: slot per thread
+ * ============================================================================
+ */
+
+/**
+ * @struct stats_slot
+ * @brief Istogrammi di un thread (scritti solo dal proprietario)
+ */
+typedef struct {
+    b_hist hist[B_STATS_OPS];
+} stats_slot;
+
+static int stats_on;
+static stats_slot *slots[B_STATS_MAX_THREADS];
+static int slot_used[B_STATS_MAX_THREADS];
+
+static __thread stats_slot *my_slot;
+static __thread int my_slot_failed;
+static pthread_key_t slot_key;
+static pthread_once_t slot_key_once = PTHREAD_ONCE_INIT;
+
+/**
+ * @brief Rilascia lo slot all'uscita del thread (i conteggi restano)
+ */
+static void slot_release(void *arg) {
+    size_t i = (size_t)arg - 1;
+    __atomic_store_n(&slot_used[i], 0, __ATOMIC_RELEASE);
+}
+
+static void slot_key_create(void) {
+    if (pthread_key_create(&slot_key, slot_release) != 0) {
+        fprintf(stderr, "Error! pthread_key_create failed in function b_stats_record!\n");
+        exit(-1);
+    }
+}
+
+static stats_slot* slot_claim(void) {
+    pthread_once(&slot_key_once, slot_key_create);
+
+    for (size_t i = 0; i < B_STATS_MAX_THREADS; i++) {
+        int expected = 0;
+        if (!__atomic_compare_exchange_n(&slot_used[i], &expected, 1, 0,
+                                         __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) {
+            continue;
+        }
+
+        stats_slot *s = __atomic_load_n(&slots[i], __ATOMIC_ACQUIRE);
+        if (s == NULL) {
+            s = malloc(sizeof(stats_slot));
+            if (s == NULL) {
+                fprintf(stderr, "Malloc failed in function b_stats_record!\n");
+                exit(-1);
+            }
+            for (int op = 0; op < B_STATS_OPS; op++) {
+                b_hist_init(&s->hist[op]);
+            }
+            __atomic_store_n(&slots[i], s, __ATOMIC_RELEASE);
+        }
+        pthread_setspecific(slot_key, (void *)(i + 1));
+        return s;
+    }
+    return NULL;
+}
+
+/**
+ * @brief Come b_hist_record() con store atomici: un solo scrittore, letture
+ *        concorrenti da b_stats_snapshot()
+ */
+static void slot_record(b_hist *h, uint64_t v) {
+    uint64_t *b = &h->buckets[bucket_index(v)];
+    __atomic_store_n(b, *b + 1, __ATOMIC_RELAXED);
+    __atomic_store_n(&h->count, h->count + 1, __ATOMIC_RELAXED);
+    __atomic_store_n(&h->sum, h->sum + v, __ATOMIC_RELAXED);
+    if (v < __atomic_load_n(&h->min, __ATOMIC_RELAXED)) {
+        __atomic_store_n(&h->min, v, __ATOMIC_RELAXED);
+    }
+    if (v > __atomic_load_n(&h->max, __ATOMIC_RELAXED)) {
+        __atomic_store_n(&h->max, v, __ATOMIC_RELAXED);
+    }
+}
+
+
+/* ============================================================================
+ * FUNZIONI: statistiche dei punti di ingresso
+ * ============================================================================
+ */
+
+void b_stats_enable(int on) {
+    __atomic_store_n(&stats_on, on != 0, __ATOMIC_RELAXED);
+}
+
+int b_stats_enabled(void) {
+    return __atomic_load_n(&stats_on, __ATOMIC_RELAXED);
+}
+
+uint64_t b_stats_clock(void) {
+    if (!__builtin_expect(__atomic_load_n(&stats_on, __ATOMIC_RELAXED), 0)) {
+        return 0;
+    }
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+void b_stats_record(int op, uint64_t start) {
+    if (start == 0 || op < 0 || op >= B_STATS_OPS) {
+        return;
+    }
+
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    uint64_t now = (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+
+    if (my_slot == NULL) {
+        if (my_slot_failed) {
+            return;
+        }
+        my_slot = slot_claim();
+        if (my_slot == NULL) {
+            my_slot_failed = 1;
+            return;
+        }
+    }
+    slot_record(&my_slot->hist[op], now - start);
+}
+
+void b_stats_snapshot(int op, b_hist *out) {
+
+    /* Input validation */
+    if(out == NULL || op < 0 || op >= B_STATS_OPS){
+        fprintf(stderr, "Error! Invalid argument parsed in function b_stats_snapshot()! ");
+        exit(-1);
+    }
+
+    b_hist_init(out);
+    for (size_t i = 0; i < B_STATS_MAX_THREADS; i++) {
+        stats_slot *s = __atomic_load_n(&slots[i], __ATOMIC_ACQUIRE);
+        if (s == NULL) {
+            continue;
+        }
+        b_hist *h = &s->hist[op];
+        for (size_t b = 0; b < B_HIST_BUCKETS; b++) {
+            out->buckets[b] += __atomic_load_n(&h->buckets[b], __ATOMIC_RELAXED);
+        }
+        out->count += __atomic_load_n(&h->count, __ATOMIC_RELAXED);
+        out->sum += __atomic_load_n(&h->sum, __ATOMIC_RELAXED);
+        uint64_t min = __atomic_load_n(&h->min, __ATOMIC_RELAXED);
+        uint64_t max = __atomic_load_n(&h->max, __ATOMIC_RELAXED);
+        if (min < out->min) {
+            out->min = min;
+        }
+        if (max > out->max) {
+            out->max = max;
+        }
+    }
+}
+
+void b_stats_reset(void) {
+    for (size_t i = 0; i < B_STATS_MAX_THREADS; i++) {
+        stats_slot *s = __atomic_load_n(&slots[i], __ATOMIC_ACQUIRE);
+        if (s == NULL) {
+            continue;
+        }
+        for (int op = 0; op < B_STATS_OPS; op++) {
+            b_hist *h = &s->hist[op];
+            for (size_t b = 0; b < B_HIST_BUCKETS; b++) {
+                __atomic_store_n(&h->buckets[b], 0, __ATOMIC_RELAXED);
+            }
+            __atomic_store_n(&h->count, 0, __ATOMIC_RELAXED);
+            __atomic_store_n(&h->sum, 0, __ATOMIC_RELAXED);
+            __atomic_store_n(&h->min, UINT64_MAX, __ATOMIC_RELAXED);
+            __atomic_store_n(&h->max, 0, __ATOMIC_RELAXED);
+        }
+    }
+}
@@ -0,0 +1,144 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/* ============================================================================
+ * PANORAMICA: Istogrammi di latenza per decodifica e codifica
+ * ============================================================================
+ *
+ * Lo SLA di un nodo DHT è sul p99 della decodifica, non sulla media. Con
+ * b_stats_enable(1) ogni chiamata ai punti di ingresso registra la propria
+ * durata (ns) in un istogramma log-lineare stile HDR:
+ *
+ *   - valori < 2^B_HIST_SUB_BITS: un bucket per valore (esatti)
+ *   - oltre: ogni potenza di 2 è divisa in 2^B_HIST_SUB_BITS bucket
+ *     lineari, errore relativo massimo 1 / 2^B_HIST_SUB_BITS (~3%)
+ *   - valori oltre 2^B_HIST_MAX_BITS ns (~18 minuti) finiscono nell'ultimo
+ *     bucket
+ *
+ * Ogni thread scrive in un proprio slot (preso con una CAS al primo
+ * campione e liberato all'uscita del thread), quindi la registrazione non
+ * usa lock né atomici read-modify-write. b_stats_snapshot() somma gli
+ * slot: i conteggi sono additivi e uno slot riusato da un nuovo thread
+ * continua ad accumulare.
+ *
+ * Operazioni registrate:
+ *
+ *   B_STATS_DECODE  decode_dict()/decode_list() (radice), pdecode,
+ *                   b_schema_decode()
+ *   B_STATS_ENCODE  bencode_encode_alloc(), b_iovec_enc_write(),
+ *                   bencode_encode_struct_alloc()
+ *
+ * Da disabilitate costano un load e un salto, senza lettura del clock.
+ *
+ * ============================================================================
+ */
+
+#define B_HIST_SUB_BITS      5
+#define B_HIST_MAX_BITS      40
+#define B_HIST_SUB           (1u << B_HIST_SUB_BITS)
+#define B_HIST_BUCKETS       (B_HIST_SUB * (B_HIST_MAX_BITS - B_HIST_SUB_BITS + 1))
+
+#define B_STATS_DECODE       0
+#define B_STATS_ENCODE       1
+#define B_STATS_OPS          2
+
+#define B_STATS_MAX_THREADS  128   /* Oltre, i campioni vengono scartati */
+
+
+/* ============================================================================
+ * STRUCT: istogramma
+ * ============================================================================
+ */
+
+/**
+ * @struct b_hist
+ * @brief Istogramma log-lineare (min = UINT64_MAX se vuoto)
+ */
+typedef struct {
+    uint64_t count;
+    uint64_t sum;
+    uint64_t min, max;
+    uint64_t buckets[B_HIST_BUCKETS];
+} b_hist;
+
+
+/* ============================================================================
+ * FUNZIONI: istogramma
+ * ============================================================================
+ */
+
+/**
+ * @brief Azzera h
+ */
+void b_hist_init(b_hist *h);
+
+/**
+ * @brief Aggiunge il valore v
+ */
+void b_hist_record(b_hist *h, uint64_t v);
+
+/**
+ * @brief Somma src in dst
+ */
+void b_hist_merge(b_hist *dst, const b_hist *src);
+
+/**
+ * @brief Valore al percentile p (0..100)
+ *
+ * @return Limite superiore del bucket che contiene il percentile (mai
+ *         oltre max), 0 se l'istogramma è vuoto
+ */
+uint64_t b_hist_percentile(const b_hist *h, double p);
+
+/**
+ * @brief Stampa conteggio, media, p50/p90/p99/p99.9 e massimo
+ */
+void b_hist_report(FILE *out, const char *label, const b_hist *h);
+
+
+/* ============================================================================
+ * FUNZIONI: statistiche dei punti di ingresso
+ * ============================================================================
+ */
+
+/**
+ * @brief Attiva (on = 1) o disattiva la registrazione
+ */
+void b_stats_enable(int on);
+
+/**
+ * @brief 1 se la registrazione è attiva
+ */
+int b_stats_enabled(void);
+
+/**
+ * @brief Istante di inizio di una chiamata (0 se la registrazione è spenta)
+ */
+uint64_t b_stats_clock(void);
+
+/**
+ * @brief Registra la durata di una chiamata iniziata in start
+ *
+ * Non fa nulla se start è 0 (registrazione spenta all'ingresso).
+ */
+void b_stats_record(int op, uint64_t start);
+
+/**
+ * @brief Unisce gli istogrammi di tutti i thread per l'operazione op
+ */
+void b_stats_snapshot(int op, b_hist *out);
+
+/**
+ * @brief Azzera gli istogrammi
+ *
+ * Da chiamare senza chiamate in corso: i campioni concorrenti possono
+ * andare persi o sopravvivere all'azzeramento.
+ */
+void b_stats_reset(void);
+
+
+#endif  /* STATS_H */
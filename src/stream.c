@@ -0,0 +1,449 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <zlib.h>
+
+#ifdef B_STREAM_WITH_ZSTD
+#include <zstd.h>
+#endif
+
+#include "stream.h"
+
+/* ============================================================================
+ * HELPER: sorgente compressa (thread di decompressione)
+ * ============================================================================
+ */
+
+/**
+ * @struct stream_src
+ * @brief Stato del decompressore
+ *
+ * - in, in_pos, in_len: byte letti da fd e non ancora consumati
+ * - pending:   l'ultimo passo ha riempito l'uscita, il decompressore può
+ *              avere altri byte da emettere anche senza nuovo input
+ * - frame_end: membro gzip / frame zstd concluso (nessun troncamento)
+ */
+typedef struct {
+    int fd;
+    int format;
+    unsigned char *in;
+    size_t in_pos, in_len;
+    int eof, pending, frame_end;
+    z_stream zs;
+#ifdef B_STREAM_WITH_ZSTD
+    ZSTD_DStream *zd;
+#endif
+} stream_src;
+
+/**
+ * @brief Legge altri byte in src->in (in_pos deve essere uguale a in_len)
+ *
+ * @return 0, oppure B_STREAM_IO
+ */
+static int src_refill(stream_src *src) {
+    while (1) {
+        ssize_t n = read(src->fd, src->in, B_STREAM_CHUNK);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n < 0) {
+            return B_STREAM_IO;
+        }
+        src->in_pos = 0;
+        src->in_len = (size_t)n;
+        src->eof = n == 0;
+        return 0;
+    }
+}
+
+/**
+ * @brief Sceglie il formato dai primi byte (gzip 1f 8b, zstd 28 b5 2f fd)
+ */
+static int src_detect(stream_src *src) {
+    while (src->in_len < 4 && !src->eof) {
+        ssize_t n = read(src->fd, src->in + src->in_len, B_STREAM_CHUNK - src->in_len);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n < 0) {
+            return B_STREAM_IO;
+        }
+        src->in_len += (size_t)n;
+        src->eof = n == 0;
+    }
+    /* eof segnala solo "read() ha restituito 0": i byte letti restano da consumare */
+    const unsigned char *p = src->in;
+    if (src->in_len >= 2 && p[0] == 0x1f && p[1] == 0x8b) {
+        return B_STREAM_GZIP;
+    }
+    if (src->in_len >= 4 && p[0] == 0x28 && p[1] == 0xb5 && p[2] == 0x2f && p[3] == 0xfd) {
+        return B_STREAM_ZSTD;
+    }
+    return B_STREAM_RAW;
+}
+
+static int src_open(stream_src *src, int fd, int format) {
+    memset(src, 0, sizeof(*src));
+    src->fd = fd;
+    src->frame_end = 1;
+    /* calloc: per un blocco di queste dimensioni sono pagine nuove già
+     * azzerate, e src_detect() non legge mai byte indefiniti */
+    src->in = calloc(1, B_STREAM_CHUNK);
+    if (src->in == NULL) {
+        fprintf(stderr, "Malloc failed in function b_stream_run!\n");
+        exit(-1);
+    }
+
+    if (format == B_STREAM_AUTO) {
+        format = src_detect(src);
+        if (format < 0) {
+            return format;
+        }
+    }
+    src->format = format;
+
+    if (format == B_STREAM_GZIP) {
+        /* 15 + 32: finestra massima, intestazione gzip o zlib riconosciuta */
+        if (inflateInit2(&src->zs, 15 + 32) != Z_OK) {
+            fprintf(stderr, "Malloc failed in function b_stream_run!\n");
+            exit(-1);
+        }
+        return 0;
+    }
+    if (format == B_STREAM_ZSTD) {
+#ifdef B_STREAM_WITH_ZSTD
+        src->zd = ZSTD_createDStream();
+        if (src->zd == NULL) {
+            fprintf(stderr, "Malloc failed in function b_stream_run!\n");
+            exit(-1);
+        }
+        return 0;
+#else
+        return B_STREAM_FORMAT;
+#endif
+    }
+    return format == B_STREAM_RAW ? 0 : B_STREAM_FORMAT;
+}
+
+static void src_close(stream_src *src) {
+    if (src->format == B_STREAM_GZIP) {
+        inflateEnd(&src->zs);
+    }
+#ifdef B_STREAM_WITH_ZSTD
+    if (src->zd != NULL) {
+        ZSTD_freeDStream(src->zd);
+    }
+#endif
+    free(src->in);
+}
+
+/**
+ * @brief Un passo di decompressione da src->in verso dst[*out_pos .. cap)
+ *
+ * @return 0, oppure B_STREAM_CORRUPT
+ */
+static int src_step(stream_src *src, unsigned char *dst, size_t cap, size_t *out_pos) {
+    if (src->format == B_STREAM_GZIP) {
+        /* Membro successivo di un gzip concatenato */
+        if (src->frame_end) {
+            inflateReset(&src->zs);
+            src->frame_end = 0;
+        }
+        src->zs.next_in = src->in + src->in_pos;
+        src->zs.avail_in = (uInt)(src->in_len - src->in_pos);
+        src->zs.next_out = dst + *out_pos;
+        src->zs.avail_out = (uInt)(cap - *out_pos);
+
+        int rc = inflate(&src->zs, Z_NO_FLUSH);
+        if (rc != Z_OK && rc != Z_STREAM_END && rc != Z_BUF_ERROR) {
+            return B_STREAM_CORRUPT;
+        }
+        src->in_pos = src->in_len - src->zs.avail_in;
+        *out_pos = cap - src->zs.avail_out;
+        src->frame_end = rc == Z_STREAM_END;
+        src->pending = !src->frame_end && src->zs.avail_out == 0;
+        return 0;
+    }
+
+#ifdef B_STREAM_WITH_ZSTD
+    ZSTD_inBuffer in = { src->in, src->in_len, src->in_pos };
+    ZSTD_outBuffer out = { dst, cap, *out_pos };
+    size_t rc = ZSTD_decompressStream(src->zd, &out, &in);
+    if (ZSTD_isError(rc)) {
+        return B_STREAM_CORRUPT;
+    }
+    src->in_pos = in.pos;
+    *out_pos = out.pos;
+    src->frame_end = rc == 0;
+    src->pending = out.pos == cap;
+    return 0;
+#else
+    (void)dst;
+    (void)cap;
+    (void)out_pos;
+    return B_STREAM_FORMAT;
+#endif
+}
+
+/**
+ * @brief Riempie dst con fino a cap byte decompressi
+ *
+ * @return Byte scritti (0 = fine dello stream), oppure B_STREAM_IO /
+ *         B_STREAM_CORRUPT (anche per un membro o frame troncato)
+ */
+static ssize_t src_fill(stream_src *src, unsigned char *dst, size_t cap) {
+    size_t out_pos = 0;
+
+    while (out_pos < cap) {
+        if (src->in_pos == src->in_len && !src->eof && !src->pending) {
+            int rc = src_refill(src);
+            if (rc < 0) {
+                return rc;
+            }
+        }
+        if (src->in_pos == src->in_len && src->eof && !src->pending) {
+            break;
+        }
+
+        if (src->format == B_STREAM_RAW) {
+            size_t n = src->in_len - src->in_pos;
+            if (n > cap - out_pos) {
+                n = cap - out_pos;
+            }
+            memcpy(dst + out_pos, src->in + src->in_pos, n);
+            src->in_pos += n;
+            out_pos += n;
+            continue;
+        }
+
+        size_t before_in = src->in_pos, before_out = out_pos;
+        int rc = src_step(src, dst, cap, &out_pos);
+        if (rc < 0) {
+            return rc;
+        }
+        /* Nessun progresso: il decompressore vuole input che non arriverà */
+        if (src->in_pos == before_in && out_pos == before_out) {
+            if (src->eof) {
+                src->pending = 0;
+                break;
+            }
+            src->pending = 0;
+        }
+    }
+
+    if (out_pos == 0 && src->format != B_STREAM_RAW && !src->frame_end) {
+        return B_STREAM_CORRUPT;
+    }
+    return (ssize_t)out_pos;
+}
+
+
+/* ============================================================================
+ * HELPER: coda di blocchi decompressore → chiamante
+ * ============================================================================
+ */
+
+typedef struct {
+    unsigned char *data;
+    size_t len;
+} stream_chunk;
+
+typedef struct {
+    pthread_mutex_t lock;
+    pthread_cond_t not_empty;
+    pthread_cond_t not_full;
+    stream_chunk chunks[B_STREAM_CHUNKS];
+    size_t head, count;
+    int done;    /* Il decompressore ha finito (error = esito) */
+    int error;
+    int stop;    /* Il chiamante ha smesso di leggere */
+
+    stream_src src;
+} stream_pipe;
+
+static void* stream_producer(void *arg) {
+    stream_pipe *p = arg;
+
+    while (1) {
+        pthread_mutex_lock(&p->lock);
+        while (p->count == B_STREAM_CHUNKS && !p->stop) {
+            pthread_cond_wait(&p->not_full, &p->lock);
+        }
+        if (p->stop) {
+            pthread_mutex_unlock(&p->lock);
+            return NULL;
+        }
+        /* Lo slot libero non è visibile al chiamante finché count non cresce */
+        stream_chunk *c = &p->chunks[(p->head + p->count) % B_STREAM_CHUNKS];
+        pthread_mutex_unlock(&p->lock);
+
+        ssize_t n = src_fill(&p->src, c->data, B_STREAM_CHUNK);
+
+        pthread_mutex_lock(&p->lock);
+        if (n > 0) {
+            c->len = (size_t)n;
+            p->count++;
+        } else {
+            p->error = (int)n;
+            p->done = 1;
+        }
+        pthread_cond_signal(&p->not_empty);
+        pthread_mutex_unlock(&p->lock);
+
+        if (n <= 0) {
+            return NULL;
+        }
+    }
+}
+
+
+/* ============================================================================
+ * FUNZIONI: pipeline
+ * ============================================================================
+ */
+
+/**
+ * @brief Lato chiamante: copia i blocchi nella finestra e consegna i documenti
+ *
+ * La finestra window[0 .. wlen) contiene i byte dall'inizio del primo
+ * documento non consegnato (dopo l'ultima compattazione); sp.pos è
+ * relativo alla finestra.
+ */
+ssize_t b_stream_run(int fd, int format, int mode, size_t max_window,
+                     b_split_cb cb, void *ctx) {
+
+    /* Input validation */
+    if(cb == NULL || fd < 0){
+        fprintf(stderr, "Error! Invalid argument parsed in function b_stream_run()! ");
+        exit(-1);
+    }
+
+    stream_pipe *p = calloc(1, sizeof(stream_pipe));
+    if (p == NULL) {
+        fprintf(stderr, "Malloc failed in function b_stream_run!\n");
+        exit(-1);
+    }
+    int rc = src_open(&p->src, fd, format);
+    if (rc < 0) {
+        src_close(&p->src);
+        free(p);
+        return rc;
+    }
+
+    for (int i = 0; i < B_STREAM_CHUNKS; i++) {
+        p->chunks[i].data = malloc(B_STREAM_CHUNK);
+        if (p->chunks[i].data == NULL) {
+            fprintf(stderr, "Malloc failed in function b_stream_run!\n");
+            exit(-1);
+        }
+    }
+    size_t cap = B_STREAM_CHUNK;
+    if (max_window > 0 && max_window < cap) {
+        cap = max_window;
+    }
+    char *window = malloc(cap);
+    if (window == NULL) {
+        fprintf(stderr, "Malloc failed in function b_stream_run!\n");
+        exit(-1);
+    }
+
+    pthread_mutex_init(&p->lock, NULL);
+    pthread_cond_init(&p->not_empty, NULL);
+    pthread_cond_init(&p->not_full, NULL);
+
+    pthread_t producer;
+    if (pthread_create(&producer, NULL, stream_producer, p) != 0) {
+        fprintf(stderr, "Error! pthread_create failed in function b_stream_run!\n");
+        exit(-1);
+    }
+
+    b_splitter sp;
+    b_split_init(&sp, mode);
+    b_range r;
+    size_t wlen = 0;
+    int result = 0;
+
+    while (result == 0) {
+        pthread_mutex_lock(&p->lock);
+        while (p->count == 0 && !p->done) {
+            pthread_cond_wait(&p->not_empty, &p->lock);
+        }
+        if (p->count == 0) {
+            result = p->error;
+            pthread_mutex_unlock(&p->lock);
+            break;
+        }
+        stream_chunk *c = &p->chunks[p->head];
+        pthread_mutex_unlock(&p->lock);
+
+        size_t used = 0;
+        while (used < c->len && result == 0) {
+            if (wlen == cap) {
+                /* Scarta i documenti consegnati; se non basta, allarga */
+                if (sp.pos > 0) {
+                    memmove(window, window + sp.pos, wlen - sp.pos);
+                    wlen -= sp.pos;
+                    b_split_rebase(&sp, sp.pos);
+                } else if (max_window == 0 || cap < max_window) {
+                    size_t grown = max_window > 0 && cap * 2 > max_window ? max_window : cap * 2;
+                    char *bigger = realloc(window, grown);
+                    if (bigger == NULL) {
+                        fprintf(stderr, "Malloc failed in function b_stream_run!\n");
+                        exit(-1);
+                    }
+                    window = bigger;
+                    cap = grown;
+                } else {
+                    result = B_STREAM_WINDOW;
+                    break;
+                }
+            }
+
+            size_t n = c->len - used < cap - wlen ? c->len - used : cap - wlen;
+            memcpy(window + wlen, c->data + used, n);
+            wlen += n;
+            used += n;
+
+            int found;
+            while ((found = b_split_next(&sp, window, wlen, &r)) > 0) {
+                cb(ctx, window + r.offset, r.len, sp.count - 1);
+            }
+            if (found == B_SCHEMA_INVALID) {
+                result = B_SCHEMA_INVALID;
+            }
+        }
+
+        pthread_mutex_lock(&p->lock);
+        p->head = (p->head + 1) % B_STREAM_CHUNKS;
+        p->count--;
+        pthread_cond_signal(&p->not_full);
+        pthread_mutex_unlock(&p->lock);
+    }
+
+    /* Ferma il decompressore se il chiamante esce per errore */
+    pthread_mutex_lock(&p->lock);
+    p->stop = 1;
+    pthread_cond_signal(&p->not_full);
+    pthread_mutex_unlock(&p->lock);
+    pthread_join(producer, NULL);
+
+    /* Fine dello stream con un documento a metà */
+    if (result == 0 && sp.pos < wlen) {
+        result = B_SCHEMA_INCOMPLETE;
+    }
+
+    pthread_cond_destroy(&p->not_full);
+    pthread_cond_destroy(&p->not_empty);
+    pthread_mutex_destroy(&p->lock);
+    for (int i = 0; i < B_STREAM_CHUNKS; i++) {
+        free(p->chunks[i].data);
+    }
+    src_close(&p->src);
+    free(p);
+    free(window);
+
+    return result < 0 ? result : (ssize_t)sp.count;
+}
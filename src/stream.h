@@ -0,0 +1,73 @@
+#ifndef STREAM_H
+#define STREAM_H
+
+#include <stddef.h>
+#include <sys/types.h>
+
+#include "split.h"
+
+/* ============================================================================
+ * PANORAMICA: Lettura in pipeline di archivi compressi
+ * ============================================================================
+ *
+ * Archivi di .torrent e backup dei dati di resume sono compressi con gzip
+ * o zstd. Invece di decomprimere tutto in un buffer e poi decodificare,
+ * b_stream_run() lavora in pipeline:
+ *
+ *   thread di decompressione          thread chiamante
+ *   read() → inflate / zstd  ──coda──▶  finestra → b_split_next() → cb
+ *           (B_STREAM_CHUNKS blocchi da B_STREAM_CHUNK byte)
+ *
+ * La decompressione del blocco successivo procede mentre la callback
+ * decodifica i documenti già completi. La finestra contiene solo i byte
+ * non ancora consegnati: quando è piena i documenti consumati vengono
+ * scartati e il resto spostato in testa; cresce (raddoppiando, fino a
+ * max_window) solo se un singolo documento non ci sta. La memoria di picco
+ * è quindi limitata dalla finestra più i blocchi in coda, non dalla
+ * dimensione dell'archivio.
+ *
+ * Formati: gzip (anche più membri concatenati) e zlib con la zlib; zstd
+ * (più frame concatenati) se compilato con -DB_STREAM_WITH_ZSTD e -lzstd;
+ * dati non compressi. B_STREAM_AUTO riconosce il formato dai magic number.
+ *
+ * ============================================================================
+ */
+
+#define B_STREAM_AUTO      0   /* Riconosce gzip/zstd dai primi byte, altrimenti non compresso */
+#define B_STREAM_RAW       1
+#define B_STREAM_GZIP      2   /* gzip o zlib */
+#define B_STREAM_ZSTD      3
+
+#define B_STREAM_IO        -5  /* read() fallita */
+#define B_STREAM_CORRUPT   -6  /* Dati compressi non validi o troncati */
+#define B_STREAM_WINDOW    -7  /* Documento più grande di max_window */
+#define B_STREAM_FORMAT    -8  /* Formato non disponibile in questa build */
+
+#define B_STREAM_CHUNK     (256 * 1024)  /* Byte decompressi per blocco */
+#define B_STREAM_CHUNKS    4             /* Blocchi in coda tra i due thread */
+
+
+/* ============================================================================
+ * FUNZIONI: pipeline
+ * ============================================================================
+ */
+
+/**
+ * @brief Decomprime fd su un thread dedicato e passa ogni documento a cb
+ *
+ * La callback è chiamata sul thread chiamante, in ordine; doc punta nella
+ * finestra ed è valido solo durante la chiamata.
+ *
+ * @param format     B_STREAM_AUTO, B_STREAM_RAW, B_STREAM_GZIP o B_STREAM_ZSTD
+ * @param mode       B_SPLIT_CONCAT o B_SPLIT_U32BE
+ * @param max_window Dimensione massima della finestra (0 = nessun limite)
+ *
+ * @return Documenti consegnati, oppure un codice negativo B_SCHEMA_*
+ *         (bencode non valido, ultimo documento troncato) o B_STREAM_*; i
+ *         documenti prima dell'errore sono stati comunque consegnati
+ */
+ssize_t b_stream_run(int fd, int format, int mode, size_t max_window,
+                     b_split_cb cb, void *ctx);
+
+
+#endif  /* STREAM_H */
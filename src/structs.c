@@ -5,6 +5,7 @@
 #include <sys/types.h>
 
 #include "structs.h"
+#include "number.h"
 
 /* ============================================================================
  * FUNZIONI: Inizializzazione liste e dizionari
@@ -18,6 +19,7 @@
  * - length impostato a 0 (lista vuota)
  * - encoded_list impostato a NULL
  * - list impostato a NULL (nessun nodo)
+ * - arena, mutated e verified impostati a 0
  *
  * @return Puntatore alla lista appena allocata
  *
@@ -30,6 +32,9 @@ b_list* list_init(void) {
         newList->length = 0;
         newList->encoded_list = NULL;
         newList->list = NULL;
+        newList->arena = 0;
+        newList->mutated = 0;
+        newList->verified = 0;
     } else {
         fprintf(stderr, "Malloc failed in function list_init!\n");
         exit(-1);
@@ -46,6 +51,7 @@ b_list* list_init(void) {
  * - length impostato a 0 (dizionario vuoto)
  * - encoded_dict impostato a NULL
  * - dict impostato a NULL (nessun nodo)
+ * - arena, mutated e verified impostati a 0
  *
  * @return Puntatore al dizionario appena allocato
  *
@@ -58,6 +64,9 @@ b_dict* dict_init(void) {
         newDict->length = 0;
         newDict->encoded_dict = NULL;
         newDict->dict = NULL;
+        newDict->arena = 0;
+        newDict->mutated = 0;
+        newDict->verified = 0;
     } else {
         fprintf(stderr, "Malloc failed in function dict_init!\n");
         exit(-1);
@@ -66,6 +75,167 @@ b_dict* dict_init(void) {
     return newDict;
 }
 
+/* ============================================================================
+ * FUNZIONI: Costruzione oggetti
+ * ============================================================================
+ */
+
+/**
+ * @brief Alloca b_obj e b_box con tipo e refs = 1
+ */
+static b_obj* obj_alloc(B_TYPE type, const char *caller) {
+    b_obj *obj = malloc(sizeof(b_obj));
+    b_box *box = malloc(sizeof(b_box));
+    if (obj == NULL || box == NULL) {
+        fprintf(stderr, "Malloc failed in function %s!\n", caller);
+        exit(-1);
+    }
+    obj->type = type;
+    obj->refs = 1;
+    obj->object = box;
+    return obj;
+}
+
+/**
+ * @brief Crea un B_INT con il valore indicato
+ *
+ * Produce le stesse stringhe di decode_integer(): decoded_element = "42",
+ * encoded_element = "i42e", length = strlen(encoded_element).
+ */
+b_obj* b_obj_new_int(long long value) {
+    char buf[24];  /* "-9223372036854775808" + NUL */
+    size_t len = b_format_i64(buf, value);
+    buf[len] = '\0';
+
+    b_element *elem = malloc(sizeof(b_element));
+    char *decoded = malloc(len + 1);
+    char *encoded = malloc(len + 3);
+    if (elem == NULL || decoded == NULL || encoded == NULL) {
+        fprintf(stderr, "Malloc failed in function b_obj_new_int!\n");
+        exit(-1);
+    }
+    memcpy(decoded, buf, len + 1);
+    encoded[0] = 'i';
+    memcpy(encoded + 1, buf, len);
+    encoded[len + 1] = 'e';
+    encoded[len + 2] = '\0';
+
+    elem->decoded_element = decoded;
+    elem->encoded_element = encoded;
+    elem->length = len + 2;
+
+    b_obj *obj = obj_alloc(B_INT, "b_obj_new_int");
+    obj->object->int_str = elem;
+    return obj;
+}
+
+/**
+ * @brief Crea un B_STR copiando len byte da data
+ *
+ * Produce le stesse stringhe di decode_string(): decoded_element = "spam",
+ * encoded_element = "4:spam", entrambe null-terminated.
+ */
+b_obj* b_obj_new_str(const char *data, size_t len) {
+
+    /* Input validation */
+    if(data == NULL && len > 0){
+        fprintf(stderr, "Error! NULL pointer parsed in function b_obj_new_str()! ");
+        exit(-1);
+    }
+
+    char prefix[24];
+    size_t plen = b_format_u64(prefix, len);
+    prefix[plen++] = ':';
+
+    b_element *elem = malloc(sizeof(b_element));
+    char *decoded = malloc(len + 1);
+    char *encoded = malloc(plen + len + 1);
+    if (elem == NULL || decoded == NULL || encoded == NULL) {
+        fprintf(stderr, "Malloc failed in function b_obj_new_str!\n");
+        exit(-1);
+    }
+    if (len > 0) {
+        memcpy(decoded, data, len);
+        memcpy(encoded + plen, data, len);
+    }
+    decoded[len] = '\0';
+    memcpy(encoded, prefix, plen);
+    encoded[plen + len] = '\0';
+
+    elem->decoded_element = decoded;
+    elem->encoded_element = encoded;
+    elem->length = (ssize_t)(plen + len);
+
+    b_obj *obj = obj_alloc(B_STR, "b_obj_new_str");
+    obj->object->int_str = elem;
+    return obj;
+}
+
+b_obj* b_obj_new_list(b_list *list) {
+
+    /* Input validation */
+    if(list == NULL){
+        fprintf(stderr, "Error! NULL pointer parsed in function b_obj_new_list()! ");
+        exit(-1);
+    }
+
+    b_obj *obj = obj_alloc(B_LIS, "b_obj_new_list");
+    obj->object->list = list;
+    return obj;
+}
+
+b_obj* b_obj_new_dict(b_dict *dict) {
+
+    /* Input validation */
+    if(dict == NULL){
+        fprintf(stderr, "Error! NULL pointer parsed in function b_obj_new_dict()! ");
+        exit(-1);
+    }
+
+    b_obj *obj = obj_alloc(B_DICT, "b_obj_new_dict");
+    obj->object->dict = dict;
+    return obj;
+}
+
+
+/* ============================================================================
+ * FUNZIONI: Conteggio dei riferimenti
+ * ============================================================================
+ */
+
+/**
+ * @brief Aggiunge un riferimento all'oggetto
+ *
+ * L'incremento può essere relaxed: chi chiama possiede già un riferimento,
+ * quindi l'oggetto non può essere liberato nel frattempo.
+ */
+b_obj* b_obj_retain(b_obj *obj) {
+
+    /* Input validation */
+    if(obj == NULL){
+        fprintf(stderr, "Error! NULL pointer parsed in function b_obj_retain()! ");
+        exit(-1);
+    }
+
+    __atomic_add_fetch(&obj->refs, 1, __ATOMIC_RELAXED);
+    return obj;
+}
+
+void b_obj_release(b_obj *obj) {
+    free_obj(obj);
+}
+
+unsigned int b_obj_refcount(const b_obj *obj) {
+
+    /* Input validation */
+    if(obj == NULL){
+        fprintf(stderr, "Error! NULL pointer parsed in function b_obj_refcount()! ");
+        exit(-1);
+    }
+
+    return __atomic_load_n(&obj->refs, __ATOMIC_ACQUIRE);
+}
+
 /*  ============================================================================
  *  FUNZIONI: Deallocazione memoria
  *  ============================================================================
@@ -73,11 +243,13 @@ b_dict* dict_init(void) {
 
 
  /**
-  * @brief Libera ricorsivamente un oggetto bencodificato generico (b_obj)
+  * @brief Rilascia un riferimento a un oggetto bencodificato generico (b_obj)
   *
-  * Dealloca tutta la memoria associata a un b_obj, incluse le strutture
-  * interne, in base al tipo dell'oggetto. La deallocazione avviene
-  * dall'interno verso l'esterno (prima i dati, poi i wrapper).
+  * Decrementa atomicamente refs: se restano altri riferimenti ritorna senza
+  * liberare nulla. All'ultimo rilascio dealloca tutta la memoria associata
+  * a un b_obj, incluse le strutture interne, in base al tipo dell'oggetto.
+  * La deallocazione avviene dall'interno verso l'esterno (prima i dati,
+  * poi i wrapper).
   *
   * Strategia per tipo:
   *   - B_INT / B_STR: libera decoded_element → encoded_element → b_element → b_box → b_obj
@@ -93,8 +265,10 @@ b_dict* dict_init(void) {
   *
   * @note Dopo la chiamata, il puntatore ptr è invalidato (non azzerato).
   *       Il chiamante dovrebbe impostarlo a NULL per evitare use-after-free.
-  * @note Per B_LIS e B_DICT la deallocazione è ricorsiva: libera anche
+  * @note Per B_LIS e B_DICT la deallocazione è ricorsiva: rilascia anche
   *       tutti gli oggetti annidati in profondità.
+  * @note Il decremento è acq_rel: le scritture fatte da altri thread prima
+  *       del loro rilascio sono visibili a chi libera l'oggetto.
   */
  void free_obj(b_obj *ptr) {
 
@@ -104,6 +278,11 @@ b_dict* dict_init(void) {
          exit(-1);
      }
 
+     /* Oggetto ancora condiviso: toglie solo il nostro riferimento */
+     if (__atomic_sub_fetch(&ptr->refs, 1, __ATOMIC_ACQ_REL) != 0) {
+         return;
+     }
+
      switch (get_object_type(ptr)) {
 
          /* ===== INTERO: libera stringhe codificata/decodificata, b_element, b_box, b_obj ===== */
@@ -252,6 +431,141 @@ b_dict* dict_init(void) {
      free(ptr);                /* Struttura b_dict radice */
  }
 
+/* ============================================================================
+ * FUNZIONI: Validità della forma codificata
+ * ============================================================================
+ */
+
+static uint64_t enc_generation = 1;  /* Generazione corrente */
+static uint64_t last_mutation;       /* Generazione più alta data a una modifica */
+
+/**
+ * @brief Assegna a *mutated la generazione corrente e la registra in
+ *        last_mutation (massimo monotono, quindi con una CAS)
+ */
+static void stamp_mutation(uint64_t *mutated) {
+    uint64_t g = __atomic_load_n(&enc_generation, __ATOMIC_ACQUIRE);
+    *mutated = g;
+
+    uint64_t m = __atomic_load_n(&last_mutation, __ATOMIC_RELAXED);
+    while (m < g && !__atomic_compare_exchange_n(&last_mutation, &m, g, 1,
+                                                 __ATOMIC_RELEASE, __ATOMIC_RELAXED)) {
+    }
+}
+
+/**
+ * @brief 1 se nessun contenitore del sottoalbero è stato modificato dopo gen
+ */
+static int unchanged_since(b_obj *obj, uint64_t gen) {
+    if (obj->type == B_LIS) {
+        b_list *l = obj->object->list;
+        if (l->mutated > gen) {
+            return 0;
+        }
+        for (list_node *n = l->list; n != NULL; n = n->next) {
+            if (!unchanged_since(n->object, gen)) {
+                return 0;
+            }
+        }
+    } else if (obj->type == B_DICT) {
+        b_dict *d = obj->object->dict;
+        if (d->mutated > gen) {
+            return 0;
+        }
+        /* Le chiavi sono stringhe: basta visitare i valori */
+        for (dict_node *n = d->dict; n != NULL; n = n->next) {
+            if (!unchanged_since(n->value, gen)) {
+                return 0;
+            }
+        }
+    }
+    return 1;
+}
+
+/**
+ * @brief Ogni chiamata restituisce una generazione diversa e fa avanzare il
+ *        contatore, così le modifiche successive ne ricevono una maggiore
+ */
+uint64_t b_encoded_stamp(void) {
+    return __atomic_fetch_add(&enc_generation, 1, __ATOMIC_ACQ_REL);
+}
+
+void b_obj_touch(b_obj *obj) {
+
+    /* Input validation */
+    if(obj == NULL){
+        fprintf(stderr, "Error! NULL pointer parsed in function b_obj_touch()! ");
+        exit(-1);
+    }
+    if (b_obj_refcount(obj) >= B_OBJ_REFS_ARENA) {
+        fprintf(stderr, "Error! Arena node parsed in function b_obj_touch()! ");
+        exit(-1);
+    }
+
+    if (obj->type == B_LIS) {
+        b_list *l = obj->object->list;
+        free(l->encoded_list);
+        l->encoded_list = NULL;
+        l->length = 0;
+        stamp_mutation(&l->mutated);
+    } else if (obj->type == B_DICT) {
+        b_dict *d = obj->object->dict;
+        free(d->encoded_dict);
+        d->encoded_dict = NULL;
+        d->length = 0;
+        stamp_mutation(&d->mutated);
+    }
+}
+
+/**
+ * @brief Forma codificata di obj se nessuna modifica in place l'ha resa
+ *        obsoleta
+ *
+ * verified viene letta e riscritta con atomici relaxed: più reader possono
+ * validare lo stesso albero condiviso nello stesso momento.
+ */
+const char* b_obj_encoded(b_obj *obj, size_t *length) {
+
+    /* Input validation */
+    if(obj == NULL){
+        fprintf(stderr, "Error! NULL pointer parsed in function b_obj_encoded()! ");
+        exit(-1);
+    }
+
+    char *encoded;
+    ssize_t len;
+    uint64_t *verified;
+    if (obj->type == B_LIS) {
+        encoded = obj->object->list->encoded_list;
+        len = obj->object->list->length;
+        verified = &obj->object->list->verified;
+    } else if (obj->type == B_DICT) {
+        encoded = obj->object->dict->encoded_dict;
+        len = obj->object->dict->length;
+        verified = &obj->object->dict->verified;
+    } else {
+        return NULL;
+    }
+    if (encoded == NULL) {
+        return NULL;
+    }
+
+    /* Caso comune: nessuna modifica in place dopo la verifica */
+    uint64_t gen = __atomic_load_n(verified, __ATOMIC_RELAXED);
+    if (gen < __atomic_load_n(&last_mutation, __ATOMIC_ACQUIRE)) {
+        if (!unchanged_since(obj, gen)) {
+            return NULL;
+        }
+        __atomic_store_n(verified, b_encoded_stamp(), __ATOMIC_RELAXED);
+    }
+
+    if (length != NULL) {
+        *length = (size_t)len;
+    }
+    return encoded;
+}
+
+
 /* ============================================================================
  * FUNZIONI: Aggiunta elementi a liste e dizionari
  * ============================================================================
@@ -279,6 +593,8 @@ b_dict* dict_init(void) {
  *       il programma con exit(-1)
  * @note La complessità è O(n) dove n è il numero di elementi già presenti
  * @note Per liste grandi, considerare di usare una coda per ottimizzare gli inserimenti
+ * @note Invalida la forma codificata (encoded_list = NULL, length = 0) e,
+ *       tramite mutated, quella degli antenati
  */
 void list_add(b_list *lista, b_obj *elem) {
     /* Input validation */
@@ -286,6 +602,16 @@ void list_add(b_list *lista, b_obj *elem) {
         fprintf(stderr, "Error! NULL pointer parsed in function list_add()! ");
         exit(-1);
     }
+    if (lista->arena) {
+        fprintf(stderr, "Error! Arena list parsed in function list_add()! ");
+        exit(-1);
+    }
+
+    /* La forma codificata non corrisponde più alla lista */
+    free(lista->encoded_list);
+    lista->encoded_list = NULL;
+    lista->length = 0;
+    stamp_mutation(&lista->mutated);
 
     /* Alloca un nuovo nodo */
     list_node *newNode = malloc(sizeof(list_node));
@@ -336,6 +662,8 @@ void list_add(b_list *lista, b_obj *elem) {
  * @note In bencode, le chiavi dovrebbero essere ordinate lessicograficamente,
  *       ma questa implementazione non lo garantisce
  * @note Per dizionari grandi, considerare di usare una struttura dati più efficiente
+ * @note Invalida la forma codificata (encoded_dict = NULL, length = 0) e,
+ *       tramite mutated, quella degli antenati
  */
 void dict_add(b_dict *dict, b_obj *key, b_obj *val) {
 
@@ -344,6 +672,16 @@ void dict_add(b_dict *dict, b_obj *key, b_obj *val) {
         fprintf(stderr, "Error! NULL pointer parsed in function dict_add()! ");
         exit(-1);
     }
+    if (dict->arena) {
+        fprintf(stderr, "Error! Arena dict parsed in function dict_add()! ");
+        exit(-1);
+    }
+
+    /* La forma codificata non corrisponde più al dizionario */
+    free(dict->encoded_dict);
+    dict->encoded_dict = NULL;
+    dict->length = 0;
+    stamp_mutation(&dict->mutated);
 
     /* Alloca un nuovo nodo */
     dict_node *newNode = malloc(sizeof(dict_node));
@@ -442,6 +780,25 @@ B_TYPE get_dict_value_type(dict_node *node) {
 }
 
 
+/**
+ * @brief Lunghezza del contenuto di una bytestring a partire da length
+ *
+ * Cerca l'unico n con n + cifre(n) + 1 == length: per ogni numero di
+ * cifre possibile n deve avere esattamente quelle cifre.
+ */
+size_t bytestring_payload_length(ssize_t length) {
+    size_t total = (size_t)length;
+    size_t pow10 = 10;
+    for (size_t digits = 1; digits < 20 && digits + 1 <= total; digits++, pow10 *= 10) {
+        size_t n = total - digits - 1;
+        if (n < pow10 && (digits == 1 || n >= pow10 / 10)) {
+            return n;
+        }
+    }
+    return total;
+}
+
+
 /* ============================================================================
  * FUNZIONI: Stampa e output
  * ============================================================================
@@ -791,3 +1148,35 @@ void find_by_key(b_dict *dict, char *key) {
     }
     printf("NOT FOUND!\n");
 }
+
+
+/**
+ * @brief Ricerca una chiave in un dizionario e ritorna il valore associato
+ *
+ * Come get_info_dict() ma senza output su stdout e senza assumere il tipo
+ * del valore: è la primitiva di lookup usata dai moduli che navigano il
+ * metainfo (layout, indici, export).
+ *
+ * @param dict Puntatore al dizionario dove cercare
+ * @param key  Stringa null-terminated che rappresenta la chiave da ricercare
+ *
+ * @return Il valore (b_obj) se la chiave esiste, NULL altrimenti
+ *
+ * @note La complessità è O(n) dove n è il numero di coppie nel dizionario
+ */
+b_obj* dict_get(b_dict *dict, const char *key) {
+
+    /* Input validation */
+    if(dict == NULL || key == NULL){
+        fprintf(stderr, "Error! NULL pointer parsed in function dict_get()! ");
+        exit(-1);
+    }
+
+    for (dict_node *tmp = dict->dict; tmp != NULL; tmp = tmp->next) {
+        if (strcmp(key, tmp->key->object->int_str->decoded_element) == 0) {
+            return tmp->value;
+        }
+    }
+
+    return NULL;
+}
@@ -2,6 +2,7 @@
 #define STRUCTS_H
 
 #include <stdio.h>  /* ssize_t */
+#include <stdint.h>
 
 /* ============================================================================
  * DEBUG: Codici ANSI per output colorato nel terminale
@@ -94,16 +95,29 @@ typedef union bencoded_union b_box;
  * Rappresenta un elemento generico bencodificato con informazioni sul tipo.
  * La struttura contiene:
  * - type:   enumera quale tipo di dato è memorizzato
+ * - refs:   contatore atomico dei riferimenti (1 alla creazione)
  * - object: puntatore all'union che contiene i dati effettivi
  *
  * Consente di lavorare con dati eterogenei in modo type-safe.
+ *
+ * Un sottoalbero può essere condiviso tra più documenti o thread: ogni
+ * proprietario tiene un riferimento (b_obj_retain()) e lo rilascia con
+ * free_obj()/b_obj_release(). La memoria viene liberata solo all'ultimo
+ * rilascio. refs occupa il padding tra type e object: sizeof(b_obj) non cambia.
+ *
+ * I nodi allocati in un'arena (b_obj_clone()) partono da B_OBJ_REFS_ARENA:
+ * retain/release funzionano normalmente ma il contatore non arriva mai a
+ * zero, quindi free_obj() non li libera mai singolarmente.
  */
 struct bencoded_object {
-    B_TYPE type;      /* Tipo di dato memorizzato */
-    b_box *object;    /* Puntatore ai dati effettivi */
+    B_TYPE type;          /* Tipo di dato memorizzato */
+    unsigned int refs;    /* Riferimenti (accesso solo con __atomic_*) */
+    b_box *object;        /* Puntatore ai dati effettivi */
 };
 typedef struct bencoded_object b_obj;
 
+#define B_OBJ_REFS_ARENA  0x80000000u  /* refs iniziale dei nodi in arena */
+
 
 /* ============================================================================
  * STRUCT: dati binari/esadecimali (per campo "pieces" nei metafile .torrent)
@@ -221,11 +235,19 @@ typedef struct bdict_node dict_node;
  * - encoded_list: forma bencodificata originale (NOTA: typo nel nome "encoded")
  * - list:         puntatore al primo nodo della lista concatenata
  * - length:       lunghezza totale della forma codificata
+ * - arena:        1 se allocata in un'arena (b_obj_clone(), pdecode): non
+ *                 modificabile
+ * - mutated:      generazione dell'ultima modifica in place
+ * - verified:     generazione a cui encoded_list corrispondeva alla lista
+ *                 (vedi b_obj_encoded())
  */
 struct bencoded_list {
     char *encoded_list;   /* Forma bencodificata originale [NOTA: typo nel nome] */
     list_node *list;      /* Puntatore al primo nodo della lista */
     ssize_t length;       /* Lunghezza della forma codificata */
+    int arena;            /* 1 se in un'arena (non modificabile) */
+    uint64_t mutated;     /* Generazione dell'ultima modifica in place */
+    uint64_t verified;    /* Generazione a cui encoded_list era valida */
 };
 typedef struct bencoded_list b_list;
 
@@ -246,15 +268,46 @@ typedef struct bencoded_list b_list;
  * - encoded_dict: forma bencodificata originale
  * - dict:         puntatore al primo nodo della lista concatenata (chiave-valore)
  * - length:       lunghezza totale della forma codificata
+ * - arena:        1 se allocato in un'arena (b_obj_clone(), pdecode): non
+ *                 modificabile
+ * - mutated:      generazione dell'ultima modifica in place
+ * - verified:     generazione a cui encoded_dict corrispondeva al dizionario
+ *                 (vedi b_obj_encoded())
  */
 struct bencoded_dict {
     char *encoded_dict; /* Forma bencodificata originale */
     dict_node *dict;    /* Puntatore al primo nodo del dizionario */
     ssize_t length;     /* Lunghezza della forma codificata */
+    int arena;          /* 1 se in un'arena (non modificabile) */
+    uint64_t mutated;   /* Generazione dell'ultima modifica in place */
+    uint64_t verified;  /* Generazione a cui encoded_dict era valida */
 };
 typedef struct bencoded_dict b_dict;
 
 
+/* ============================================================================
+ * STRUCT: intervallo di byte (span)
+ * ============================================================================
+ */
+
+/**
+ * @struct b_span
+ * @brief Riferimento non proprietario a una sequenza di byte
+ *
+ * Indica una porzione di un buffer esistente (es. il buffer bencode
+ * originale o un pool di stringhe) senza copiarla.
+ * NON è null-terminated: usare sempre len.
+ *
+ * Campi:
+ * - ptr: primo byte della sequenza
+ * - len: numero di byte
+ */
+typedef struct {
+    const char *ptr;  /* Primo byte (non posseduto) */
+    size_t len;       /* Numero di byte */
+} b_span;
+
+
 /* ============================================================================
  * FUNZIONI: creazione e gestione liste
  * ============================================================================
@@ -276,6 +329,8 @@ b_list* list_init(void);
  *
  * @note La funzione alloca un nuovo nodo con malloc.
  *       In caso di errore di allocazione, il programma termina con exit(-1).
+ * @note Una lista in arena (b_obj_clone(), pdecode) non è modificabile: il
+ *       programma termina con exit(-1). Prima b_obj_make_unique().
  */
 void list_add(b_list *lista, b_obj *elem);
 
@@ -303,9 +358,71 @@ b_dict* dict_init(void);
  * @note La funzione alloca un nuovo nodo con malloc.
  *       In caso di errore di allocazione, il programma termina con exit(-1).
  *       Non garantisce che le chiavi rimangono ordinate lessicograficamente.
+ * @note Un dizionario in arena (b_obj_clone(), pdecode) non è modificabile:
+ *       il programma termina con exit(-1). Prima b_obj_make_unique().
  */
 void dict_add(b_dict *dict, b_obj *key, b_obj *val);
 
+
+/* ============================================================================
+ * FUNZIONI: costruzione oggetti
+ * ============================================================================
+ */
+
+/**
+ * @brief Crea un B_INT con il valore indicato
+ *
+ * @return Nuovo oggetto con refs = 1 e forma codificata "i<valore>e"
+ */
+b_obj* b_obj_new_int(long long value);
+
+/**
+ * @brief Crea un B_STR copiando len byte da data
+ *
+ * @return Nuovo oggetto con refs = 1 e forma codificata "<len>:<data>"
+ */
+b_obj* b_obj_new_str(const char *data, size_t len);
+
+/**
+ * @brief Avvolge una b_list in un nuovo b_obj di tipo B_LIS
+ *
+ * @note La lista passa all'oggetto: verrà liberata con esso
+ */
+b_obj* b_obj_new_list(b_list *list);
+
+/**
+ * @brief Avvolge un b_dict in un nuovo b_obj di tipo B_DICT
+ *
+ * @note Il dizionario passa all'oggetto: verrà liberato con esso
+ */
+b_obj* b_obj_new_dict(b_dict *dict);
+
+
+/* ============================================================================
+ * FUNZIONI: conteggio dei riferimenti
+ * ============================================================================
+ */
+
+/**
+ * @brief Aggiunge un riferimento all'oggetto (thread-safe)
+ *
+ * @return obj stesso, per comodità (es. dict_add(d, k, b_obj_retain(v)))
+ */
+b_obj* b_obj_retain(b_obj *obj);
+
+/**
+ * @brief Rilascia un riferimento; all'ultimo libera l'oggetto e rilascia i figli
+ *
+ * Equivalente a free_obj().
+ */
+void b_obj_release(b_obj *obj);
+
+/**
+ * @brief Numero corrente di riferimenti (solo indicativo se altri thread
+ *        stanno facendo retain/release)
+ */
+unsigned int b_obj_refcount(const b_obj *obj);
+
 /*  ============================================================================
  *  FUNZIONI: deallocazione memoria
  *  ============================================================================
@@ -313,10 +430,11 @@ void dict_add(b_dict *dict, b_obj *key, b_obj *val);
 
 
  /**
-  * @brief Libera ricorsivamente un oggetto bencodificato generico (b_obj)
+  * @brief Rilascia un riferimento a un oggetto bencodificato generico (b_obj)
   *
-  * Dealloca tutta la memoria associata a un b_obj in base al suo tipo.
-  * Per oggetti composti (B_LIS, B_DICT) la deallocazione è ricorsiva.
+  * Se era l'ultimo riferimento dealloca tutta la memoria associata a un b_obj
+  * in base al suo tipo. Per oggetti composti (B_LIS, B_DICT) i figli vengono
+  * a loro volta rilasciati: quelli condivisi con altri alberi sopravvivono.
   *
   * @param ptr Puntatore all'oggetto da liberare. Non deve essere NULL.
   *
@@ -350,6 +468,60 @@ void dict_add(b_dict *dict, b_obj *key, b_obj *val);
  void free_dictNodes(b_dict *ptr);
 
 
+/* ============================================================================
+ * FUNZIONI: validità della forma codificata
+ * ============================================================================
+ *
+ * list_add()/dict_add() scartano solo la forma codificata del contenitore
+ * modificato: gli antenati conservano la propria, che non descrive più il
+ * sottoalbero. Invece di puntatori al padre (i nodi sono condivisi tra
+ * versioni copy-on-write) ogni contenitore porta due generazioni di un
+ * contatore globale:
+ *
+ *   mutated   assegnata da ogni modifica in place (list_add(), dict_add(),
+ *             b_obj_touch())
+ *   verified  presa quando la forma codificata è stata prodotta o
+ *             verificata; le modifiche successive ricevono generazioni
+ *             strettamente maggiori
+ *
+ * La forma è valida se nessun contenitore del sottoalbero ha mutated >
+ * verified. Il caso comune costa un confronto: se nessuna modifica in place
+ * è avvenuta dopo verified (in tutto il processo) non serve visitare nulla;
+ * altrimenti si visita il sottoalbero una volta e, se è ancora valida, la
+ * si ritimbra.
+ */
+
+/**
+ * @brief Generazione da assegnare a verified per una forma codificata
+ *        appena prodotta dal sottoalbero corrente
+ */
+uint64_t b_encoded_stamp(void);
+
+/**
+ * @brief Segna come modificato in place il contenitore obj
+ *
+ * Scarta la sua forma codificata e invalida quella degli antenati. Nessun
+ * effetto su scalari: chi ne modifica uno in place deve prima rendere
+ * modificabile il contenitore che lo contiene (b_obj_make_unique() lungo il
+ * cammino). Un nodo in arena (refs >= B_OBJ_REFS_ARENA) non è modificabile:
+ * il programma termina con exit(-1).
+ */
+void b_obj_touch(b_obj *obj);
+
+/**
+ * @brief Forma codificata di un contenitore, se ancora corrisponde al
+ *        sottoalbero
+ *
+ * Unico controllo usato dai percorsi rapidi (b_obj_equal(), b_obj_clone(),
+ * encoder). Da non chiamare in concorrenza con modifiche allo stesso albero.
+ *
+ * @param length Se non NULL, riceve la lunghezza della forma
+ * @return La forma codificata, NULL se assente, obsoleta o obj non è un
+ *         contenitore
+ */
+const char* b_obj_encoded(b_obj *obj, size_t *length);
+
+
 /* ============================================================================
  * FUNZIONI: query sul tipo di dato
  * ============================================================================
@@ -380,6 +552,17 @@ B_TYPE get_list_node_type(list_node *node);
 B_TYPE get_dict_value_type(dict_node *node);
 
 
+/**
+ * @brief Lunghezza del contenuto di una bytestring a partire da length
+ *
+ * I campi length di b_element (B_STR) e b_pieces (B_HEX) contengono la
+ * lunghezza della forma codificata "<n>:<dati>", cioè n + cifre(n) + 1.
+ *
+ * @return n, il numero di byte di dati
+ */
+size_t bytestring_payload_length(ssize_t length);
+
+
 /* ============================================================================
  * FUNZIONI: stampa e output
  * ============================================================================
@@ -456,5 +639,18 @@ b_dict* get_info_dict(b_dict *dict, char *key);
  */
 void find_by_key(b_dict *dict, char *key);
 
+/**
+ * @brief Ricerca una chiave in un dizionario e ritorna il valore associato
+ *
+ * Variante silenziosa di get_info_dict(): non stampa nulla e ritorna il
+ * b_obj generico, lasciando al chiamante il controllo del tipo.
+ *
+ * @param dict Puntatore al dizionario dove cercare
+ * @param key  Stringa null-terminated che rappresenta la chiave da ricercare
+ *
+ * @return Il valore associato alla chiave, NULL se la chiave non esiste
+ */
+b_obj* dict_get(b_dict *dict, const char *key);
+
 
 #endif  /* STRUCTS_H */